@@ -1,9 +1,17 @@
-QT       += core gui opengl
+QT       += core gui opengl concurrent
 include(QtGifimage/gifimage/qtgifimage.pri)
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+LIBS += -lz
+
+# Build with CONFIG+=zstd for read of zstd compressed models
+zstd {
+    DEFINES += MODEL_VIEWER_ZSTD
+    LIBS += -lzstd
+}
+
 !isEmpty(OUT_DIR): {
     QMAKE_CXXFLAGS += $$OUT_DIR
 }
@@ -15,25 +23,64 @@ CONFIG += c++17
 SOURCES += \
     main.cc \
     main_window/main_window.cc \
+    model/affine_transform.cc \
+    model/arena.cc \
+    model/chunked_obj_parser.cc \
+    model/decompress_buffer.cc \
     model/file_parser.cc \
+    model/file_probe.cc \
+    model/file_writer.cc \
+    model/json_value.cc \
+    model/mesh_cache.cc \
     model/model.cc \
+    model/number_parser.cc \
+    model/parser_gltf.cc \
     model/parser_list.cc \
     model/parser_obj.cc \
+    model/parser_ply.cc \
+    model/parser_stl.cc \
+    model/software_rasterizer.cc \
+    model/spill_buffer.cc \
+    model/thread_pool.cc \
+    viewer/frame_reader/frame_reader.cc \
     viewer/line_strategy/line_strategy.cc \
     viewer/projection_strategy/projection_strategy.cc \
+    viewer/render_queue/render_queue.cc \
+    viewer/shader_renderer/shader_renderer.cc \
+    viewer/tiled_renderer/tiled_renderer.cc \
     viewer/vertex_strategy/vertex_strategy.cc \
     viewer/viewer.cc \
     controller/controller.cc
 
 HEADERS += \
     main_window/main_window.h \
+    model/affine_transform.h \
+    model/arena.h \
+    model/chunked_obj_parser.h \
+    model/decompress_buffer.h \
     model/file_parser.h \
+    model/file_probe.h \
+    model/file_writer.h \
+    model/json_value.h \
+    model/mesh_cache.h \
+    model/mesh_data.h \
     model/model.h \
     model/model_types.h \
+    model/number_parser.h \
+    model/parser_gltf.h \
     model/parser_list.h \
     model/parser_obj.h \
+    model/parser_ply.h \
+    model/parser_stl.h \
+    model/software_rasterizer.h \
+    model/spill_buffer.h \
+    model/thread_pool.h \
+    viewer/frame_reader/frame_reader.h \
     viewer/line_strategy/line_strategy.h \
     viewer/projection_strategy/projection_strategy.h \
+    viewer/render_queue/render_queue.h \
+    viewer/shader_renderer/shader_renderer.h \
+    viewer/tiled_renderer/tiled_renderer.h \
     viewer/vertex_strategy/vertex_strategy.h \
     viewer/viewer.h \
     common/color_utils.h \
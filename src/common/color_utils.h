@@ -24,6 +24,13 @@ inline void qColorToRGB(QColor color, float& r, float& g, float& b) {
   b = normalize_0_1(color.blue(), 1, 255);
 }
 
+/** @brief Converts RGB values normalized from 0 to 1 to opaque 0xAARRGGBB */
+inline QRgb rgbToQRgb(float r, float g, float b) {
+  return QColor::fromRgbF(qBound(0.0f, r, 1.0f), qBound(0.0f, g, 1.0f),
+                          qBound(0.0f, b, 1.0f))
+      .rgb();
+}
+
 }  // namespace ModelViewer3D
 
 #endif  // SRC_COMMON_COLOR_UTILS_H_
@@ -3,7 +3,9 @@
  */
 #include "controller/controller.h"
 
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
 namespace ModelViewer3D {
 Controller& Controller::Instance() {
@@ -12,7 +14,57 @@ Controller& Controller::Instance() {
 }
 
 void Controller::LoadModel(std::string filepath) {
-  this->model_.Load(filepath);
+  if (!this->cache_.IsEnabled()) {
+    this->model_.Load(filepath);
+    return;
+  }
+
+  std::shared_ptr<const MeshData> cached = this->cache_.Find(filepath);
+
+  if (cached) {
+    // Model is transformed in place, the cached one is kept pristine
+    MeshData mesh = *cached;
+    this->model_.SetMesh(mesh);
+    return;
+  }
+
+  // The model stays empty if the file is not parsed
+  MeshData mesh;
+  this->model_.SetMesh(mesh);
+
+  MeshCache::FileStamp stamp = MeshCache::GetStamp(filepath);
+  this->model_.Parse(filepath, mesh);
+  // Only the cached model is copied, the parsed one is moved to the model
+  if (this->cache_.Fits(mesh)) {
+    this->cache_.Insert(filepath, stamp, std::make_shared<MeshData>(mesh));
+  }
+  this->model_.SetMesh(mesh);
+}
+
+void Controller::PreloadModels(const std::vector<std::string>& filepaths) {
+  this->cache_.Preload(filepaths);
+}
+
+void Controller::SetCacheBudget(size_t budget) {
+  this->cache_.SetBudget(budget);
+}
+
+void Controller::ParseModelChanges(const std::string& filepath,
+                                   MeshData& mesh_out) {
+  this->model_.ParseChanges(filepath, mesh_out);
+}
+
+void Controller::ReloadModelMesh(MeshData& mesh) {
+  this->model_.ReloadMesh(mesh);
+}
+
+void Controller::CopyModelMesh(MeshData& mesh_out) {
+  this->model_.CopyMesh(mesh_out);
+}
+
+void Controller::ExportModel(const std::string& filepath,
+                             const MeshData& mesh) {
+  this->writer_.WriteFile(filepath, mesh);
 }
 
 void Controller::RotateModel(float angle, Axis axis) {
@@ -32,9 +84,30 @@ void Controller::RotateModel(float angle, Axis axis) {
 void Controller::SetModelScale(float scale) { this->model_.Scale(scale); }
 
 void Controller::TranslateModelPosition(float x, float y, float z) {
-  this->model_.Translate(x, kX);
-  this->model_.Translate(y, kY);
-  this->model_.Translate(z, kZ);
+  this->model_.Transform(AffineTransform::Translation(x, y, z));
+}
+
+void Controller::TransformModel(const AffineTransform& transform) {
+  if (!transform.IsIdentity()) {
+    this->model_.Transform(transform);
+  }
+}
+
+void Controller::SetStableTransform(bool enable) {
+  this->model_.SetStableTransform(enable);
+}
+
+void Controller::SetKeepTriangles(bool enable) {
+  this->model_.SetKeepTriangles(enable);
+}
+
+void Controller::SetSurfaceNormals(SurfaceNormals mode) {
+  this->model_.SetSurfaceNormals(mode);
+}
+
+void Controller::SetMemoryBudget(size_t memory_budget) {
+  this->model_.SetMemoryBudget(memory_budget);
+  this->cache_.SetLoadMemoryBudget(memory_budget);
 }
 
 void Controller::GetModelMesh(vertexType** vertices, polygonType** polygon) {
@@ -46,6 +119,10 @@ void Controller::GetModelMesh(vertexType** vertices, polygonType** polygon) {
   }
 }
 
+void Controller::GetModelBounds(vertexType min[3], vertexType max[3]) {
+  this->model_.GetBounds(min, max);
+}
+
 unsigned int Controller::GetCountVertices() {
   return this->model_.GetVerticesCount();
 }
@@ -55,4 +132,20 @@ unsigned int Controller::GetCountEdges() { return this->model_.GetEdgeCount(); }
 unsigned int Controller::GetCountFacesIndices() {
   return this->model_.GetFacesIndicesCount();
 }
+
+polygonType* Controller::GetModelTriangles() {
+  return this->model_.GetTriangles();
+}
+
+unsigned int Controller::GetCountTrianglesIndices() {
+  return this->model_.GetTrianglesIndicesCount();
+}
+
+const vertexType* Controller::GetModelSurfaceNormals() {
+  return this->model_.GetSurfaceNormals();
+}
+
+unsigned int Controller::GetCountSurfaceNormals() {
+  return this->model_.GetSurfaceNormalsCount();
+}
 }  // namespace ModelViewer3D
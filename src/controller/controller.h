@@ -6,7 +6,10 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
+#include "model/file_writer.h"
+#include "model/mesh_cache.h"
 #include "model/model.h"
 
 namespace ModelViewer3D {
@@ -28,11 +31,51 @@ class Controller {
   /** @brief Gets a reference to the single instance of the Controller class */
   static Controller& Instance();
 
-  /** @brief Load model from file
+  /** @brief Load model from file, models in the cache are not parsed again
    * @param[in] filepath Path to obj file
    */
   void LoadModel(std::string filepath);
 
+  /** @brief Parse files on a background thread and put them to the cache,
+   * so the next load of them is not waiting for the parse
+   * @param filepaths Paths to files, in the order of parse
+   */
+  void PreloadModels(const std::vector<std::string>& filepaths);
+
+  /** @brief Set the size of parsed models kept in memory, least recently
+   * used models are evicted first
+   * @param budget Size in bytes, zero disables the cache
+   */
+  void SetCacheBudget(size_t budget);
+
+  /** @brief Parse the changed model file without change of the model, so it
+   * may be called on a background thread
+   * @param[in] filepath Path to model file
+   * @param[out] mesh_out Structure for store the parsed model
+   * @throw runtime_error
+   */
+  void ParseModelChanges(const std::string& filepath, MeshData& mesh_out);
+
+  /** @brief Replace the model by the new version of file, the current
+   * transform of the model is kept
+   * @param[in, out] mesh Parsed model, its arrays are moved to the model
+   */
+  void ReloadModelMesh(MeshData& mesh);
+
+  /** @brief Copy the model with all transforms applied, the copy may be
+   * exported on a background thread while the model is changed
+   * @param[out] mesh_out Structure for store the model
+   */
+  void CopyModelMesh(MeshData& mesh_out);
+
+  /** @brief Write the model to obj, stl or ply file by its extension
+   * May be called on a background thread, but not concurrently with itself
+   * @param[in] filepath Path to file
+   * @param[in] mesh Model copied by CopyModelMesh
+   * @throw runtime_error
+   */
+  void ExportModel(const std::string& filepath, const MeshData& mesh);
+
   /** @brief Rotate the model around the specified axis (X, Y, or Z)
    * @param angle The angle to rotate
    * @param axis The axis to rotate around (X, Y, or Z)
@@ -52,10 +95,45 @@ class Controller {
    */
   void TranslateModelPosition(float x, float y, float z);
 
+  /** @brief Apply a composite transform to the model in a single pass
+   * @param transform Composition of rotations, scales and translations
+   */
+  void TransformModel(const AffineTransform& transform);
+
+  /** @brief Enable or disable transforms without accumulation of the
+   * floating point error, at the cost of a double precision copy of vertices
+   * @param enable Mode state
+   */
+  void SetStableTransform(bool enable);
+
+  /** @brief Enable or disable keeping faces split into triangles, at the
+   * cost of three indices per triangle
+   * @param enable Mode state
+   */
+  void SetKeepTriangles(bool enable);
+
+  /** @brief Set the kind of normals of kept triangles for the shading of
+   * faces, normals are recomputed in parallel on every transform
+   * @param mode Per triangle, per vertex or no normals
+   */
+  void SetSurfaceNormals(SurfaceNormals mode);
+
+  /** @brief Set the memory budget of model load, larger models are parsed
+   * through temporary files
+   * @param memory_budget Size in bytes, zero for unlimited
+   */
+  void SetMemoryBudget(size_t memory_budget);
+
   /** @brief Get the raw array of vertices and polygons of the model
    */
   void GetModelMesh(vertexType** vertices, polygonType** polygon);
 
+  /** @brief Get the axis aligned bounding box of the model
+   * @param[out] min Minimal coordinates on the XYZ axis
+   * @param[out] max Maximal coordinates on the XYZ axis
+   */
+  void GetModelBounds(vertexType min[3], vertexType max[3]);
+
   /** @brief Get the count of vertices of the model
    */
   unsigned int GetCountVertices();
@@ -68,6 +146,23 @@ class Controller {
    */
   unsigned int GetCountFacesIndices();
 
+  /** @brief Get the raw array of triangle indices of the model, empty if
+   * triangles are not kept
+   */
+  polygonType* GetModelTriangles();
+
+  /** @brief Get the count of triangle indices of the model
+   */
+  unsigned int GetCountTrianglesIndices();
+
+  /** @brief Get the raw array of surface normals of the model
+   */
+  const vertexType* GetModelSurfaceNormals();
+
+  /** @brief Get the count of surface normals of the model
+   */
+  unsigned int GetCountSurfaceNormals();
+
  private:
   /** @brief default constructor */
   Controller() = default;
@@ -76,6 +171,8 @@ class Controller {
   ~Controller() = default;
 
   Model model_;
+  MeshCache cache_;
+  FileWriter writer_;
 };  // class Controller
 }  // namespace ModelViewer3D
 #endif  // SRC_CONTROLLER_CONTROLLER_H_
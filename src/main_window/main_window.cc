@@ -6,15 +6,21 @@
 
 #include "main_window/main_window.h"
 
+#include <QApplication>
 #include <QColorDialog>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QImage>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QSettings>
 #include <QSlider>
+#include <QStatusBar>
 #include <QWidget>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 #if DEBUG == 1
 #include <string>
 #endif  // DEBUG == 1
@@ -37,11 +43,28 @@ static const char* kOutDir = MACROTOSTR(OUT_DIR);
 
 static const char* kWindowTitle = "3D Viewer ";
 static constexpr double kDegToRad = M_PI / 180.0;
+// Editors write files by several calls, reload waits for the last one
+static constexpr int kReloadDelayMs = 300;
+static constexpr int kRecentFilesCount = 8;
+// Only the most recent files are parsed in advance, others cost too much
+static constexpr int kPreloadFilesCount = 2;
+static constexpr int kGifFramesCount = 50;
+// Widths of tiled screenshots, 8K by default
+static constexpr int kLargeScreenshotWidth = 7680;
+static constexpr int kMaxScreenshotWidth = 32768;
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent), ui(new Ui::MainWindow) {
   ui->setupUi(this);
   ui->SettingsWindowMain->hide();
+
+  file_watcher_ = new QFileSystemWatcher(this);
+  reload_timer_ = new QTimer(this);
+  reload_timer_->setSingleShot(true);
+  reload_timer_->setInterval(kReloadDelayMs);
+  reload_watcher_ = new QFutureWatcher<QString>(this);
+  export_watcher_ = new QFutureWatcher<QString>(this);
+  recent_menu_ = ui->menuFile->addMenu("Recent");
   SetConnections();
 
   LoadSetting();
@@ -49,6 +72,8 @@ MainWindow::MainWindow(QWidget* parent)
 }
 
 MainWindow::~MainWindow() {
+  reload_watcher_->waitForFinished();
+  export_watcher_->waitForFinished();
   SaveSetting();
   if (gif_) delete gif_;
   if (gif_timer_) delete gif_timer_;
@@ -57,6 +82,18 @@ MainWindow::~MainWindow() {
 
 void MainWindow::SetConnections() {
   connect(ui->actionFileOpen, &QAction::triggered, this, &MainWindow::Import);
+  connect(file_watcher_, &QFileSystemWatcher::fileChanged, this,
+          &MainWindow::ModelFileChanged);
+  connect(reload_timer_, &QTimer::timeout, this, &MainWindow::ReloadModel);
+  connect(reload_watcher_, &QFutureWatcher<QString>::finished, this,
+          &MainWindow::ReloadFinished);
+  connect(ui->actionFileExport, &QAction::triggered, this,
+          &MainWindow::Export);
+  connect(export_watcher_, &QFutureWatcher<QString>::finished, this,
+          &MainWindow::ExportFinished);
+  // Message box is not shown inside of the context initialization
+  connect(ui->openGLWidget, &Viewer::RenderBackendFailed, this,
+          &MainWindow::RenderBackendFailed, Qt::QueuedConnection);
   connect(this->ui->actionSettingsOpen, &QAction::triggered, this,
           &MainWindow::SettingWindowOpen);
   connect(this->ui->buttonSettingClose, &QPushButton::clicked, this,
@@ -66,6 +103,8 @@ void MainWindow::SetConnections() {
           &MainWindow::MakeJpgScreenshot);
   connect(ui->actionbmp, &QAction::triggered, this,
           &MainWindow::MakeBmpScreenshot);
+  connect(ui->actionLargeBmp, &QAction::triggered, this,
+          &MainWindow::MakeLargeScreenshot);
 
   connect(ui->pushButton_TranslateXPlus, &QPushButton::clicked, this,
           &MainWindow::TranslateModelXPlus);
@@ -142,7 +181,7 @@ void MainWindow::SetBackgroundColor() {
     ModelViewer3D::qColorToRGB(color, ui->openGLWidget->background_color_.r,
                      ui->openGLWidget->background_color_.g,
                      ui->openGLWidget->background_color_.b);
-    ui->openGLWidget->update();
+    ui->openGLWidget->RequestFrame(ModelViewer3D::kColorChange);
   }
 
   delete color_window;
@@ -156,7 +195,7 @@ void MainWindow::SetBackgroundColor() {
 void MainWindow::SetVertexSize() {
   int line_size = ui->horizontalSlider_PointSize->sliderPosition();
   ui->openGLWidget->vertex_settings_.size = line_size;
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "vertex size: " << line_size;
@@ -176,7 +215,7 @@ void MainWindow::SetVertexColor() {
     ModelViewer3D::qColorToRGB(color, ui->openGLWidget->vertex_settings_.color.r,
                      ui->openGLWidget->vertex_settings_.color.g,
                      ui->openGLWidget->vertex_settings_.color.b);
-    ui->openGLWidget->update();
+    ui->openGLWidget->RequestFrame(ModelViewer3D::kColorChange);
   }
 
   delete color_window;
@@ -189,24 +228,24 @@ void MainWindow::SetVertexColor() {
 
 void MainWindow::SetPointTypeRound() {
   ui->openGLWidget->set_vertex_strategy(new ModelViewer3D::RoundVertex);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 }
 
 void MainWindow::SetPointTypeSquare() {
   ui->openGLWidget->set_vertex_strategy(new ModelViewer3D::SquareVertex);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 }
 
 void MainWindow::SetPointTypeNone() {
   ui->openGLWidget->set_vertex_strategy(nullptr);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 }
 
 // TODO: set horizontalSlider_EdgeSize from 1 to 10 (mb with step 0.1)
 void MainWindow::SetLineSize() {
   int line_size = ui->horizontalSlider_EdgeSize->sliderPosition();
   ui->openGLWidget->line_settings_.size = line_size;
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "line size: " << line_size;
@@ -226,7 +265,7 @@ void MainWindow::SetLineColor() {
     ModelViewer3D::qColorToRGB(color, ui->openGLWidget->line_settings_.color.r,
                      ui->openGLWidget->line_settings_.color.g,
                      ui->openGLWidget->line_settings_.color.b);
-    ui->openGLWidget->update();
+    ui->openGLWidget->RequestFrame(ModelViewer3D::kColorChange);
   }
 
   delete color_window;
@@ -239,7 +278,7 @@ void MainWindow::SetLineColor() {
 
 void MainWindow::SetLineTypeNone() {
   ui->openGLWidget->set_line_strategy(nullptr);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "line: none";
@@ -248,7 +287,7 @@ void MainWindow::SetLineTypeNone() {
 
 void MainWindow::SetLineTypeSolid() {
   ui->openGLWidget->set_line_strategy(new ModelViewer3D::SolidLine);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "line: solid";
@@ -257,7 +296,7 @@ void MainWindow::SetLineTypeSolid() {
 
 void MainWindow::SetLineTypeDashed() {
   ui->openGLWidget->set_line_strategy(new ModelViewer3D::DashedLine);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "line: dashed";
@@ -267,7 +306,7 @@ void MainWindow::SetLineTypeDashed() {
 void MainWindow::SetProjectionPerspective() {
   ui->openGLWidget->set_projection_strategy(new ModelViewer3D::CentralProjection);
   ui->openGLWidget->Resize();
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "projection: perspective";
@@ -277,7 +316,7 @@ void MainWindow::SetProjectionPerspective() {
 void MainWindow::SetProjectionOrthographic() {
   ui->openGLWidget->set_projection_strategy(new ModelViewer3D::ParallelProjection);
   ui->openGLWidget->Resize();
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kStrategyChange);
 
 #if DEBUG == 1
   qDebug() << "projection: orthographic";
@@ -288,7 +327,7 @@ void MainWindow::SetProjectionOrthographic() {
 void MainWindow::ScaleModelPlus() {
   int step = ui->spinBox_ScaleStep->value();
   ModelViewer3D::Controller::Instance().SetModelScale(step);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "scale step: " << step;
@@ -299,7 +338,7 @@ void MainWindow::ScaleModelMinus() {
   float step = ui->spinBox_ScaleStep->value();
   step = 1.0 / step;
   ModelViewer3D::Controller::Instance().SetModelScale(step);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "scale step: " << step;
@@ -309,7 +348,7 @@ void MainWindow::ScaleModelMinus() {
 void MainWindow::RotateModelXPlus() {
   int step = ui->spinBox_RotateXStep->value();
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kX);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step x: " << step;
@@ -319,7 +358,7 @@ void MainWindow::RotateModelXPlus() {
 void MainWindow::RotateModelXMinus() {
   int step = -(ui->spinBox_RotateXStep->value());
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kX);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step x: " << step;
@@ -329,7 +368,7 @@ void MainWindow::RotateModelXMinus() {
 void MainWindow::RotateModelYPlus() {
   int step = ui->spinBox_RotateYStep->value();
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kY);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step y: " << step;
@@ -339,7 +378,7 @@ void MainWindow::RotateModelYPlus() {
 void MainWindow::RotateModelYMinus() {
   int step = -(ui->spinBox_RotateYStep->value());
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kY);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step y: " << step;
@@ -349,7 +388,7 @@ void MainWindow::RotateModelYMinus() {
 void MainWindow::RotateModelZPlus() {
   int step = ui->spinBox_RotateZStep->value();
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kZ);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step z: " << step;
@@ -359,7 +398,7 @@ void MainWindow::RotateModelZPlus() {
 void MainWindow::RotateModelZMinus() {
   int step = -(ui->spinBox_RotateZStep->value());
   ModelViewer3D::Controller::Instance().RotateModel(step * kDegToRad, ModelViewer3D::kZ);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "rotate step z: " << step;
@@ -369,7 +408,7 @@ void MainWindow::RotateModelZMinus() {
 void MainWindow::TranslateModelXPlus() {
   int step = ui->spinBox_TranslateXStep->value();
   ModelViewer3D::Controller::Instance().TranslateModelPosition(step, 0, 0);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step x: " << step;
@@ -379,7 +418,7 @@ void MainWindow::TranslateModelXPlus() {
 void MainWindow::TranslateModelXMinus() {
   int step = -(ui->spinBox_TranslateXStep->value());
   ModelViewer3D::Controller::Instance().TranslateModelPosition(step, 0, 0);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step x: " << step;
@@ -389,7 +428,7 @@ void MainWindow::TranslateModelXMinus() {
 void MainWindow::TranslateModelYPlus() {
   int step = ui->spinBox_TranslateYStep->value();
   ModelViewer3D::Controller::Instance().TranslateModelPosition(0, step, 0);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step y: " << step;
@@ -399,7 +438,7 @@ void MainWindow::TranslateModelYPlus() {
 void MainWindow::TranslateModelYMinus() {
   int step = -(ui->spinBox_TranslateYStep->value());
   ModelViewer3D::Controller::Instance().TranslateModelPosition(0, step, 0);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step y: " << step;
@@ -409,7 +448,7 @@ void MainWindow::TranslateModelYMinus() {
 void MainWindow::TranslateModelZPlus() {
   int step = ui->spinBox_TranslateZStep->value();
   ModelViewer3D::Controller::Instance().TranslateModelPosition(0, 0, step);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step z: " << step;
@@ -419,7 +458,7 @@ void MainWindow::TranslateModelZPlus() {
 void MainWindow::TranslateModelZMinus() {
   int step = -(ui->spinBox_TranslateZStep->value());
   ModelViewer3D::Controller::Instance().TranslateModelPosition(0, 0, step);
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kTransformChange);
 
 #if DEBUG == 1
   qDebug() << "translate step z: " << step;
@@ -430,16 +469,105 @@ void MainWindow::Import() {
   QString PathtoParse =
       QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
   QString filePath = QFileDialog::getOpenFileName(
-      this, "Import", PathtoParse, tr("OBJ files (*.obj);;Other files (*)"));
+      this, "Import", PathtoParse,
+      tr("Model files (*.obj *.stl *.ply *.gltf *.glb);;OBJ files (*.obj);;"
+         "STL files (*.stl);;PLY files (*.ply);;"
+         "glTF files (*.gltf *.glb);;Compressed files (*.gz *.zst);;"
+         "Other files (*)"));
 
   if (filePath.isEmpty()) {
     return;
   }
 
+  OpenModel(filePath);
+}
+
+void MainWindow::Export() {
+  if (export_watcher_->isRunning()) {
+    return;
+  }
+
+  QString PathtoExport =
+      QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
+  QString selected_filter;
+  QString filePath = QFileDialog::getSaveFileName(
+      this, "Export", PathtoExport,
+      tr("OBJ files (*.obj);;STL files (*.stl);;PLY files (*.ply)"),
+      &selected_filter);
+
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  // Format is chosen by extension, the one of selected filter by default
+  if (QFileInfo(filePath).suffix().isEmpty()) {
+    filePath += selected_filter.startsWith("STL")   ? ".stl"
+                : selected_filter.startsWith("PLY") ? ".ply"
+                                                    : ".obj";
+  }
+
+  // Model may be changed while the copy is written
+  auto mesh = std::make_shared<ModelViewer3D::MeshData>();
+  ModelViewer3D::Controller::Instance().CopyModelMesh(*mesh);
+  std::string path = filePath.toStdString();
+
+  ui->actionFileExport->setEnabled(false);
+  export_watcher_->setFuture(QtConcurrent::run([path, mesh]() -> QString {
+    try {
+      ModelViewer3D::Controller::Instance().ExportModel(path, *mesh);
+    } catch (std::exception& exc) {
+      return QString(exc.what());
+    }
+    return QString();
+  }));
+}
+
+void MainWindow::ExportFinished() {
+  QString error = export_watcher_->result();
+  ui->actionFileExport->setEnabled(true);
+
+  if (!error.isEmpty()) {
+    QMessageBox error_box;
+    error_box.setIcon(QMessageBox::NoIcon);
+    error_box.setWindowTitle("Error");
+    error_box.setText(error);
+    error_box.exec();
+  } else {
+    statusBar()->showMessage("Model is exported", 3000);
+  }
+}
+
+void MainWindow::RenderBackendFailed(const QString& message) {
+  // The next start creates the default context for the legacy backend
+  QSettings settings(kSettingsFilename, QSettings::IniFormat);
+  settings.setValue("render_backend", ModelViewer3D::kLegacyBackend);
+
+  QMessageBox error_box;
+  error_box.setIcon(QMessageBox::NoIcon);
+  error_box.setWindowTitle("Error");
+  error_box.setText(message);
+  error_box.exec();
+}
+
+void MainWindow::OpenRecentFile() {
+  QAction* action = qobject_cast<QAction*>(sender());
+
+  if (action) {
+    OpenModel(action->data().toString());
+  }
+}
+
+void MainWindow::OpenModel(QString filePath) {
+  // Running reload is of the previous file, its result is dropped
+  reload_timer_->stop();
+  is_reload_pending_ = false;
+
   ModelViewer3D::Controller& controller = ModelViewer3D::Controller::Instance();
 
   try {
     controller.LoadModel(filePath.toStdString());
+    WatchModelFile(filePath);
+    AddRecentFile(filePath);
     filePath = " - " + filePath;
   } catch (std::exception& exc) {
     QMessageBox error_box;
@@ -448,12 +576,18 @@ void MainWindow::Import() {
     error_box.setText(exc.what());
     error_box.exec();
     filePath = QString::fromStdString("");
+    WatchModelFile(filePath);
 
 #if DEBUG == 1
     qDebug() << "Exception on import: " << std::string(exc.what()) << "\n";
 #endif  // DEBUG == 1
   }
 
+  UpdateModelView(filePath);
+}
+
+void MainWindow::UpdateModelView(const QString& file_path) {
+  ModelViewer3D::Controller& controller = ModelViewer3D::Controller::Instance();
   vertexType* vertices_array;
   polygonType* faces_array;
 
@@ -465,16 +599,134 @@ void MainWindow::Import() {
 
   ui->openGLWidget->set_vertices(vertices_array, vertices_count);
   ui->openGLWidget->set_faces(faces_array, faces_size);
+  ui->openGLWidget->set_triangles(controller.GetModelTriangles(),
+                                  controller.GetCountTrianglesIndices());
+  ui->openGLWidget->set_surface_normals(controller.GetModelSurfaceNormals(),
+                                        controller.GetCountSurfaceNormals());
   ui->openGLWidget->Resize();
-  ui->openGLWidget->update();
+  ui->openGLWidget->RequestFrame(ModelViewer3D::kGeometryChange);
 
-  setWindowTitle(QString(kWindowTitle) + filePath);
+  setWindowTitle(QString(kWindowTitle) + file_path);
   ui->label_VerticesCountValue->setText(
       QString::fromStdString(std::to_string(vertices_count)));
   ui->label_EdgesCountValue->setText(
       QString::fromStdString(std::to_string(edges_count)));
 }
 
+void MainWindow::AddRecentFile(const QString& file_path) {
+  recent_files_.removeAll(file_path);
+  recent_files_.prepend(file_path);
+
+  while (recent_files_.size() > kRecentFilesCount) {
+    recent_files_.removeLast();
+  }
+
+  UpdateRecentMenu();
+  PreloadRecentFiles();
+}
+
+void MainWindow::UpdateRecentMenu() {
+  recent_menu_->clear();
+
+  for (const QString& file_path : recent_files_) {
+    QAction* action = recent_menu_->addAction(file_path);
+    action->setData(file_path);
+    connect(action, &QAction::triggered, this, &MainWindow::OpenRecentFile);
+  }
+
+  recent_menu_->setEnabled(!recent_files_.isEmpty());
+}
+
+void MainWindow::PreloadRecentFiles() {
+  std::vector<std::string> file_paths;
+
+  // The opened model is in the cache already
+  for (const QString& file_path : recent_files_) {
+    if (int(file_paths.size()) == kPreloadFilesCount) {
+      break;
+    }
+
+    if (file_path != model_path_) {
+      file_paths.push_back(file_path.toStdString());
+    }
+  }
+
+  ModelViewer3D::Controller::Instance().PreloadModels(file_paths);
+}
+
+void MainWindow::WatchModelFile(const QString& file_path) {
+  if (!file_watcher_->files().isEmpty()) {
+    file_watcher_->removePaths(file_watcher_->files());
+  }
+  model_path_ = is_watch_enabled_ ? file_path : QString();
+
+  if (!model_path_.isEmpty()) {
+    file_watcher_->addPath(model_path_);
+  }
+}
+
+void MainWindow::ModelFileChanged(const QString& path) {
+  if (path != model_path_) {
+    return;
+  }
+
+  // Saving by rename replaces the file, which removes it from the watcher
+  if (!file_watcher_->files().contains(path) && QFileInfo::exists(path)) {
+    file_watcher_->addPath(path);
+  }
+  reload_timer_->start();
+}
+
+void MainWindow::ReloadModel() {
+  if (reload_watcher_->isRunning()) {
+    is_reload_pending_ = true;
+    return;
+  }
+
+  // The first reload parses the whole file and keeps its chunks for next
+  auto mesh = std::make_shared<ModelViewer3D::MeshData>();
+  reload_mesh_ = mesh;
+  reload_path_ = model_path_;
+  std::string path = model_path_.toStdString();
+
+  reload_watcher_->setFuture(QtConcurrent::run([path, mesh]() -> QString {
+    try {
+      ModelViewer3D::Controller::Instance().ParseModelChanges(path, *mesh);
+    } catch (std::exception& exc) {
+      return QString(exc.what());
+    }
+    return QString();
+  }));
+}
+
+void MainWindow::ReloadFinished() {
+  QString error = reload_watcher_->result();
+
+  // Partly written file fails to parse, the next change reloads it again
+  if (error.isEmpty() && !model_path_.isEmpty() &&
+      reload_path_ == model_path_) {
+    ModelViewer3D::Controller::Instance().ReloadModelMesh(*reload_mesh_);
+    UpdateModelView(" - " + model_path_);
+  }
+  reload_mesh_.reset();
+
+#if DEBUG == 1
+  if (!error.isEmpty()) {
+    qDebug() << "Exception on reload: " << error << "\n";
+  }
+#endif  // DEBUG == 1
+
+  if (!model_path_.isEmpty() && !file_watcher_->files().contains(model_path_) &&
+      QFileInfo::exists(model_path_)) {
+    file_watcher_->addPath(model_path_);
+  }
+
+  if (is_reload_pending_) {
+    is_reload_pending_ = false;
+    ReloadModel();
+  }
+}
+
 void MainWindow::SettingWindowOpen() { this->ui->SettingsWindowMain->show(); }
 
 void MainWindow::SettingWindowClose() { this->ui->SettingsWindowMain->hide(); }
@@ -491,45 +743,106 @@ void MainWindow::MakeGif() {
 }
 
 void MainWindow::captureFrame() {
-  QImage frame = ui->openGLWidget->grab().toImage();
-  QImage scaledFrame = frame.scaled(QSize(640, 480), Qt::IgnoreAspectRatio,
-                                    Qt::SmoothTransformation);
-  gif_->addFrame(scaledFrame, 100);
-
   framesCaptured_++;
 
-  if (framesCaptured_ >= 50) {
+  if (framesCaptured_ >= kGifFramesCount) {
     disconnect(gif_timer_, &QTimer::timeout, this, &MainWindow::captureFrame);
     gif_timer_->stop();
     delete gif_timer_;
     gif_timer_ = nullptr;
-    QString PathtoGif =
-        QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
-    QString gif_save_path = QFileDialog::getSaveFileName(
-        this, "Save Gif", PathtoGif, tr("GIF (*.gif);;Other files (*)"));
-    gif_->save(gif_save_path);
-    delete gif_;
-    gif_ = nullptr;
   }
+
+  // Frames come back asynchronously, the gif is saved after the last one
+  ui->openGLWidget->CaptureFrame([this](const QImage& frame) {
+    if (!gif_) return;
+    if (frame.isNull()) {
+      // Gif would never get all of its frames
+      AbortGif();
+      return;
+    }
+    gif_->addFrame(frame.scaled(QSize(640, 480), Qt::IgnoreAspectRatio,
+                                Qt::SmoothTransformation),
+                   100);
+    if (gif_->frameCount() >= kGifFramesCount) SaveGif();
+  });
+}
+
+void MainWindow::SaveGif() {
+  QString PathtoGif =
+      QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
+  QString gif_save_path = QFileDialog::getSaveFileName(
+      this, "Save Gif", PathtoGif, tr("GIF (*.gif);;Other files (*)"));
+  gif_->save(gif_save_path);
+  delete gif_;
+  gif_ = nullptr;
+}
+
+void MainWindow::AbortGif() {
+  if (gif_timer_) {
+    // Abort can come from the timeout of the timer itself
+    gif_timer_->stop();
+    gif_timer_->deleteLater();
+    gif_timer_ = nullptr;
+  }
+  delete gif_;
+  gif_ = nullptr;
+  statusBar()->showMessage("Could not capture the frame of gif", 3000);
 }
 
 void MainWindow::MakeJpgScreenshot() {
-  QImage frame = ui->openGLWidget->grab().toImage();
+  ui->openGLWidget->CaptureFrame(
+      [this](const QImage& frame) { SaveScreenshot(frame, "JPG (*.jpg)"); });
+}
+
+void MainWindow::MakeBmpScreenshot() {
+  ui->openGLWidget->CaptureFrame(
+      [this](const QImage& frame) { SaveScreenshot(frame, "BMP (*.bmp)"); });
+}
+
+void MainWindow::MakeLargeScreenshot() {
+  bool is_accepted = false;
+  int width = QInputDialog::getInt(this, "Large Screenshot", "Width, pixels",
+                                   kLargeScreenshotWidth, 1,
+                                   kMaxScreenshotWidth, 1, &is_accepted);
+  if (!is_accepted) return;
+
+  // Height keeps the aspect ratio of the view
+  int height =
+      std::max(1, qRound(width / ui->openGLWidget->get_aspect_ratio()));
+
   QString PathtoScreenshot =
       QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
-  QString screenshot_save_path =
-      QFileDialog::getSaveFileName(this, "Save Screenshot", PathtoScreenshot,
-                                   tr("JPG (*.jpg);;Other files (*)"));
-  frame.save(screenshot_save_path);
+  QString screenshot_save_path = QFileDialog::getSaveFileName(
+      this, "Save Screenshot", PathtoScreenshot, tr("BMP (*.bmp)"));
+  if (screenshot_save_path.isEmpty()) return;
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool is_rendered =
+      ui->openGLWidget->RenderToFile(screenshot_save_path, width, height);
+  QApplication::restoreOverrideCursor();
+
+  if (!is_rendered) {
+    QMessageBox error_box;
+    error_box.setIcon(QMessageBox::NoIcon);
+    error_box.setWindowTitle("Error");
+    error_box.setText("Could not render the screenshot");
+    error_box.exec();
+  } else {
+    statusBar()->showMessage("Screenshot is saved", 3000);
+  }
 }
 
-void MainWindow::MakeBmpScreenshot() {
-  QImage frame = ui->openGLWidget->grab().toImage();
+void MainWindow::SaveScreenshot(const QImage& frame, const QString& filter) {
+  if (frame.isNull()) {
+    statusBar()->showMessage("Could not capture the screenshot", 3000);
+    return;
+  }
+
   QString PathtoScreenshot =
       QDir(qApp->applicationDirPath()).absoluteFilePath(kOutDir);
   QString screenshot_save_path =
       QFileDialog::getSaveFileName(this, "Save Screenshot", PathtoScreenshot,
-                                   tr("BMP (*.bmp);;Other files (*)"));
+                                   filter + tr(";;Other files (*)"));
   frame.save(screenshot_save_path);
 }
 
@@ -570,6 +883,66 @@ void MainWindow::LoadSetting() {
   ui->horizontalSlider_PointSize->setValue(
       ui->openGLWidget->vertex_settings_.size);
 
+  // Stable mode keeps a double copy of vertices, it is enabled on demand
+  ModelViewer3D::Controller::Instance().SetStableTransform(
+      settings.value("stable_transform", false).toBool());
+  is_watch_enabled_ = settings.value("watch_model_file", true).toBool();
+  // Budget of model load in megabytes, zero for unlimited
+  ModelViewer3D::Controller::Instance().SetMemoryBudget(
+      settings.value("load_memory_budget", 0).toULongLong() << 20);
+  // Size of parsed models kept in memory in megabytes, zero disables cache
+  ModelViewer3D::Controller::Instance().SetCacheBudget(
+      settings.value("mesh_cache_budget", 256).toULongLong() << 20);
+
+  // Context format is fixed once the widget is initialized
+  if (!ui->openGLWidget->isValid()) {
+    ui->openGLWidget->set_render_backend(
+        static_cast<ModelViewer3D::RenderBackend>(
+            settings
+                .value("render_backend", ModelViewer3D::kLegacyBackend)
+                .toInt()));
+  }
+
+  // Frames per second, zero to follow the refresh rate of display
+  ui->openGLWidget->set_frame_rate_cap(
+      settings.value("frame_rate_cap", 0).toInt());
+
+  // Wide lines and large points of the shader backend are drawn as quads
+  ui->openGLWidget->set_element_mode(static_cast<ModelViewer3D::ElementMode>(
+      settings.value("element_mode", ModelViewer3D::kPrimitiveElements)
+          .toInt()));
+  // Edges and vertices of the shader backend are cached in separate layers
+  ui->openGLWidget->set_layer_cache(
+      settings.value("layer_cache", true).toBool());
+  // Edges behind faces are hidden, faces are kept split into triangles
+  bool is_hidden_lines = settings.value("hidden_lines", false).toBool();
+  ui->openGLWidget->set_hidden_lines(is_hidden_lines);
+  // Faces are filled and lit, 0 - none, 1 - flat, 2 - smooth shading
+  int surface_setting =
+      settings.value("surface_mode", ModelViewer3D::kNoNormals).toInt();
+  // Stale or edited value out of the enum falls back to the default
+  if (surface_setting < ModelViewer3D::kNoNormals ||
+      surface_setting > ModelViewer3D::kSmoothNormals) {
+    surface_setting = ModelViewer3D::kNoNormals;
+  }
+  ModelViewer3D::SurfaceNormals surface_mode =
+      static_cast<ModelViewer3D::SurfaceNormals>(surface_setting);
+  ui->openGLWidget->set_surface_mode(surface_mode);
+  ui->openGLWidget->surface_color_.r =
+      settings.value("Color_surface_redF", 0.7).toFloat();
+  ui->openGLWidget->surface_color_.g =
+      settings.value("Color_surface_greenF", 0.7).toFloat();
+  ui->openGLWidget->surface_color_.b =
+      settings.value("Color_surface_blueF", 0.7).toFloat();
+  // Triangles and normals take memory only in these modes
+  ModelViewer3D::Controller::Instance().SetKeepTriangles(
+      is_hidden_lines || surface_mode != ModelViewer3D::kNoNormals);
+  ModelViewer3D::Controller::Instance().SetSurfaceNormals(surface_mode);
+
+  recent_files_ = settings.value("recent_files").toStringList();
+  UpdateRecentMenu();
+  PreloadRecentFiles();
+
   switch (settings.value("vertex_type", ModelViewer3D::kSquareVertex).toInt()) {
     case ModelViewer3D::kNoneVertex:
       ui->openGLWidget->set_vertex_strategy(nullptr);
@@ -641,5 +1014,7 @@ void MainWindow::SaveSetting() {
 
   settings.setValue("projection_type", ui->openGLWidget->get_projection_type());
 
+  settings.setValue("recent_files", recent_files_);
+
   settings.endGroup();
 }
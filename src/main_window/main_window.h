@@ -4,10 +4,17 @@
 #ifndef SRC_MAIN_WINDOW_MAIN_WINDOW_H_
 #define SRC_MAIN_WINDOW_MAIN_WINDOW_H_
 
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QImage>
 #include <QMainWindow>
+#include <QMenu>
+#include <QStringList>
 #include <QTimer>
+#include <memory>
 
 #include "../QtGifimage/gifimage/qgifimage.h"
+#include "model/mesh_data.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -30,6 +37,7 @@ class MainWindow : public QMainWindow {
   void captureFrame();
   void MakeJpgScreenshot();
   void MakeBmpScreenshot();
+  void MakeLargeScreenshot();
   void LoadSetting();
   void SaveSetting();
   void TranslateModelXPlus();
@@ -59,13 +67,43 @@ class MainWindow : public QMainWindow {
   void SetVertexColor();
   void SetVertexSize();
   void SetBackgroundColor();
+  void ModelFileChanged(const QString &path);
+  void ReloadModel();
+  void ReloadFinished();
+  void OpenRecentFile();
+  void Export();
+  void ExportFinished();
+  void RenderBackendFailed(const QString &message);
 
  private:
   void SetConnections();
+  void OpenModel(QString filePath);
+  void AddRecentFile(const QString &file_path);
+  void UpdateRecentMenu();
+  void PreloadRecentFiles();
+  void UpdateModelView(const QString &file_path);
+  void WatchModelFile(const QString &file_path);
+  void SaveGif();
+  void AbortGif();
+  void SaveScreenshot(const QImage &frame, const QString &filter);
 
   QGifImage *gif_ = nullptr;
   QTimer *gif_timer_ = nullptr;
   int framesCaptured_;
+  // Watch of the loaded model file and its reload in background
+  QFileSystemWatcher *file_watcher_ = nullptr;
+  QTimer *reload_timer_ = nullptr;
+  QFutureWatcher<QString> *reload_watcher_ = nullptr;
+  std::shared_ptr<ModelViewer3D::MeshData> reload_mesh_;
+  QString model_path_;
+  QString reload_path_;
+  bool is_watch_enabled_ = true;
+  bool is_reload_pending_ = false;
+  // Recently opened models, the last one is the first
+  QMenu *recent_menu_ = nullptr;
+  QStringList recent_files_;
+  // Export of the model copy in background
+  QFutureWatcher<QString> *export_watcher_ = nullptr;
   Ui::MainWindow *ui;
 };
 #endif  // SRC_MAIN_WINDOW_MAIN_WINDOW_H_
@@ -0,0 +1,90 @@
+/** @file
+ * @brief Definition of AffineTransform class
+ */
+#include "model/affine_transform.h"
+
+#include <cmath>
+
+namespace ModelViewer3D {
+AffineTransform::AffineTransform() {
+  for (unsigned row = 0; row < 3; ++row) {
+    for (unsigned col = 0; col < 4; ++col) {
+      this->m_[row][col] = (row == col) ? 1 : 0;
+    }
+  }
+}
+
+AffineTransform AffineTransform::RotationX(double angle) {
+  AffineTransform result;
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
+  result(1, 1) = cos_angle;
+  result(1, 2) = sin_angle;
+  result(2, 1) = -sin_angle;
+  result(2, 2) = cos_angle;
+  return result;
+}
+
+AffineTransform AffineTransform::RotationY(double angle) {
+  AffineTransform result;
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
+  result(0, 0) = cos_angle;
+  result(0, 2) = sin_angle;
+  result(2, 0) = -sin_angle;
+  result(2, 2) = cos_angle;
+  return result;
+}
+
+AffineTransform AffineTransform::RotationZ(double angle) {
+  AffineTransform result;
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
+  result(0, 0) = cos_angle;
+  result(0, 1) = -sin_angle;
+  result(1, 0) = sin_angle;
+  result(1, 1) = cos_angle;
+  return result;
+}
+
+AffineTransform AffineTransform::Scale(double value) {
+  AffineTransform result;
+  result(0, 0) = value;
+  result(1, 1) = value;
+  result(2, 2) = value;
+  return result;
+}
+
+AffineTransform AffineTransform::Translation(double x, double y, double z) {
+  AffineTransform result;
+  result(0, 3) = x;
+  result(1, 3) = y;
+  result(2, 3) = z;
+  return result;
+}
+
+AffineTransform AffineTransform::operator*(
+    const AffineTransform& other) const {
+  AffineTransform result;
+  for (unsigned row = 0; row < 3; ++row) {
+    for (unsigned col = 0; col < 4; ++col) {
+      double value = (col == 3) ? this->m_[row][3] : 0;
+      for (unsigned k = 0; k < 3; ++k) {
+        value += this->m_[row][k] * other.m_[k][col];
+      }
+      result.m_[row][col] = value;
+    }
+  }
+  return result;
+}
+
+bool AffineTransform::IsIdentity() const {
+  bool is_identity = true;
+  for (unsigned row = 0; row < 3 && is_identity; ++row) {
+    for (unsigned col = 0; col < 4 && is_identity; ++col) {
+      is_identity = this->m_[row][col] == ((row == col) ? 1 : 0);
+    }
+  }
+  return is_identity;
+}
+}  // namespace ModelViewer3D
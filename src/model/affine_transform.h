@@ -0,0 +1,53 @@
+/** @file
+ * @brief Declaration of AffineTransform class
+ */
+#ifndef SRC_MODEL_AFFINE_TRANSFORM_H_
+#define SRC_MODEL_AFFINE_TRANSFORM_H_
+
+namespace ModelViewer3D {
+/** @brief 3x4 affine matrix (rotation/scale part and translation column)
+ * which can be applied to the whole model in a single pass
+ */
+class AffineTransform {
+ public:
+  /** @brief Creates an identity transform */
+  AffineTransform();
+
+  /** @brief Rotation around the X axis */
+  static AffineTransform RotationX(double angle);
+
+  /** @brief Rotation around the Y axis */
+  static AffineTransform RotationY(double angle);
+
+  /** @brief Rotation around the Z axis */
+  static AffineTransform RotationZ(double angle);
+
+  /** @brief Uniform scale */
+  static AffineTransform Scale(double value);
+
+  /** @brief Translation on the XYZ axis */
+  static AffineTransform Translation(double x, double y, double z);
+
+  /** @brief Composition of transforms
+   * @param other Transform which is applied first
+   * @return Transform equal to applying other and then this
+   */
+  AffineTransform operator*(const AffineTransform& other) const;
+
+  /** @brief Access to the element at row and column
+   * @param row Row index from 0 to 2
+   * @param col Column index from 0 to 3, column 3 is the translation
+   */
+  double operator()(unsigned row, unsigned col) const {
+    return m_[row][col];
+  }
+  double& operator()(unsigned row, unsigned col) { return m_[row][col]; }
+
+  /** @brief Check for identity, in which case applying is useless */
+  bool IsIdentity() const;
+
+ private:
+  double m_[3][4];
+};  // AffineTransform
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_AFFINE_TRANSFORM_H_
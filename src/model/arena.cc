@@ -0,0 +1,70 @@
+/** @file
+ * @brief Definition of Arena class
+ */
+#include "model/arena.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace ModelViewer3D {
+Arena::Arena(size_t block_size) : block_size_(block_size) {}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  size_t padding =
+      (alignment - reinterpret_cast<uintptr_t>(this->current_) % alignment) %
+      alignment;
+
+  if (!this->current_ || padding + size > this->left_) {
+    size_t block_size = size + alignment;
+
+    if (block_size <= this->block_size_) {
+      block_size = this->block_size_;
+    }
+
+    // Memory is not initialized, scratch buffers are written before read
+    Block block = {std::unique_ptr<char[]>(new char[block_size]), block_size};
+    char* data = block.data.get();
+    this->reserved_size_ += block_size;
+
+    if (block_size == this->block_size_) {
+      // Regular block continues the bump allocation
+      this->current_ = data;
+      this->left_ = block_size;
+      this->blocks_.push_back(std::move(block));
+
+    } else {
+      // Large request is served by own block, the current one is kept
+      this->blocks_.push_back(std::move(block));
+      padding = (alignment - reinterpret_cast<uintptr_t>(data) % alignment) %
+                alignment;
+      return data + padding;
+    }
+
+    padding =
+        (alignment - reinterpret_cast<uintptr_t>(this->current_) % alignment) %
+        alignment;
+  }
+
+  char* result = this->current_ + padding;
+  this->current_ += padding + size;
+  this->left_ -= padding + size;
+
+  return result;
+}
+
+void Arena::Release() {
+  size_t kept = 0;
+
+  for (size_t i = 0; i < this->blocks_.size() && kept == 0; ++i) {
+    if (this->blocks_[i].size == this->block_size_) {
+      std::swap(this->blocks_[0], this->blocks_[i]);
+      kept = 1;
+    }
+  }
+
+  this->blocks_.resize(kept);
+  this->reserved_size_ = kept ? this->block_size_ : 0;
+  this->current_ = kept ? this->blocks_[0].data.get() : nullptr;
+  this->left_ = kept ? this->block_size_ : 0;
+}
+}  // namespace ModelViewer3D
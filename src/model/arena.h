@@ -0,0 +1,66 @@
+/** @file
+ * @brief Declaration of Arena class
+ */
+#ifndef SRC_MODEL_ARENA_H_
+#define SRC_MODEL_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Bump allocator for scratch memory of one model load
+ * Memory is taken from large blocks by moving a pointer and is never freed
+ * by pieces, all blocks are released at once after the load
+ */
+class Arena {
+ public:
+  /** @brief Create empty arena, blocks are allocated on demand
+   * @param block_size Size of regular block in bytes
+   */
+  explicit Arena(size_t block_size = kBlockSize);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /** @brief Get the aligned memory, large requests get own block
+   * @param size Size in bytes
+   * @param alignment Power of two alignment
+   * @throw bad_alloc
+   */
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /** @brief Get the uninitialized array of trivial type
+   * @param count Count of elements
+   * @throw bad_alloc
+   */
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    return static_cast<T*>(this->Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /** @brief Release all memory, the first regular block is kept for the next
+   * load
+   */
+  void Release();
+
+  /** @brief Get the size of all allocated blocks in bytes */
+  size_t GetReservedSize() const { return this->reserved_size_; }
+
+  // Default size of regular block
+  static constexpr size_t kBlockSize = 1 << 20;
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks_;
+  size_t block_size_;
+  size_t reserved_size_ = 0;
+  char* current_ = nullptr;
+  size_t left_ = 0;
+};  // Arena
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_ARENA_H_
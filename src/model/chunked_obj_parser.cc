@@ -0,0 +1,332 @@
+/** @file
+ * @brief Definition of ChunkedObjParser class
+ */
+#include "model/chunked_obj_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace ModelViewer3D {
+/** @brief Get the table of random values for the gear rolling hash */
+static const std::array<uint64_t, 256>& GearTable() {
+  static const std::array<uint64_t, 256> table = [] {
+    std::array<uint64_t, 256> values = {};
+    uint64_t state = 0x9E3779B97F4A7C15;
+
+    // Splitmix64 generator gives the same table on every run
+    for (uint64_t& value : values) {
+      state += 0x9E3779B97F4A7C15;
+      uint64_t mixed = state;
+      mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9;
+      mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EB;
+      value = mixed ^ (mixed >> 31);
+    }
+
+    return values;
+  }();
+
+  return table;
+}
+
+bool ChunkedObjParser::Reload(const std::string& filename,
+                              MeshData& mesh_out) {
+  FileProbe probe(filename);
+  if (probe.IsCompressed() || !this->Accepts(probe)) {
+    return false;
+  }
+
+  std::vector<char> text(probe.GetFileSize());
+  std::istream& file = probe.Rewind();
+  file.read(text.data(), text.size());
+  text.resize(file.gcount());
+
+  std::unordered_map<uint64_t, std::shared_ptr<const ParsedChunk>> chunks;
+  std::vector<std::shared_ptr<const ParsedChunk>> order;
+  this->reused_count_ = 0;
+  this->parsed_count_ = 0;
+
+  const char* end_p = text.data() + text.size();
+  for (const char* chunk_p = text.data(); chunk_p != end_p;) {
+    const char* chunk_end = FindChunkEnd(chunk_p, end_p);
+    uint64_t key = HashChunk(chunk_p, chunk_end);
+    size_t size = chunk_end - chunk_p;
+    uint64_t check = CheckChunk(chunk_p, chunk_end);
+    // Chunk is reused only if the second hash and the size match too
+    auto is_same = [size, check](const ParsedChunk& chunk) {
+      return chunk.size == size && chunk.check == check;
+    };
+
+    std::shared_ptr<const ParsedChunk> chunk;
+    auto found = chunks.find(key);
+    if (found != chunks.end() && is_same(*found->second)) {
+      chunk = found->second;
+
+    } else {
+      auto previous = this->chunks_.find(key);
+
+      if (previous != this->chunks_.end() && is_same(*previous->second)) {
+        chunk = previous->second;
+        ++this->reused_count_;
+
+      } else {
+        auto parsed = std::make_shared<ParsedChunk>();
+        this->ParseChunk(chunk_p, chunk_end, *parsed);
+        parsed->size = size;
+        parsed->check = check;
+        chunk = std::move(parsed);
+        ++this->parsed_count_;
+      }
+
+      // Chunk with the colliding key is parsed, but not kept
+      chunks.emplace(key, chunk);
+    }
+
+    order.push_back(std::move(chunk));
+    chunk_p = chunk_end;
+  }
+
+  MeshData mesh;
+  std::vector<std::pair<size_t, int64_t>> relative_indices;
+  int64_t max_index = 0;
+  size_t face_count = 0;
+  CornerIndices tex_coord_corners, normal_corners;
+
+  // Every array of the model is allocated once
+  size_t sizes[4] = {0, 0, 0, 0};
+  for (const std::shared_ptr<const ParsedChunk>& chunk : order) {
+    sizes[0] += chunk->mesh.vertices.size();
+    sizes[1] += chunk->mesh.polygons.size();
+    sizes[2] += chunk->mesh.tex_coords.size();
+    sizes[3] += chunk->mesh.normals.size();
+  }
+  mesh.vertices.reserve(sizes[0]);
+  mesh.polygons.reserve(sizes[1]);
+  mesh.tex_coords.reserve(sizes[2]);
+  mesh.normals.reserve(sizes[3]);
+
+  for (const std::shared_ptr<const ParsedChunk>& chunk : order) {
+    AppendChunk(*chunk, mesh, relative_indices);
+    max_index = std::max(max_index, chunk->max_index);
+    face_count += chunk->face_count;
+    tex_coord_corners.max_index = std::max(
+        tex_coord_corners.max_index, chunk->tex_coord_corners.max_index);
+    normal_corners.max_index =
+        std::max(normal_corners.max_index, chunk->normal_corners.max_index);
+  }
+
+  // Indices are checked and resolved over the whole vertex list
+  int64_t vertices_size = mesh.vertices.size() / 3;
+  if (max_index > vertices_size) {
+    throw std::runtime_error("Corupted format of OBJ file");
+  }
+
+  for (const std::pair<size_t, int64_t>& relative : relative_indices) {
+    int64_t el = vertices_size + relative.second;
+
+    if (el < 0) {
+      throw std::runtime_error("Corupted format of OBJ file");
+    }
+
+    mesh.polygons[relative.first] = el;
+  }
+
+  size_t corners_count = mesh.polygons.size() / 2;
+  ResolveCornerIndices(mesh.tex_coords.size() / 2, corners_count,
+                       mesh.tex_coord_indices, tex_coord_corners);
+  ResolveCornerIndices(mesh.normals.size() / 3, corners_count,
+                       mesh.normal_indices, normal_corners);
+
+  if (face_count != 0) {
+    mesh.edges_count = vertices_size + face_count - 2;
+  }
+
+  if (!mesh.groups.empty()) {
+    MeshGroup& last_group = mesh.groups.back();
+    last_group.indices_count = mesh.polygons.size() - last_group.first_index;
+  }
+
+  mesh_out = std::move(mesh);
+  // Chunks of older versions of file are released
+  this->chunks_.swap(chunks);
+
+  return true;
+}
+
+const char* ChunkedObjParser::FindChunkEnd(const char* begin_p,
+                                           const char* end_p) {
+  const std::array<uint64_t, 256>& gear = GearTable();
+  const char* limit_p =
+      begin_p + std::min<size_t>(end_p - begin_p, kMaxChunkSize);
+  const char* chunk_p = begin_p + std::min<size_t>(end_p - begin_p,
+                                                   kMinChunkSize);
+  uint64_t hash = 0;
+
+  for (; chunk_p < limit_p; ++chunk_p) {
+    hash = (hash << 1) + gear[static_cast<unsigned char>(*chunk_p)];
+
+    if ((hash & kBoundaryMask) == 0) {
+      break;
+    }
+  }
+
+  // Chunk holds whole lines only
+  const char* line_end = static_cast<const char*>(
+      std::memchr(chunk_p, '\n', end_p - chunk_p));
+
+  return line_end ? line_end + 1 : end_p;
+}
+
+uint64_t ChunkedObjParser::HashChunk(const char* begin_p, const char* end_p) {
+  // FNV-1a with the size of chunk mixed in
+  uint64_t hash = 0xCBF29CE484222325;
+
+  for (const char* char_p = begin_p; char_p != end_p; ++char_p) {
+    hash = (hash ^ static_cast<unsigned char>(*char_p)) * 0x100000001B3;
+  }
+
+  return hash ^ (uint64_t(end_p - begin_p) * 0x9E3779B97F4A7C15);
+}
+
+uint64_t ChunkedObjParser::CheckChunk(const char* begin_p,
+                                      const char* end_p) {
+  // Multiply and xorshift of 8 byte words, independent from FNV-1a
+  uint64_t hash = uint64_t(end_p - begin_p);
+  const char* char_p = begin_p;
+
+  for (; end_p - char_p >= 8; char_p += 8) {
+    uint64_t word;
+    std::memcpy(&word, char_p, sizeof(word));
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCD;
+    hash ^= hash >> 32;
+  }
+
+  for (; char_p != end_p; ++char_p) {
+    hash = (hash ^ static_cast<unsigned char>(*char_p)) * 0xC4CEB9FE1A85EC53;
+    hash ^= hash >> 29;
+  }
+
+  return hash;
+}
+
+void ChunkedObjParser::ParseChunk(const char* begin_p, const char* end_p,
+                                  ParsedChunk& chunk_out) {
+  SpillBuffer<vertexType> vertices;
+  SpillBuffer<polygonType> polygons;
+  this->relative_indices_.clear();
+  this->max_index_ = 0;
+  this->tex_coord_corners_ = CornerIndices();
+  this->normal_corners_ = CornerIndices();
+
+  std::string line;
+  for (const char* line_p = begin_p; line_p != end_p;) {
+    const char* line_end = static_cast<const char*>(
+        std::memchr(line_p, '\n', end_p - line_p));
+    if (!line_end) {
+      line_end = end_p;
+    }
+
+    line.assign(line_p, line_end);
+    if (this->ParseStatement(line, vertices, polygons, 0, chunk_out.mesh)) {
+      ++chunk_out.face_count;
+    }
+
+    line_p = (line_end == end_p) ? end_p : line_end + 1;
+  }
+
+  vertices.MoveTo(chunk_out.mesh.vertices);
+  polygons.MoveTo(chunk_out.mesh.polygons);
+  chunk_out.relative_indices.swap(this->relative_indices_);
+  chunk_out.max_index = this->max_index_;
+
+  // Indices of corners are padded, so chunks are joined by corners
+  MeshData& mesh = chunk_out.mesh;
+  size_t corners_count = mesh.polygons.size() / 2;
+  for (std::vector<polygonType>* indices :
+       {&mesh.tex_coord_indices, &mesh.normal_indices}) {
+    if (!indices->empty()) {
+      indices->resize(corners_count, MeshData::kNoIndex);
+    }
+  }
+  chunk_out.tex_coord_corners = std::move(this->tex_coord_corners_);
+  chunk_out.normal_corners = std::move(this->normal_corners_);
+}
+
+void ChunkedObjParser::AppendCornerIndices(
+    const std::vector<polygonType>& indices, const CornerIndices& corners,
+    size_t first_corner, size_t count, std::vector<polygonType>& indices_out) {
+  if (indices.empty()) {
+    return;
+  }
+
+  indices_out.resize(first_corner, MeshData::kNoIndex);
+  indices_out.insert(indices_out.end(), indices.begin(), indices.end());
+
+  // Negative indices before the chunk beginning refer to previous chunks
+  for (const std::pair<size_t, int64_t>& relative : corners.relative) {
+    int64_t el = int64_t(count) + relative.second;
+    if (el >= 0) {
+      indices_out[first_corner + relative.first] = el;
+    }
+  }
+}
+
+void ChunkedObjParser::AppendChunk(
+    const ParsedChunk& chunk, MeshData& mesh_out,
+    std::vector<std::pair<size_t, int64_t>>& relative_out) {
+  const MeshData& mesh = chunk.mesh;
+  size_t first_polygon = mesh_out.polygons.size();
+
+  AppendCornerIndices(mesh.tex_coord_indices, chunk.tex_coord_corners,
+                      first_polygon / 2, mesh_out.tex_coords.size() / 2,
+                      mesh_out.tex_coord_indices);
+  AppendCornerIndices(mesh.normal_indices, chunk.normal_corners,
+                      first_polygon / 2, mesh_out.normals.size() / 3,
+                      mesh_out.normal_indices);
+
+  mesh_out.vertices.insert(mesh_out.vertices.end(), mesh.vertices.begin(),
+                           mesh.vertices.end());
+  mesh_out.polygons.insert(mesh_out.polygons.end(), mesh.polygons.begin(),
+                           mesh.polygons.end());
+  mesh_out.tex_coords.insert(mesh_out.tex_coords.end(),
+                             mesh.tex_coords.begin(), mesh.tex_coords.end());
+  mesh_out.normals.insert(mesh_out.normals.end(), mesh.normals.begin(),
+                          mesh.normals.end());
+
+  for (const std::pair<size_t, int64_t>& relative : chunk.relative_indices) {
+    relative_out.emplace_back(first_polygon + relative.first,
+                              relative.second);
+  }
+
+  // Names which are not set in the chunk continue from the previous chunks
+  std::string name, material;
+  if (!mesh_out.groups.empty()) {
+    name = mesh_out.groups.back().name;
+    material = mesh_out.groups.back().material;
+  }
+
+  for (MeshGroup group : mesh.groups) {
+    group.first_index += first_polygon;
+    if (group.name.empty()) {
+      group.name = name;
+    }
+    if (group.material.empty()) {
+      group.material = material;
+    }
+
+    std::vector<MeshGroup>& groups = mesh_out.groups;
+    if (!groups.empty() && groups.back().first_index == group.first_index) {
+      groups.back() = group;
+
+    } else {
+      if (!groups.empty()) {
+        groups.back().indices_count =
+            group.first_index - groups.back().first_index;
+      }
+
+      groups.push_back(group);
+    }
+  }
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,113 @@
+/** @file
+ * @brief Declaration of ChunkedObjParser class
+ */
+#ifndef SRC_MODEL_CHUNKED_OBJ_PARSER_H_
+#define SRC_MODEL_CHUNKED_OBJ_PARSER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "model/parser_obj.h"
+
+namespace ModelViewer3D {
+/** @brief Parser for repeated loads of the same changing obj file
+ * The file is split into content defined chunks of whole lines, parsed
+ * chunks are kept between loads, so only the changed parts of file are
+ * parsed again
+ */
+class ChunkedObjParser : public ParserListOBJ {
+ public:
+  /** @brief Parse the file, reuse chunks which are equal to chunks of the
+   * previous load
+   * @param[in] filename Path to file
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @return false if the file is not an uncompressed obj file
+   * @throw runtime_error
+   */
+  bool Reload(const std::string& filename, MeshData& mesh_out);
+
+  /** @brief Forget all chunks of the previous load */
+  void Clear() { this->chunks_.clear(); }
+
+  /** @brief Get the count of chunks reused by the last load */
+  size_t GetReusedCount() const { return this->reused_count_; }
+
+  /** @brief Get the count of chunks parsed by the last load */
+  size_t GetParsedCount() const { return this->parsed_count_; }
+
+  // Limits of chunk size, boundaries are moved to the end of line
+  static constexpr size_t kMinChunkSize = 1 << 13;
+  static constexpr size_t kMaxChunkSize = 1 << 17;
+  // Average distance between boundaries is about 32 KB
+  static constexpr uint64_t kBoundaryMask = (uint64_t(1) << 15) - 1;
+
+ private:
+  /** @brief Parsed chunk with indices which are independent from other
+   * chunks
+   */
+  struct ParsedChunk {
+    MeshData mesh;
+    std::vector<std::pair<size_t, int64_t>> relative_indices;
+    int64_t max_index = 0;
+    size_t face_count = 0;
+    // Negative indices of corners count back from the chunk beginning
+    CornerIndices tex_coord_corners;
+    CornerIndices normal_corners;
+    // Size and the second hash of the text verify the key before reuse
+    size_t size = 0;
+    uint64_t check = 0;
+  };
+
+  /** @brief SubMethod for find the end of the chunk by the rolling hash
+   * @param[in] begin_p Beginning of the chunk
+   * @param[in] end_p End of the file
+   * @return End of the chunk after line feed
+   */
+  static const char* FindChunkEnd(const char* begin_p, const char* end_p);
+
+  /** @brief Get the hash of the chunk content */
+  static uint64_t HashChunk(const char* begin_p, const char* end_p);
+
+  /** @brief Get the second hash of the chunk content, which is compared
+   * before the chunk of the same key is reused
+   */
+  static uint64_t CheckChunk(const char* begin_p, const char* end_p);
+
+  /** @brief SubMethod for parse lines of the chunk
+   * @throw runtime_error
+   */
+  void ParseChunk(const char* begin_p, const char* end_p,
+                  ParsedChunk& chunk_out);
+
+  /** @brief SubMethod for append the chunk to the model
+   * @param[in] chunk Parsed chunk
+   * @param[out] mesh_out Structure for store the model
+   * @param[out] relative_out Positions and values of negative indices
+   */
+  static void AppendChunk(
+      const ParsedChunk& chunk, MeshData& mesh_out,
+      std::vector<std::pair<size_t, int64_t>>& relative_out);
+
+  /** @brief SubMethod for append indices of texture coordinates or normals
+   * of corners of the chunk
+   * @param[in] indices Indices of the chunk per corner
+   * @param[in] corners Negative indices of the chunk
+   * @param first_corner Count of corners before the chunk
+   * @param count Count of the attribute before the chunk
+   * @param[out] indices_out Indices of the model per corner
+   */
+  static void AppendCornerIndices(const std::vector<polygonType>& indices,
+                                  const CornerIndices& corners,
+                                  size_t first_corner, size_t count,
+                                  std::vector<polygonType>& indices_out);
+
+  std::unordered_map<uint64_t, std::shared_ptr<const ParsedChunk>> chunks_;
+  size_t reused_count_ = 0;
+  size_t parsed_count_ = 0;
+};  // ChunkedObjParser
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_CHUNKED_OBJ_PARSER_H_
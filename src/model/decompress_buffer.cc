@@ -0,0 +1,254 @@
+/** @file
+ * @brief Definition of DecompressBuffer class
+ */
+#include "model/decompress_buffer.h"
+
+#include <zlib.h>
+
+#include <stdexcept>
+#ifdef MODEL_VIEWER_ZSTD
+#include <zstd.h>
+#endif  // MODEL_VIEWER_ZSTD
+
+namespace ModelViewer3D {
+// Size of compressed data read at once
+static constexpr size_t kInputSize = 1 << 18;
+
+DecompressBuffer::DecompressBuffer(std::ifstream& file, Codec codec)
+    : file_(file), codec_(codec) {
+#ifndef MODEL_VIEWER_ZSTD
+  if (codec == kZstd) {
+    throw std::runtime_error("Zstandard compression is not supported");
+  }
+#endif  // MODEL_VIEWER_ZSTD
+  this->Start();
+}
+
+DecompressBuffer::~DecompressBuffer() { this->Stop(); }
+
+void DecompressBuffer::Restart() {
+  this->Stop();
+  this->Start();
+}
+
+bool DecompressBuffer::Detect(const std::string& header, Codec& codec_out) {
+  bool is_compressed = false;
+
+  if (header.compare(0, 2, "\x1f\x8b") == 0) {
+    codec_out = kGzip;
+    is_compressed = true;
+  } else if (header.compare(0, 4, "\x28\xb5\x2f\xfd") == 0) {
+    codec_out = kZstd;
+    is_compressed = true;
+  }
+
+  return is_compressed;
+}
+
+DecompressBuffer::int_type DecompressBuffer::underflow() {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+
+  if (!this->current_.empty()) {
+    this->free_.push_back(std::move(this->current_));
+    this->current_.clear();
+    this->free_cond_.notify_one();
+  }
+
+  this->ready_cond_.wait(
+      lock, [this] { return !this->ready_.empty() || this->is_finished_; });
+
+  if (this->ready_.empty()) {
+    this->setg(nullptr, nullptr, nullptr);
+    if (!this->error_.empty()) {
+      throw std::runtime_error(this->error_);
+    }
+    return traits_type::eof();
+  }
+
+  this->current_ = std::move(this->ready_.front());
+  this->ready_.pop_front();
+
+  char* begin = this->current_.data();
+  this->setg(begin, begin, begin + this->current_.size());
+  return traits_type::to_int_type(*begin);
+}
+
+void DecompressBuffer::Produce() {
+  std::string error;
+
+  try {
+    if (this->codec_ == kGzip) {
+      this->ProduceGzip();
+    } else {
+      this->ProduceZstd();
+    }
+  } catch (std::exception& exc) {
+    error = exc.what();
+  }
+
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->error_ = error;
+  this->is_finished_ = true;
+  this->ready_cond_.notify_one();
+}
+
+void DecompressBuffer::ProduceGzip() {
+  z_stream stream = {};
+
+  // Automatic detection of gzip and zlib headers
+  if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+    throw std::runtime_error("Could not start decompression");
+  }
+
+  std::vector<char> input(kInputSize);
+  std::vector<char> block;
+  int status = Z_OK;
+  bool is_ok = true;
+
+  while (is_ok && this->TakeFreeBlock(block)) {
+    stream.next_out = reinterpret_cast<Bytef*>(block.data());
+    stream.avail_out = block.size();
+
+    while (is_ok && stream.avail_out != 0) {
+      if (stream.avail_in == 0) {
+        stream.avail_in = this->ReadInput(input);
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        if (stream.avail_in == 0) {
+          // Unexpected end of file inside of compressed stream
+          is_ok = status == Z_STREAM_END;
+          break;
+        }
+      }
+
+      if (status == Z_STREAM_END) {
+        // Concatenated gzip members
+        inflateReset(&stream);
+      }
+
+      status = inflate(&stream, Z_NO_FLUSH);
+      is_ok = status == Z_OK || status == Z_STREAM_END;
+    }
+
+    size_t size = block.size() - stream.avail_out;
+    if (!is_ok || size == 0) {
+      break;
+    }
+    this->PushBlock(block, size);
+  }
+
+  inflateEnd(&stream);
+
+  if (!is_ok) {
+    throw std::runtime_error("Corupted compressed file");
+  }
+}
+
+void DecompressBuffer::ProduceZstd() {
+#ifdef MODEL_VIEWER_ZSTD
+  ZSTD_DCtx* context = ZSTD_createDCtx();
+  if (!context) {
+    throw std::runtime_error("Could not start decompression");
+  }
+
+  std::vector<char> input(kInputSize);
+  std::vector<char> block;
+  ZSTD_inBuffer in_buffer = {input.data(), 0, 0};
+  size_t status = 0;
+  bool is_ok = true;
+
+  while (is_ok && this->TakeFreeBlock(block)) {
+    ZSTD_outBuffer out_buffer = {block.data(), block.size(), 0};
+
+    while (is_ok && out_buffer.pos != out_buffer.size) {
+      if (in_buffer.pos == in_buffer.size) {
+        in_buffer.size = this->ReadInput(input);
+        in_buffer.pos = 0;
+        if (in_buffer.size == 0) {
+          // Zero status means the last frame is complete
+          is_ok = status == 0;
+          break;
+        }
+      }
+
+      status = ZSTD_decompressStream(context, &out_buffer, &in_buffer);
+      is_ok = !ZSTD_isError(status);
+    }
+
+    if (!is_ok || out_buffer.pos == 0) {
+      break;
+    }
+    this->PushBlock(block, out_buffer.pos);
+  }
+
+  ZSTD_freeDCtx(context);
+
+  if (!is_ok) {
+    throw std::runtime_error("Corupted compressed file");
+  }
+#endif  // MODEL_VIEWER_ZSTD
+}
+
+bool DecompressBuffer::TakeFreeBlock(std::vector<char>& block_out) {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->free_cond_.wait(
+      lock, [this] { return !this->free_.empty() || this->is_stopped_; });
+
+  if (!this->is_stopped_) {
+    block_out = std::move(this->free_.back());
+    this->free_.pop_back();
+    // Capacity of block is kept, so resize does not allocate
+    block_out.resize(kBlockSize);
+  }
+
+  return !this->is_stopped_;
+}
+
+void DecompressBuffer::PushBlock(std::vector<char>& block, size_t size) {
+  block.resize(size);
+
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->ready_.push_back(std::move(block));
+  block.clear();
+  this->ready_cond_.notify_one();
+}
+
+size_t DecompressBuffer::ReadInput(std::vector<char>& input) {
+  this->file_.read(input.data(), input.size());
+
+  if (this->file_.bad()) {
+    throw std::runtime_error("Could not read file");
+  }
+
+  return this->file_.gcount();
+}
+
+void DecompressBuffer::Start() {
+  this->file_.clear();
+  this->file_.seekg(0, std::ios::beg);
+
+  this->ready_.clear();
+  this->free_.resize(kBlocksCount);
+  for (std::vector<char>& block : this->free_) {
+    block.reserve(kBlockSize);
+  }
+  this->current_.clear();
+  this->setg(nullptr, nullptr, nullptr);
+
+  this->error_.clear();
+  this->is_finished_ = false;
+  this->is_stopped_ = false;
+  this->thread_ = std::thread(&DecompressBuffer::Produce, this);
+}
+
+void DecompressBuffer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->is_stopped_ = true;
+    this->free_cond_.notify_one();
+  }
+
+  if (this->thread_.joinable()) {
+    this->thread_.join();
+  }
+}
+}  // namespace ModelViewer3D
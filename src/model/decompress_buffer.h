@@ -0,0 +1,99 @@
+/** @file
+ * @brief Declaration of DecompressBuffer class
+ */
+#ifndef SRC_MODEL_DECOMPRESS_BUFFER_H_
+#define SRC_MODEL_DECOMPRESS_BUFFER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Stream buffer, which decompresses gzip or zstd file on own thread
+ * Decompressed data is passed to the reader by blocks of fixed size through
+ * a bounded queue, so the whole decompressed file is never kept in memory
+ * and decompression overlaps parsing
+ */
+class DecompressBuffer : public std::streambuf {
+ public:
+  /** @brief Supported compression formats */
+  enum Codec { kGzip, kZstd };
+
+  /** @brief Start decompression of file from its beginning
+   * @param[in] file Opened compressed file, it must outlive the buffer and
+   * must not be used by other code while the buffer exists
+   * @param codec Compression format of file
+   * @throw runtime_error
+   */
+  DecompressBuffer(std::ifstream& file, Codec codec);
+
+  DecompressBuffer(const DecompressBuffer&) = delete;
+  DecompressBuffer& operator=(const DecompressBuffer&) = delete;
+
+  /** @brief Stop decompression thread */
+  ~DecompressBuffer() override;
+
+  /** @brief Restart decompression from the beginning of file */
+  void Restart();
+
+  /** @brief Recognize compression format by magic bytes
+   * @param[in] header First bytes of file
+   * @param[out] codec_out Compression format
+   * @return true if the file is compressed
+   */
+  static bool Detect(const std::string& header, Codec& codec_out);
+
+  // Size of decompressed block and count of blocks in flight
+  static constexpr size_t kBlockSize = 1 << 20;
+  static constexpr size_t kBlocksCount = 4;
+
+ protected:
+  /** @brief Switch the get area to the next decompressed block
+   * @throw runtime_error if decompression is failed
+   */
+  int_type underflow() override;
+
+ private:
+  /** @brief Body of the decompression thread */
+  void Produce();
+
+  /** @brief SubMethod for decompress gzip or zlib stream */
+  void ProduceGzip();
+
+  /** @brief SubMethod for decompress zstd stream */
+  void ProduceZstd();
+
+  /** @brief Wait for a free block, false if decompression is stopped */
+  bool TakeFreeBlock(std::vector<char>& block_out);
+
+  /** @brief Pass the filled block to the reader */
+  void PushBlock(std::vector<char>& block, size_t size);
+
+  /** @brief Read the next part of compressed file
+   * @return Count of read bytes, zero at the end of file
+   */
+  size_t ReadInput(std::vector<char>& input);
+
+  void Start();
+  void Stop();
+
+  std::ifstream& file_;
+  Codec codec_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable ready_cond_;
+  std::condition_variable free_cond_;
+  std::deque<std::vector<char>> ready_;
+  std::vector<std::vector<char>> free_;
+  std::vector<char> current_;
+  std::string error_;
+  bool is_finished_ = false;
+  bool is_stopped_ = false;
+};  // DecompressBuffer
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_DECOMPRESS_BUFFER_H_
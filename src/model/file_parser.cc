@@ -5,11 +5,24 @@
 
 #include <stdexcept>
 
+#include "model/parser_gltf.h"
 #include "model/parser_obj.h"
+#include "model/parser_ply.h"
+#include "model/parser_stl.h"
 
 namespace ModelViewer3D {
 
-FileParser::FileParser() { this->lst_ = new ParserListOBJ(); }
+FileParser::FileParser() {
+  ParserList* ply = new ParserListPLY();
+  ply->SetNext(new ParserListGLTF());
+
+  ParserList* stl = new ParserListSTL();
+  stl->SetNext(ply);
+
+  this->lst_ = new ParserListOBJ();
+  this->lst_->SetNext(stl);
+  this->lst_->SetArena(&this->arena_);
+}
 
 FileParser::~FileParser() { delete this->lst_; }
 
@@ -17,11 +30,39 @@ void FileParser::ParseFile(std::string filename,
                            std::vector<vertexType>& vertices_out,
                            std::vector<polygonType>& polygons_out,
                            uint64_t& edges_count_out) {
+  MeshData mesh;
+  mesh.vertices.swap(vertices_out);
+  mesh.polygons.swap(polygons_out);
+  mesh.edges_count = edges_count_out;
+
+  this->ParseFile(filename, mesh);
+
+  vertices_out.swap(mesh.vertices);
+  polygons_out.swap(mesh.polygons);
+  edges_count_out = mesh.edges_count;
+}
+
+void FileParser::ParseFile(std::string filename, MeshData& mesh_out) {
   if (this->lst_) {
-    this->lst_->Parse(filename, vertices_out, polygons_out, edges_count_out);
+    FileProbe probe(filename);
+
+    try {
+      this->lst_->Parse(probe, mesh_out);
+    } catch (...) {
+      this->arena_.Release();
+      throw;
+    }
+
+    this->arena_.Release();
 
   } else {
     throw std::runtime_error("No parsers for call");
   }
 }
+
+void FileParser::SetMemoryBudget(size_t memory_budget) {
+  if (this->lst_) {
+    this->lst_->SetMemoryBudget(memory_budget);
+  }
+}
 }  // namespace ModelViewer3D
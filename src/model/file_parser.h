@@ -7,11 +7,15 @@
 #include <string>
 #include <vector>
 
+#include "model/arena.h"
 #include "model/model_types.h"
 #include "model/parser_list.h"
 
 namespace ModelViewer3D {
-/** @brief Incaplulate a chain for parsing files with 3d model */
+/** @brief Incaplulate a chain for parsing files with 3d model
+ * Parsers of the chain take scratch memory from the arena, which is released
+ * at once after each file
+ */
 class FileParser {
  public:
   FileParser();
@@ -26,8 +30,25 @@ class FileParser {
                  std::vector<polygonType>& polygons_out,
                  uint64_t& edges_count_out);
 
+  /** @brief Call a chain of parsers
+   * @param[in] filename Path to file
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  void ParseFile(std::string filename, MeshData& mesh_out);
+
+  /** @brief Get the arena of parsers scratch memory */
+  const Arena& GetArena() const { return this->arena_; }
+
+  /** @brief Set the memory budget of parsers
+   * @param memory_budget Size in bytes, after which the parser buffers are
+   * moved to temporary files, zero for unlimited
+   */
+  void SetMemoryBudget(size_t memory_budget);
+
  private:
   ParserList* lst_;
+  Arena arena_;
 };  // FileParser
 }  // namespace ModelViewer3D
 #endif  // SRC_MODEL_FILE_PARSER_H_
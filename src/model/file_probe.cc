@@ -0,0 +1,57 @@
+/** @file
+ * @brief Definition of FileProbe class
+ */
+#include "model/file_probe.h"
+
+#include <stdexcept>
+
+namespace ModelViewer3D {
+FileProbe::FileProbe(const std::string& filename)
+    : filename_(filename), file_(filename, std::ios::binary) {
+  if (this->file_.fail()) {
+    throw std::runtime_error("Could not open file");
+  }
+
+  this->file_.seekg(0, std::ios::end);
+  std::streamoff file_size = this->file_.tellg();
+  this->file_.seekg(0, std::ios::beg);
+
+  if (file_size < 0) {
+    throw std::runtime_error("Could not open file");
+  }
+  this->file_size_ = file_size;
+
+  this->header_.resize(this->file_size_ < kProbeSize ? this->file_size_
+                                                     : kProbeSize);
+  this->file_.read(this->header_.data(), this->header_.size());
+  this->header_.resize(this->file_.gcount());
+  this->is_whole_file_ = this->header_.size() == this->file_size_;
+
+  DecompressBuffer::Codec codec;
+  if (DecompressBuffer::Detect(this->header_, codec)) {
+    this->decompress_buffer_ =
+        std::make_unique<DecompressBuffer>(this->file_, codec);
+    this->decompressed_ =
+        std::make_unique<std::istream>(this->decompress_buffer_.get());
+    // Errors of decompression are thrown from reads
+    this->decompressed_->exceptions(std::ios::badbit);
+
+    this->header_.resize(kProbeSize);
+    this->decompressed_->read(this->header_.data(), kProbeSize);
+    this->header_.resize(this->decompressed_->gcount());
+    this->is_whole_file_ = this->header_.size() < kProbeSize;
+  }
+}
+
+std::istream& FileProbe::Rewind() {
+  if (this->decompress_buffer_) {
+    this->decompress_buffer_->Restart();
+    this->decompressed_->clear();
+    return *this->decompressed_;
+  }
+
+  this->file_.clear();
+  this->file_.seekg(0, std::ios::beg);
+  return this->file_;
+}
+}  // namespace ModelViewer3D
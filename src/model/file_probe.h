@@ -0,0 +1,67 @@
+/** @file
+ * @brief Declaration of FileProbe class
+ */
+#ifndef SRC_MODEL_FILE_PROBE_H_
+#define SRC_MODEL_FILE_PROBE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <string>
+
+#include "model/decompress_buffer.h"
+
+namespace ModelViewer3D {
+/** @brief Opens the file once and reads its beginning, so parsers of the
+ * chain can recognize the format by content without own file access
+ * Gzip and zstd files are decompressed transparently, the header and the
+ * stream contain decompressed data
+ */
+class FileProbe {
+ public:
+  /** @brief Open the file and read the header
+   * @param[in] filename Path to file
+   * @throw runtime_error
+   */
+  explicit FileProbe(const std::string& filename);
+
+  FileProbe(const FileProbe&) = delete;
+  FileProbe& operator=(const FileProbe&) = delete;
+
+  /** @brief Get the path to file */
+  const std::string& GetFilename() const { return this->filename_; }
+
+  /** @brief Get the first bytes of the file, all file if it is small */
+  const std::string& GetHeader() const { return this->header_; }
+
+  /** @brief Get the size of file on disk in bytes */
+  uint64_t GetFileSize() const { return this->file_size_; }
+
+  /** @brief Check the header contains the whole file */
+  bool IsWholeFile() const { return this->is_whole_file_; }
+
+  /** @brief Check the file is compressed, its stream is not seekable and
+   * its decompressed size is unknown
+   */
+  bool IsCompressed() const { return this->decompress_buffer_ != nullptr; }
+
+  /** @brief Get the opened file positioned at the beginning
+   * @throw runtime_error on read of corrupted compressed file
+   */
+  std::istream& Rewind();
+
+  // Size of the header
+  static constexpr size_t kProbeSize = 4096;
+
+ private:
+  std::string filename_;
+  std::ifstream file_;
+  std::string header_;
+  uint64_t file_size_ = 0;
+  bool is_whole_file_ = false;
+  std::unique_ptr<DecompressBuffer> decompress_buffer_;
+  std::unique_ptr<std::istream> decompressed_;
+};  // FileProbe
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_FILE_PROBE_H_
@@ -0,0 +1,371 @@
+/** @file
+ * @brief Definition of FileWriter class
+ */
+#include "model/file_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace ModelViewer3D {
+// Upper bounds of the formatted size, shortest float is up to 15 chars
+static constexpr size_t kObjVertexSize = 64;
+static constexpr size_t kStlTriangleSize = 50;
+
+char* FileWriter::Chunk::Reserve(size_t extra) {
+  if (this->size + extra > this->data.size()) {
+    this->data.resize(std::max(this->data.size() * 2, this->size + extra));
+  }
+
+  return this->data.data() + this->size;
+}
+
+FileWriter::Format FileWriter::GetFormat(const std::string& filename) {
+  std::string extension = std::filesystem::path(filename).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char symbol) { return std::tolower(symbol); });
+
+  if (extension == ".obj") {
+    return kObjFormat;
+  } else if (extension == ".stl") {
+    return kStlFormat;
+  } else if (extension == ".ply") {
+    return kPlyFormat;
+  }
+
+  throw std::runtime_error("Unsupported export format");
+}
+
+void FileWriter::WriteFile(const std::string& filename, const MeshData& mesh) {
+  this->WriteFile(filename, mesh, GetFormat(filename));
+}
+
+void FileWriter::WriteFile(const std::string& filename, const MeshData& mesh,
+                           Format format) {
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open file");
+  }
+
+  switch (format) {
+    case kObjFormat:
+      this->WriteObj(file, mesh);
+      break;
+    case kStlFormat:
+      this->WriteStl(file, mesh);
+      break;
+    case kPlyFormat:
+      this->WritePly(file, mesh);
+      break;
+  }
+
+  file.flush();
+  if (!file) {
+    throw std::runtime_error("Could not write file");
+  }
+}
+
+size_t FileWriter::FindFaceEnd(const std::vector<polygonType>& polygons,
+                               size_t begin) {
+  polygonType first = polygons[begin];
+
+  for (size_t i = begin; i + 1 < polygons.size(); i += 2) {
+    if (polygons[i + 1] == first) {
+      return i + 2;
+    }
+  }
+
+  return polygons.size();
+}
+
+FileWriter::FaceBlocks FileWriter::SplitFaces(
+    const std::vector<polygonType>& polygons) {
+  FaceBlocks blocks;
+  blocks.bounds.push_back(0);
+
+  // The walk only compares indices, formatting of blocks is the slow part
+  for (size_t face = 0; face < polygons.size();) {
+    size_t face_end = FindFaceEnd(polygons, face);
+    size_t face_size = (face_end - face) / 2;
+
+    if (face_size != 0) {
+      ++blocks.faces_count;
+      blocks.triangles_count += face_size >= 3 ? face_size - 2 : 0;
+      blocks.ply_faces_count += face_size <= 255 ? 1 : face_size - 2;
+    }
+
+    face = face_end;
+    if (face - blocks.bounds.back() >= kBlockSize) {
+      blocks.bounds.push_back(face);
+    }
+  }
+
+  if (blocks.bounds.back() != polygons.size()) {
+    blocks.bounds.push_back(polygons.size());
+  }
+
+  return blocks;
+}
+
+void FileWriter::WriteBlocks(std::ofstream& file, size_t blocks_count,
+                             const FormatTask& task) {
+  // Batch of blocks is formatted in parallel and then written in order
+  size_t batch_size = this->pool_->GetThreadsCount() * 2;
+  std::vector<Chunk> chunks(std::min(batch_size, blocks_count));
+
+  for (size_t first = 0; first < blocks_count; first += batch_size) {
+    size_t count = std::min(batch_size, blocks_count - first);
+
+    this->pool_->ParallelFor(count, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        chunks[i].size = 0;
+        task(first + i, chunks[i]);
+      }
+    });
+
+    for (size_t i = 0; i < count && file; ++i) {
+      file.write(chunks[i].data.data(), chunks[i].size);
+    }
+  }
+}
+
+void FileWriter::WriteObj(std::ofstream& file, const MeshData& mesh) {
+  const std::vector<vertexType>& vertices = mesh.vertices;
+  const std::vector<polygonType>& polygons = mesh.polygons;
+  const std::vector<MeshGroup>& groups = mesh.groups;
+  size_t vertices_count = vertices.size() / 3;
+  size_t vertex_blocks = (vertices_count + kBlockSize - 1) / kBlockSize;
+  FaceBlocks faces = SplitFaces(polygons);
+
+  auto format_vertices = [&](size_t block, Chunk& chunk_out) {
+    size_t begin = block * kBlockSize;
+    size_t end = std::min(vertices_count, begin + kBlockSize);
+    char* begin_p = chunk_out.Reserve((end - begin) * kObjVertexSize);
+    char* char_p = begin_p;
+
+    for (size_t i = begin; i < end; ++i) {
+      *char_p++ = 'v';
+      for (size_t j = 0; j < 3; ++j) {
+        *char_p++ = ' ';
+        char_p = std::to_chars(char_p, char_p + 16, vertices[i * 3 + j]).ptr;
+      }
+      *char_p++ = '\n';
+    }
+
+    chunk_out.size += char_p - begin_p;
+  };
+
+  auto format_group = [&](size_t group, Chunk& chunk_out) {
+    const MeshGroup& current = groups[group];
+    bool is_new_material =
+        !current.material.empty() &&
+        (group == 0 || groups[group - 1].material != current.material);
+    char* begin_p =
+        chunk_out.Reserve(current.name.size() + current.material.size() + 16);
+    char* char_p = begin_p;
+
+    if (!current.name.empty()) {
+      char_p = std::copy_n("g ", 2, char_p);
+      char_p = std::copy(current.name.begin(), current.name.end(), char_p);
+      *char_p++ = '\n';
+    }
+
+    if (is_new_material) {
+      char_p = std::copy_n("usemtl ", 7, char_p);
+      char_p =
+          std::copy(current.material.begin(), current.material.end(), char_p);
+      *char_p++ = '\n';
+    }
+
+    chunk_out.size += char_p - begin_p;
+  };
+
+  auto format_faces = [&](size_t block, Chunk& chunk_out) {
+    size_t begin = faces.bounds[block];
+    size_t end = faces.bounds[block + 1];
+    // Groups begin at faces, the ones in this block are written before them
+    size_t group = std::lower_bound(groups.begin(), groups.end(), begin,
+                                    [](const MeshGroup& lhs, size_t index) {
+                                      return lhs.first_index < index;
+                                    }) -
+                   groups.begin();
+
+    for (size_t face = begin; face < end;) {
+      while (group < groups.size() && groups[group].first_index <= face) {
+        format_group(group++, chunk_out);
+      }
+
+      size_t face_end = FindFaceEnd(polygons, face);
+      // Space, up to ten digits of index and the line feed
+      char* begin_p = chunk_out.Reserve((face_end - face) / 2 * 11 + 2);
+      char* char_p = begin_p;
+
+      *char_p++ = 'f';
+      for (size_t i = face; i + 1 < face_end; i += 2) {
+        *char_p++ = ' ';
+        char_p =
+            std::to_chars(char_p, char_p + 10, uint64_t(polygons[i]) + 1).ptr;
+      }
+      *char_p++ = '\n';
+
+      chunk_out.size += face_end - face >= 2 ? char_p - begin_p : 0;
+      face = face_end;
+    }
+  };
+
+  this->WriteBlocks(file, vertex_blocks + faces.bounds.size() - 1,
+                    [&](size_t block, Chunk& chunk_out) {
+                      if (block < vertex_blocks) {
+                        format_vertices(block, chunk_out);
+                      } else {
+                        format_faces(block - vertex_blocks, chunk_out);
+                      }
+                    });
+}
+
+void FileWriter::WriteStl(std::ofstream& file, const MeshData& mesh) {
+  const std::vector<vertexType>& vertices = mesh.vertices;
+  const std::vector<polygonType>& polygons = mesh.polygons;
+  FaceBlocks faces = SplitFaces(polygons);
+
+  if (faces.triangles_count > UINT32_MAX) {
+    throw std::runtime_error("Model is too large for STL file");
+  }
+
+  char header[84] = "3D Viewer binary STL";
+  uint32_t triangles_count = faces.triangles_count;
+  std::memcpy(header + 80, &triangles_count, sizeof(triangles_count));
+  file.write(header, sizeof(header));
+
+  // Polygons are split into fans of triangles with flat normals
+  auto write_triangle = [&](polygonType a, polygonType b, polygonType c,
+                            char* record_p) {
+    const vertexType* points[3] = {&vertices[size_t(a) * 3],
+                                   &vertices[size_t(b) * 3],
+                                   &vertices[size_t(c) * 3]};
+    vertexType u[3], v[3];
+    for (int i = 0; i < 3; ++i) {
+      u[i] = points[1][i] - points[0][i];
+      v[i] = points[2][i] - points[0][i];
+    }
+
+    vertexType normal[3] = {u[1] * v[2] - u[2] * v[1],
+                            u[2] * v[0] - u[0] * v[2],
+                            u[0] * v[1] - u[1] * v[0]};
+    vertexType length = std::sqrt(normal[0] * normal[0] +
+                                  normal[1] * normal[1] +
+                                  normal[2] * normal[2]);
+    for (int i = 0; i < 3 && length > 0; ++i) {
+      normal[i] /= length;
+    }
+
+    std::memcpy(record_p, normal, sizeof(normal));
+    for (int i = 0; i < 3; ++i) {
+      std::memcpy(record_p + 12 + i * 12, points[i], 3 * sizeof(vertexType));
+    }
+    std::memset(record_p + 48, 0, 2);
+  };
+
+  auto format_faces = [&](size_t block, Chunk& chunk_out) {
+    size_t begin = faces.bounds[block];
+    size_t end = faces.bounds[block + 1];
+    char* begin_p = chunk_out.Reserve((end - begin) / 2 * kStlTriangleSize);
+    char* record_p = begin_p;
+
+    for (size_t face = begin; face < end;) {
+      size_t face_end = FindFaceEnd(polygons, face);
+
+      for (size_t i = face + 2; i + 3 < face_end; i += 2) {
+        write_triangle(polygons[face], polygons[i], polygons[i + 2],
+                       record_p);
+        record_p += kStlTriangleSize;
+      }
+
+      face = face_end;
+    }
+
+    chunk_out.size += record_p - begin_p;
+  };
+
+  this->WriteBlocks(file, faces.bounds.size() - 1, format_faces);
+}
+
+void FileWriter::WritePly(std::ofstream& file, const MeshData& mesh) {
+  const std::vector<polygonType>& polygons = mesh.polygons;
+  FaceBlocks faces = SplitFaces(polygons);
+
+  std::string header =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "comment 3D Viewer export\n"
+      "element vertex " +
+      std::to_string(mesh.vertices.size() / 3) +
+      "\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "element face " +
+      std::to_string(faces.ply_faces_count) +
+      "\n"
+      "property list uchar int vertex_indices\n"
+      "end_header\n";
+  file.write(header.data(), header.size());
+
+  // Vertices are laid out in the file as in memory
+  file.write(reinterpret_cast<const char*>(mesh.vertices.data()),
+             mesh.vertices.size() * sizeof(vertexType));
+
+  auto write_face = [](const polygonType* indices, size_t size,
+                       char* record_p) {
+    *record_p++ = static_cast<char>(size);
+    for (size_t i = 0; i < size; ++i) {
+      int32_t index = static_cast<int32_t>(indices[i]);
+      std::memcpy(record_p, &index, sizeof(index));
+      record_p += sizeof(index);
+    }
+    return record_p;
+  };
+
+  auto format_faces = [&](size_t block, Chunk& chunk_out) {
+    size_t begin = faces.bounds[block];
+    size_t end = faces.bounds[block + 1];
+    // Fan of triangles takes at most 13 bytes per vertex of polygon
+    char* begin_p = chunk_out.Reserve((end - begin) / 2 * 13 + 16);
+    char* record_p = begin_p;
+    std::vector<polygonType> face_indices;
+
+    for (size_t face = begin; face < end;) {
+      size_t face_end = FindFaceEnd(polygons, face);
+      size_t face_size = (face_end - face) / 2;
+
+      face_indices.clear();
+      for (size_t i = face; i + 1 < face_end; i += 2) {
+        face_indices.push_back(polygons[i]);
+      }
+
+      if (face_size != 0 && face_size <= 255) {
+        record_p = write_face(face_indices.data(), face_size, record_p);
+
+      } else {
+        // Count of list is one byte, larger polygons are split
+        for (size_t i = 1; i + 1 < face_size; ++i) {
+          polygonType triangle[3] = {face_indices[0], face_indices[i],
+                                     face_indices[i + 1]};
+          record_p = write_face(triangle, 3, record_p);
+        }
+      }
+
+      face = face_end;
+    }
+
+    chunk_out.size += record_p - begin_p;
+  };
+
+  this->WriteBlocks(file, faces.bounds.size() - 1, format_faces);
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,101 @@
+/** @file
+ * @brief Declaration of FileWriter class
+ */
+#ifndef SRC_MODEL_FILE_WRITER_H_
+#define SRC_MODEL_FILE_WRITER_H_
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "model/mesh_data.h"
+#include "model/model_types.h"
+#include "model/thread_pool.h"
+
+namespace ModelViewer3D {
+/** @brief Writer of the model to obj, binary stl and binary ply files
+ * The file is formatted by blocks on all threads of the pool and written
+ * by large sequential writes
+ */
+class FileWriter {
+ public:
+  enum Format { kObjFormat, kStlFormat, kPlyFormat };
+
+  FileWriter() = default;
+
+  FileWriter(const FileWriter&) = delete;
+  FileWriter& operator=(const FileWriter&) = delete;
+
+  /** @brief Get the format by the extension of file
+   * @throw runtime_error if the extension is not supported
+   */
+  static Format GetFormat(const std::string& filename);
+
+  /** @brief Write the model to file in the format of its extension
+   * @param[in] filename Path to file
+   * @param[in] mesh Model, polygons are consecutive pairs of edge indices
+   * @throw runtime_error
+   */
+  void WriteFile(const std::string& filename, const MeshData& mesh);
+
+  /** @brief Write the model to file in the given format
+   * @throw runtime_error
+   */
+  void WriteFile(const std::string& filename, const MeshData& mesh,
+                 Format format);
+
+  /** @brief Set the pool for parallel formatting
+   * @param pool Pool of threads, by default the shared one
+   */
+  void SetThreadPool(ThreadPool* pool) { this->pool_ = pool; }
+
+  /** @brief Find the end of the polygon, which begins at the given index
+   * Edges of the polygon are pairs of indices, the last edge returns to the
+   * first vertex
+   * @param[in] polygons Pairs of edge indices
+   * @param begin Index of the first edge of the polygon
+   * @return Index after the last edge of the polygon
+   */
+  static size_t FindFaceEnd(const std::vector<polygonType>& polygons,
+                            size_t begin);
+
+  // Count of vertices or polygon indices in one formatted block
+  static constexpr size_t kBlockSize = 1 << 16;
+
+ private:
+  /** @brief Formatted content of one block */
+  struct Chunk {
+    std::vector<char> data;
+    size_t size = 0;
+
+    /** @brief Get the space for at least extra bytes after the content */
+    char* Reserve(size_t extra);
+  };
+
+  /** @brief Polygons split into blocks of whole faces */
+  struct FaceBlocks {
+    std::vector<size_t> bounds;
+    size_t faces_count = 0;
+    size_t triangles_count = 0;
+    // Faces of ply, larger polygons are split into triangles
+    size_t ply_faces_count = 0;
+  };
+
+  using FormatTask = std::function<void(size_t block, Chunk& chunk_out)>;
+
+  /** @brief Format blocks by batches in parallel and write them in order */
+  void WriteBlocks(std::ofstream& file, size_t blocks_count,
+                   const FormatTask& task);
+
+  /** @brief SubMethod for split polygons at face boundaries and count them */
+  static FaceBlocks SplitFaces(const std::vector<polygonType>& polygons);
+
+  void WriteObj(std::ofstream& file, const MeshData& mesh);
+  void WriteStl(std::ofstream& file, const MeshData& mesh);
+  void WritePly(std::ofstream& file, const MeshData& mesh);
+
+  ThreadPool* pool_ = &ThreadPool::Instance();
+};  // FileWriter
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_FILE_WRITER_H_
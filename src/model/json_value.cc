@@ -0,0 +1,248 @@
+/** @file
+ * @brief Definition of JsonValue class
+ */
+#include "model/json_value.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "model/number_parser.h"
+
+namespace ModelViewer3D {
+JsonValue JsonValue::Parse(const char* begin, const char* end) {
+  const char* text_p = begin;
+  JsonValue value = ParseValue(text_p, end, 0);
+  SkipSpaces(text_p, end);
+
+  if (text_p != end) {
+    throw std::runtime_error("Corupted JSON document");
+  }
+
+  return value;
+}
+
+double JsonValue::AsNumber(double default_value) const {
+  return this->type_ == kNumber ? this->number_ : default_value;
+}
+
+size_t JsonValue::AsIndex(size_t default_value) const {
+  // Larger numbers are not exact in double
+  const double kMaxIndex = 9007199254740992.0;
+  size_t index = kNoIndex;
+
+  if (this->type_ == kNull) {
+    index = default_value;
+  } else if (this->type_ == kNumber && this->number_ >= 0 &&
+             this->number_ < kMaxIndex &&
+             this->number_ == std::floor(this->number_)) {
+    index = size_t(this->number_);
+  }
+
+  return index;
+}
+
+bool JsonValue::Has(const std::string& key) const {
+  bool is_found = false;
+
+  for (size_t i = 0; i < this->keys_.size() && !is_found; ++i) {
+    is_found = this->keys_[i] == key;
+  }
+
+  return is_found;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+  static const JsonValue kNullValue;
+
+  for (size_t i = 0; i < this->keys_.size(); ++i) {
+    if (this->keys_[i] == key) {
+      return this->children_[i];
+    }
+  }
+
+  return kNullValue;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+  static const JsonValue kNullValue;
+
+  if (this->type_ != kArray || index >= this->children_.size()) {
+    return kNullValue;
+  }
+
+  return this->children_[index];
+}
+
+JsonValue JsonValue::ParseValue(const char*& text_p, const char* end,
+                                int depth) {
+  if (depth > kMaxDepth) {
+    throw std::runtime_error("Corupted JSON document");
+  }
+
+  SkipSpaces(text_p, end);
+  if (text_p == end) {
+    throw std::runtime_error("Corupted JSON document");
+  }
+
+  JsonValue value;
+
+  if (*text_p == '{') {
+    value.type_ = kObject;
+    ++text_p;
+    SkipSpaces(text_p, end);
+
+    bool is_end = text_p != end && *text_p == '}';
+    while (!is_end) {
+      SkipSpaces(text_p, end);
+      value.keys_.push_back(ParseString(text_p, end));
+      SkipSpaces(text_p, end);
+
+      if (text_p == end || *text_p != ':') {
+        throw std::runtime_error("Corupted JSON document");
+      }
+      ++text_p;
+
+      value.children_.push_back(ParseValue(text_p, end, depth + 1));
+      SkipSpaces(text_p, end);
+
+      if (text_p == end || (*text_p != ',' && *text_p != '}')) {
+        throw std::runtime_error("Corupted JSON document");
+      }
+      is_end = *text_p == '}';
+      if (!is_end) {
+        ++text_p;
+      }
+    }
+    ++text_p;
+
+  } else if (*text_p == '[') {
+    value.type_ = kArray;
+    ++text_p;
+    SkipSpaces(text_p, end);
+
+    bool is_end = text_p != end && *text_p == ']';
+    while (!is_end) {
+      value.children_.push_back(ParseValue(text_p, end, depth + 1));
+      SkipSpaces(text_p, end);
+
+      if (text_p == end || (*text_p != ',' && *text_p != ']')) {
+        throw std::runtime_error("Corupted JSON document");
+      }
+      is_end = *text_p == ']';
+      if (!is_end) {
+        ++text_p;
+      }
+    }
+    ++text_p;
+
+  } else if (*text_p == '"') {
+    value.type_ = kString;
+    value.string_ = ParseString(text_p, end);
+
+  } else if (end - text_p >= 4 && std::strncmp(text_p, "true", 4) == 0) {
+    value.type_ = kBool;
+    value.bool_ = true;
+    text_p += 4;
+
+  } else if (end - text_p >= 5 && std::strncmp(text_p, "false", 5) == 0) {
+    value.type_ = kBool;
+    text_p += 5;
+
+  } else if (end - text_p >= 4 && std::strncmp(text_p, "null", 4) == 0) {
+    text_p += 4;
+
+  } else {
+    const char* number_end = text_p;
+    while (number_end != end && std::strchr("+-.0123456789eE", *number_end)) {
+      number_end++;
+    }
+
+    value.type_ = kNumber;
+    if (number_end == text_p ||
+        ParseDouble(text_p, number_end, value.number_) != number_end) {
+      throw std::runtime_error("Corupted JSON document");
+    }
+    text_p = number_end;
+  }
+
+  return value;
+}
+
+std::string JsonValue::ParseString(const char*& text_p, const char* end) {
+  if (text_p == end || *text_p != '"') {
+    throw std::runtime_error("Corupted JSON document");
+  }
+  ++text_p;
+
+  std::string result;
+  while (text_p != end && *text_p != '"') {
+    if (*text_p != '\\') {
+      result.push_back(*text_p++);
+      continue;
+    }
+
+    if (++text_p == end) {
+      throw std::runtime_error("Corupted JSON document");
+    }
+
+    switch (*text_p) {
+      case 'b':
+        result.push_back('\b');
+        break;
+      case 'f':
+        result.push_back('\f');
+        break;
+      case 'n':
+        result.push_back('\n');
+        break;
+      case 'r':
+        result.push_back('\r');
+        break;
+      case 't':
+        result.push_back('\t');
+        break;
+      case 'u': {
+        if (end - text_p < 5) {
+          throw std::runtime_error("Corupted JSON document");
+        }
+        std::string hex(text_p + 1, text_p + 5);
+        AppendUtf8(std::strtoul(hex.c_str(), nullptr, 16), result);
+        text_p += 4;
+      } break;
+      default:
+        result.push_back(*text_p);
+        break;
+    }
+    ++text_p;
+  }
+
+  if (text_p == end) {
+    throw std::runtime_error("Corupted JSON document");
+  }
+  ++text_p;
+
+  return result;
+}
+
+void JsonValue::SkipSpaces(const char*& text_p, const char* end) {
+  while (text_p != end && (*text_p == ' ' || *text_p == '\t' ||
+                           *text_p == '\n' || *text_p == '\r')) {
+    text_p++;
+  }
+}
+
+void JsonValue::AppendUtf8(unsigned code_point, std::string& out) {
+  if (code_point < 0x80) {
+    out.push_back(code_point);
+  } else if (code_point < 0x800) {
+    out.push_back(0xC0 | (code_point >> 6));
+    out.push_back(0x80 | (code_point & 0x3F));
+  } else {
+    out.push_back(0xE0 | (code_point >> 12));
+    out.push_back(0x80 | ((code_point >> 6) & 0x3F));
+    out.push_back(0x80 | (code_point & 0x3F));
+  }
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,81 @@
+/** @file
+ * @brief Declaration of JsonValue class
+ */
+#ifndef SRC_MODEL_JSON_VALUE_H_
+#define SRC_MODEL_JSON_VALUE_H_
+
+#include <string>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Minimal read only JSON document tree, enough for scene
+ * descriptions of model formats
+ */
+class JsonValue {
+ public:
+  enum Type { kNull, kBool, kNumber, kString, kArray, kObject };
+
+  // Result of AsIndex for values which are not an index
+  static constexpr size_t kNoIndex = ~size_t(0);
+
+  JsonValue() = default;
+
+  /** @brief Parse the text of JSON document
+   * @param[in] begin Pointer to the first character
+   * @param[in] end Pointer past the last character
+   * @throw runtime_error
+   */
+  static JsonValue Parse(const char* begin, const char* end);
+
+  /** @brief Get the type of value */
+  Type GetType() const { return this->type_; }
+
+  /** @brief Get the number or default value if it is not a number */
+  double AsNumber(double default_value = 0) const;
+
+  /** @brief Get the non negative integral number, default value if there
+   * is no value and kNoIndex if it is not such a number
+   */
+  size_t AsIndex(size_t default_value = kNoIndex) const;
+
+  /** @brief Get the string or empty one if it is not a string */
+  const std::string& AsString() const { return this->string_; }
+
+  /** @brief Get the count of array elements or object members */
+  size_t Size() const { return this->children_.size(); }
+
+  /** @brief Check the object has the member */
+  bool Has(const std::string& key) const;
+
+  /** @brief Get the member of object, null value if there is no member */
+  const JsonValue& operator[](const std::string& key) const;
+
+  /** @brief Get the element of array, null value if it is out of range */
+  const JsonValue& operator[](size_t index) const;
+
+ private:
+  /** @brief SubMethods for parse a value at the cursor
+   * @throw runtime_error
+   */
+  static JsonValue ParseValue(const char*& text_p, const char* end,
+                              int depth);
+  static std::string ParseString(const char*& text_p, const char* end);
+  static void SkipSpaces(const char*& text_p, const char* end);
+
+  /** @brief Append the code point encoded in UTF-8 */
+  static void AppendUtf8(unsigned code_point, std::string& out);
+
+  // Nesting limit, which protects the stack from crafted files
+  static constexpr int kMaxDepth = 128;
+
+  Type type_ = kNull;
+  bool bool_ = false;
+  double number_ = 0;
+  std::string string_;
+  // Elements of array or values of object members
+  std::vector<JsonValue> children_;
+  // Names of object members, parallel to children_
+  std::vector<std::string> keys_;
+};  // JsonValue
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_JSON_VALUE_H_
@@ -0,0 +1,245 @@
+/** @file
+ * @brief Definition of MeshCache class
+ */
+#include "model/mesh_cache.h"
+
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "model/file_parser.h"
+
+namespace ModelViewer3D {
+MeshCache::MeshCache(size_t budget) : budget_(budget) {}
+
+MeshCache::~MeshCache() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->stop_ = true;
+    this->queue_.clear();
+  }
+  this->wake_.notify_all();
+
+  if (this->worker_.joinable()) {
+    this->worker_.join();
+  }
+}
+
+MeshCache::FileStamp MeshCache::GetStamp(const std::string& filename) {
+  std::error_code error;
+  FileStamp stamp;
+  stamp.time = std::filesystem::last_write_time(filename, error);
+
+  if (!error) {
+    stamp.size = std::filesystem::file_size(filename, error);
+  }
+
+  if (error) {
+    throw std::runtime_error("Could not open file");
+  }
+
+  return stamp;
+}
+
+std::shared_ptr<const MeshData> MeshCache::Find(const std::string& filename) {
+  FileStamp stamp;
+  try {
+    stamp = GetStamp(filename);
+  } catch (std::runtime_error&) {
+    return nullptr;
+  }
+
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  // The file which is parsed now is ready sooner than by a new parse
+  this->done_.wait(lock, [this, &filename] {
+    return this->preloading_ != filename;
+  });
+
+  auto found = this->index_.find(filename);
+  if (found == this->index_.end()) {
+    return nullptr;
+  }
+
+  std::list<Entry>::iterator entry = found->second;
+  if (!(entry->stamp == stamp)) {
+    // Model of the older version of file is not used anymore
+    this->used_size_ -= entry->size;
+    this->entries_.erase(entry);
+    this->index_.erase(found);
+    return nullptr;
+  }
+
+  this->entries_.splice(this->entries_.begin(), this->entries_, entry);
+
+  return entry->mesh;
+}
+
+void MeshCache::Insert(const std::string& filename, const FileStamp& stamp,
+                       std::shared_ptr<const MeshData> mesh) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->InsertLocked(filename, stamp, std::move(mesh));
+}
+
+void MeshCache::InsertLocked(const std::string& filename,
+                             const FileStamp& stamp,
+                             std::shared_ptr<const MeshData> mesh) {
+  auto found = this->index_.find(filename);
+  if (found != this->index_.end()) {
+    this->used_size_ -= found->second->size;
+    this->entries_.erase(found->second);
+    this->index_.erase(found);
+  }
+
+  size_t size = GetMeshSize(*mesh);
+  // Model larger than the budget would evict all others for nothing
+  if (size > this->budget_) {
+    return;
+  }
+
+  this->entries_.push_front(Entry{filename, stamp, std::move(mesh), size});
+  this->index_.emplace(filename, this->entries_.begin());
+  this->used_size_ += size;
+  this->Evict();
+}
+
+void MeshCache::Evict() {
+  while (this->used_size_ > this->budget_ && !this->entries_.empty()) {
+    const Entry& last = this->entries_.back();
+    this->used_size_ -= last.size;
+    this->index_.erase(last.filename);
+    this->entries_.pop_back();
+  }
+}
+
+bool MeshCache::Fits(const MeshData& mesh) const {
+  size_t size = GetMeshSize(mesh);
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return size <= this->budget_;
+}
+
+void MeshCache::Preload(const std::vector<std::string>& filenames) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->budget_ == 0) {
+      return;
+    }
+
+    this->queue_ = filenames;
+
+    if (!this->worker_.joinable()) {
+      this->worker_ = std::thread(&MeshCache::PreloadLoop, this);
+    }
+  }
+
+  this->wake_.notify_one();
+}
+
+void MeshCache::PreloadLoop() {
+  FileParser parser;
+  std::unique_lock<std::mutex> lock(this->mutex_);
+
+  while (true) {
+    this->wake_.wait(lock, [this] {
+      return this->stop_ || !this->queue_.empty();
+    });
+
+    if (this->stop_) {
+      break;
+    }
+
+    std::string filename = std::move(this->queue_.front());
+    this->queue_.erase(this->queue_.begin());
+    this->preloading_ = filename;
+    parser.SetMemoryBudget(this->load_memory_budget_);
+    lock.unlock();
+
+    FileStamp stamp;
+    std::shared_ptr<MeshData> mesh;
+    try {
+      stamp = GetStamp(filename);
+
+      std::unique_lock<std::mutex> check_lock(this->mutex_);
+      auto found = this->index_.find(filename);
+      bool is_cached =
+          found != this->index_.end() && found->second->stamp == stamp;
+      // Size on disk is a rough bound of the model, a large file is skipped
+      // rather than parsed in vain and waited for by Find
+      bool is_fit = stamp.size <= this->budget_;
+      check_lock.unlock();
+
+      if (!is_cached && is_fit) {
+        mesh = std::make_shared<MeshData>();
+        parser.ParseFile(filename, *mesh);
+      }
+    } catch (std::exception&) {
+      // Broken or removed file is reported when it is opened
+      mesh.reset();
+    }
+
+    lock.lock();
+    if (mesh && this->budget_ != 0) {
+      this->InsertLocked(filename, stamp, std::move(mesh));
+    }
+
+    this->preloading_.clear();
+    this->done_.notify_all();
+  }
+}
+
+void MeshCache::SetBudget(size_t budget) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->budget_ = budget;
+  this->Evict();
+}
+
+bool MeshCache::IsEnabled() const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->budget_ != 0;
+}
+
+void MeshCache::SetLoadMemoryBudget(size_t memory_budget) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->load_memory_budget_ = memory_budget;
+}
+
+size_t MeshCache::GetUsedSize() const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->used_size_;
+}
+
+size_t MeshCache::GetCount() const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->entries_.size();
+}
+
+void MeshCache::WaitPreload() {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->done_.wait(lock, [this] {
+    return this->queue_.empty() && this->preloading_.empty();
+  });
+}
+
+void MeshCache::Clear() {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->entries_.clear();
+  this->index_.clear();
+  this->used_size_ = 0;
+}
+
+size_t MeshCache::GetMeshSize(const MeshData& mesh) {
+  size_t size = sizeof(MeshData);
+  size += mesh.vertices.capacity() * sizeof(vertexType);
+  size += mesh.polygons.capacity() * sizeof(polygonType);
+  size += mesh.tex_coords.capacity() * sizeof(vertexType);
+  size += mesh.normals.capacity() * sizeof(vertexType);
+  size += mesh.tex_coord_indices.capacity() * sizeof(polygonType);
+  size += mesh.normal_indices.capacity() * sizeof(polygonType);
+
+  for (const MeshGroup& group : mesh.groups) {
+    size += sizeof(MeshGroup) + group.name.capacity() +
+            group.material.capacity();
+  }
+
+  return size;
+}
+}  // namespace ModelViewer3D
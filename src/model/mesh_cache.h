@@ -0,0 +1,148 @@
+/** @file
+ * @brief Declaration of MeshCache class
+ */
+#ifndef SRC_MODEL_MESH_CACHE_H_
+#define SRC_MODEL_MESH_CACHE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "model/mesh_data.h"
+
+namespace ModelViewer3D {
+/** @brief Least recently used cache of parsed models in memory
+ * Entries are keyed by the path and are valid while the modification time
+ * and the size of file are unchanged. Files of a list may be parsed in
+ * advance on a background thread
+ */
+class MeshCache {
+ public:
+  /** @brief Modification time and size of file, which identify its version
+   */
+  struct FileStamp {
+    std::filesystem::file_time_type time;
+    uintmax_t size = 0;
+
+    bool operator==(const FileStamp& other) const {
+      return this->time == other.time && this->size == other.size;
+    }
+  };
+
+  /** @brief Create the cache
+   * @param budget Size of cached models in bytes, zero disables the cache
+   */
+  explicit MeshCache(size_t budget = kDefaultBudget);
+
+  MeshCache(const MeshCache&) = delete;
+  MeshCache& operator=(const MeshCache&) = delete;
+
+  /** @brief Stop the preload, the file which is parsed now is finished */
+  ~MeshCache();
+
+  /** @brief Get the current version of file
+   * @throw runtime_error if the file is not opened
+   */
+  static FileStamp GetStamp(const std::string& filename);
+
+  /** @brief Find the model parsed from the current version of file
+   * Waits if the file is being preloaded now
+   * @return Parsed model or nullptr
+   */
+  std::shared_ptr<const MeshData> Find(const std::string& filename);
+
+  /** @brief Put the model to the cache, least recently used models are
+   * evicted to fit the budget
+   * @param filename Path to file
+   * @param stamp Version of file taken before the parse
+   * @param mesh Parsed model
+   */
+  void Insert(const std::string& filename, const FileStamp& stamp,
+              std::shared_ptr<const MeshData> mesh);
+
+  /** @brief Check the model is not larger than the budget, larger ones
+   * are not put to the cache
+   */
+  bool Fits(const MeshData& mesh) const;
+
+  /** @brief Parse files on the background thread and put them to the cache
+   * Files of the previous call which are not parsed yet are dropped, files
+   * which fail to parse or are larger than the budget on disk are skipped
+   * @param filenames Paths to files, in the order of parse
+   */
+  void Preload(const std::vector<std::string>& filenames);
+
+  /** @brief Set the size of cached models, excess models are evicted
+   * @param budget Size in bytes, zero disables the cache
+   */
+  void SetBudget(size_t budget);
+
+  /** @brief Check the cache stores models */
+  bool IsEnabled() const;
+
+  /** @brief Set the memory budget of preload parse, larger models are
+   * parsed through temporary files
+   * @param memory_budget Size in bytes, zero for unlimited
+   */
+  void SetLoadMemoryBudget(size_t memory_budget);
+
+  /** @brief Get the size of cached models in bytes */
+  size_t GetUsedSize() const;
+
+  /** @brief Get the count of cached models */
+  size_t GetCount() const;
+
+  /** @brief Wait until all files of the preload are parsed */
+  void WaitPreload();
+
+  /** @brief Remove all models */
+  void Clear();
+
+  /** @brief Get the size of memory used by arrays of the model */
+  static size_t GetMeshSize(const MeshData& mesh);
+
+  // Default size of cached models
+  static constexpr size_t kDefaultBudget = size_t(256) << 20;
+
+ private:
+  struct Entry {
+    std::string filename;
+    FileStamp stamp;
+    std::shared_ptr<const MeshData> mesh;
+    size_t size = 0;
+  };
+
+  /** @brief SubMethod for evict models over the budget, the lock is held */
+  void Evict();
+
+  /** @brief SubMethod for insert, the lock is held */
+  void InsertLocked(const std::string& filename, const FileStamp& stamp,
+                    std::shared_ptr<const MeshData> mesh);
+
+  /** @brief Loop of the background thread */
+  void PreloadLoop();
+
+  mutable std::mutex mutex_;
+  // Most recently used models are at the front
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t budget_;
+  size_t used_size_ = 0;
+  size_t load_memory_budget_ = 0;
+
+  std::thread worker_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::vector<std::string> queue_;
+  std::string preloading_;
+  bool stop_ = false;
+};  // MeshCache
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_MESH_CACHE_H_
@@ -0,0 +1,48 @@
+/** @file
+ * @brief Declaration of structures with the parsed model data
+ */
+#ifndef SRC_MODEL_MESH_DATA_H_
+#define SRC_MODEL_MESH_DATA_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model/model_types.h"
+
+namespace ModelViewer3D {
+/** @brief Range of polygon indices which belongs to one object, group or
+ * material of the file
+ */
+struct MeshGroup {
+  std::string name;
+  std::string material;
+  // First index of the range in MeshData::polygons
+  size_t first_index = 0;
+  size_t indices_count = 0;
+};
+
+/** @brief Parsed model as a structure of arrays, every attribute lays in its
+ * own contiguous array which stays empty if the file has no such attribute
+ */
+struct MeshData {
+  // Sequentially laid out XYZ coordinates
+  std::vector<vertexType> vertices;
+  // Consecutive pairs of indices of the edges
+  std::vector<polygonType> polygons;
+  uint64_t edges_count = 0;
+  // Sequentially laid out UV coordinates
+  std::vector<vertexType> tex_coords;
+  // Sequentially laid out XYZ components
+  std::vector<vertexType> normals;
+  // Indices of texture coordinates and normals per corner of faces, the
+  // vertex of corner c is polygons[2 * c]. Corners without the attribute
+  // have kNoIndex, the array is empty if no corner has it
+  std::vector<polygonType> tex_coord_indices;
+  std::vector<polygonType> normal_indices;
+  std::vector<MeshGroup> groups;
+
+  static constexpr polygonType kNoIndex = ~polygonType(0);
+};
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_MESH_DATA_H_
@@ -3,68 +3,421 @@
  */
 #include "model/model.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <string>
+#include <utility>
+
+#include "model/file_writer.h"
 
 namespace ModelViewer3D {
 void Model::Load(std::string filepath_) {
-  this->vertices_.clear();
-  this->polygon_indices_.clear();
-  this->edges_count_ = 0;
+  // The model stays empty if the file is not parsed
+  MeshData mesh;
+  this->SetMesh(mesh);
 
-  this->parser_.ParseFile(filepath_, this->vertices_, this->polygon_indices_,
-                          this->edges_count_);
+  this->parser_.ParseFile(filepath_, mesh);
+  this->SetMesh(mesh);
 }
 
-void Model::RotateX(float angle) {
-  float cos_angle = cos(angle);
-  float sin_angle = sin(angle);
-  for (unsigned i = 0; i < this->vertices_.size(); i += 3) {
-    float temp_y = this->vertices_[i + 1];
-    float temp_z = this->vertices_[i + 2];
-    this->vertices_[i + 1] = cos_angle * temp_y + sin_angle * temp_z;
-    this->vertices_[i + 2] = -sin_angle * temp_y + cos_angle * temp_z;
+void Model::Parse(const std::string& filepath, MeshData& mesh_out) {
+  this->parser_.ParseFile(filepath, mesh_out);
+}
+
+void Model::ParseChanges(const std::string& filepath, MeshData& mesh_out) {
+  if (!this->reload_parser_.Reload(filepath, mesh_out)) {
+    // Other formats are parsed whole by own chain of parsers
+    FileParser parser;
+    parser.ParseFile(filepath, mesh_out);
   }
 }
 
-void Model::RotateY(float angle) {
-  float cos_angle = cos(angle);
-  float sin_angle = sin(angle);
-  for (unsigned i = 0; i < this->vertices_.size(); i += 3) {
-    float temp_x = this->vertices_[i];
-    float temp_z = this->vertices_[i + 2];
-    this->vertices_[i] = cos_angle * temp_x + sin_angle * temp_z;
-    this->vertices_[i + 2] = -sin_angle * temp_x + cos_angle * temp_z;
+void Model::SetMesh(MeshData& mesh) {
+  this->transform_ = AffineTransform();
+  this->mesh_transform_ = AffineTransform();
+  this->source_vertices_.clear();
+
+  this->vertices_ = std::move(mesh.vertices);
+  this->polygon_indices_ = std::move(mesh.polygons);
+  this->edges_count_ = mesh.edges_count;
+  this->tex_coords_ = std::move(mesh.tex_coords);
+  this->normals_ = std::move(mesh.normals);
+  this->tex_coord_indices_ = std::move(mesh.tex_coord_indices);
+  this->normal_indices_ = std::move(mesh.normal_indices);
+  this->groups_ = std::move(mesh.groups);
+
+  if (this->is_stable_) {
+    this->source_vertices_.assign(this->vertices_.begin(),
+                                  this->vertices_.end());
+  }
+
+  this->triangle_indices_.clear();
+  if (this->is_triangles_kept_) {
+    Triangulate(this->polygon_indices_, this->triangle_indices_);
+  }
+
+  if (this->normals_mode_ != kNoNormals) {
+    this->BuildAdjacency();
+    this->UpdateNormals();
   }
 }
 
-void Model::RotateZ(float angle) {
-  float cos_angle = cos(angle);
-  float sin_angle = sin(angle);
-  for (unsigned i = 0; i < this->vertices_.size(); i += 3) {
-    float temp_x = this->vertices_[i];
-    float temp_y = this->vertices_[i + 1];
-    this->vertices_[i] = cos_angle * temp_x - sin_angle * temp_y;
-    this->vertices_[i + 1] = sin_angle * temp_x + cos_angle * temp_y;
+void Model::ReloadMesh(MeshData& mesh) {
+  AffineTransform transform = this->mesh_transform_;
+  this->SetMesh(mesh);
+
+  if (!transform.IsIdentity()) {
+    this->Transform(transform);
   }
 }
 
+void Model::CopyMesh(MeshData& mesh_out) {
+  mesh_out.vertices = this->vertices_;
+  mesh_out.polygons = this->polygon_indices_;
+  mesh_out.edges_count = this->edges_count_;
+  mesh_out.groups = this->groups_;
+}
+
+void Model::RotateX(float angle) {
+  this->Transform(AffineTransform::RotationX(angle));
+}
+
+void Model::RotateY(float angle) {
+  this->Transform(AffineTransform::RotationY(angle));
+}
+
+void Model::RotateZ(float angle) {
+  this->Transform(AffineTransform::RotationZ(angle));
+}
+
 void Model::Scale(float scale) {
-  for (unsigned i = 0; i < this->vertices_.size(); i++) {
-    this->vertices_[i] *= scale;
-  }
+  this->Transform(AffineTransform::Scale(scale));
 }
 
 void Model::Translate(float value, unsigned i) {
-  for (; i < this->vertices_.size(); i += 3) {
-    this->vertices_[i] += value;
+  AffineTransform transform;
+  transform(i, 3) = value;
+  this->Transform(transform);
+}
+
+void Model::Transform(const AffineTransform& transform) {
+  this->mesh_transform_ = transform * this->mesh_transform_;
+
+  if (this->is_stable_) {
+    this->transform_ = transform * this->transform_;
+
+    double matrix[12];
+    for (unsigned row = 0; row < 3; ++row) {
+      for (unsigned col = 0; col < 4; ++col) {
+        matrix[row * 4 + col] = this->transform_(row, col);
+      }
+    }
+
+    this->pool_->ParallelFor(this->GetVerticesCount(), this->GetBlockSize(),
+                             [this, matrix](size_t begin, size_t end) {
+                               this->RebuildRange(matrix, begin, end);
+                             });
+
+  } else {
+    vertexType matrix[12];
+    for (unsigned row = 0; row < 3; ++row) {
+      for (unsigned col = 0; col < 4; ++col) {
+        matrix[row * 4 + col] = transform(row, col);
+      }
+    }
+
+    this->pool_->ParallelFor(this->GetVerticesCount(), this->GetBlockSize(),
+                             [this, matrix](size_t begin, size_t end) {
+                               this->TransformRange(matrix, begin, end);
+                             });
+  }
+
+  // Translation does not turn the surface
+  bool is_linear_identity = true;
+  for (unsigned row = 0; row < 3; ++row) {
+    for (unsigned col = 0; col < 3; ++col) {
+      is_linear_identity =
+          is_linear_identity && transform(row, col) == (row == col ? 1 : 0);
+    }
+  }
+
+  if (this->normals_mode_ != kNoNormals && !is_linear_identity) {
+    this->UpdateNormals();
+  }
+}
+
+void Model::TransformRange(const vertexType* matrix, size_t begin,
+                           size_t end) {
+  vertexType* vertex = this->vertices_.data() + begin * 3;
+  vertexType* vertex_end = this->vertices_.data() + end * 3;
+
+  for (; vertex != vertex_end; vertex += 3) {
+    vertexType x = vertex[0];
+    vertexType y = vertex[1];
+    vertexType z = vertex[2];
+    vertex[0] = matrix[0] * x + matrix[1] * y + matrix[2] * z + matrix[3];
+    vertex[1] = matrix[4] * x + matrix[5] * y + matrix[6] * z + matrix[7];
+    vertex[2] = matrix[8] * x + matrix[9] * y + matrix[10] * z + matrix[11];
+  }
+}
+
+void Model::RebuildRange(const double* matrix, size_t begin, size_t end) {
+  const double* source = this->source_vertices_.data() + begin * 3;
+  vertexType* vertex = this->vertices_.data() + begin * 3;
+  vertexType* vertex_end = this->vertices_.data() + end * 3;
+
+  for (; vertex != vertex_end; vertex += 3, source += 3) {
+    double x = source[0];
+    double y = source[1];
+    double z = source[2];
+    vertex[0] = matrix[0] * x + matrix[1] * y + matrix[2] * z + matrix[3];
+    vertex[1] = matrix[4] * x + matrix[5] * y + matrix[6] * z + matrix[7];
+    vertex[2] = matrix[8] * x + matrix[9] * y + matrix[10] * z + matrix[11];
+  }
+}
+
+void Model::GetBounds(vertexType min[3], vertexType max[3]) {
+  for (unsigned i = 0; i < 3; ++i) {
+    min[i] = std::numeric_limits<vertexType>::infinity();
+    max[i] = -std::numeric_limits<vertexType>::infinity();
+  }
+
+  size_t vertices_count = this->GetVerticesCount();
+  size_t block_size = this->GetBlockSize();
+  size_t blocks_count = (vertices_count + block_size - 1) / block_size;
+
+  // Every block has own slot, so threads does not share the result
+  std::vector<vertexType> block_bounds(blocks_count * 6);
+  for (size_t block = 0; block < blocks_count; ++block) {
+    std::copy(min, min + 3, block_bounds.begin() + block * 6);
+    std::copy(max, max + 3, block_bounds.begin() + block * 6 + 3);
+  }
+
+  auto bounds_range = [this, &block_bounds, block_size](size_t begin,
+                                                        size_t end) {
+    vertexType* bounds = block_bounds.data() + (begin / block_size) * 6;
+    const vertexType* vertex = this->vertices_.data() + begin * 3;
+    const vertexType* vertex_end = this->vertices_.data() + end * 3;
+
+    for (; vertex != vertex_end; vertex += 3) {
+      for (unsigned i = 0; i < 3; ++i) {
+        bounds[i] = std::min(bounds[i], vertex[i]);
+        bounds[i + 3] = std::max(bounds[i + 3], vertex[i]);
+      }
+    }
+  };
+
+  this->pool_->ParallelFor(vertices_count, block_size, bounds_range);
+
+  for (size_t block = 0; block < blocks_count; ++block) {
+    for (unsigned i = 0; i < 3; ++i) {
+      min[i] = std::min(min[i], block_bounds[block * 6 + i]);
+      max[i] = std::max(max[i], block_bounds[block * 6 + i + 3]);
+    }
   }
 }
 
+void Model::SetKeepTriangles(bool enable) {
+  if (enable == this->is_triangles_kept_) {
+    return;
+  }
+
+  this->is_triangles_kept_ = enable;
+
+  if (enable) {
+    Triangulate(this->polygon_indices_, this->triangle_indices_);
+  } else {
+    // Memory is returned, not only the size
+    std::vector<polygonType>().swap(this->triangle_indices_);
+  }
+
+  if (this->normals_mode_ != kNoNormals) {
+    this->BuildAdjacency();
+    this->UpdateNormals();
+  }
+}
+
+void Model::SetSurfaceNormals(SurfaceNormals mode) {
+  if (mode == this->normals_mode_) {
+    return;
+  }
+
+  this->normals_mode_ = mode;
+
+  if (mode == kNoNormals) {
+    std::vector<vertexType>().swap(this->surface_normals_);
+  }
+  this->BuildAdjacency();
+  this->UpdateNormals();
+}
+
+void Model::BuildAdjacency() {
+  if (this->normals_mode_ != kSmoothNormals) {
+    std::vector<polygonType>().swap(this->adjacency_offsets_);
+    std::vector<polygonType>().swap(this->adjacency_);
+    return;
+  }
+
+  // Counting sort of corners by their vertices
+  size_t vertices_count = this->GetVerticesCount();
+  this->adjacency_offsets_.assign(vertices_count + 1, 0);
+  for (polygonType index : this->triangle_indices_) {
+    if (index < vertices_count) ++this->adjacency_offsets_[index + 1];
+  }
+  for (size_t i = 0; i < vertices_count; ++i) {
+    this->adjacency_offsets_[i + 1] += this->adjacency_offsets_[i];
+  }
+
+  this->adjacency_.resize(this->adjacency_offsets_[vertices_count]);
+  std::vector<polygonType> next(this->adjacency_offsets_.begin(),
+                                this->adjacency_offsets_.end() - 1);
+  for (size_t corner = 0; corner < this->triangle_indices_.size(); ++corner) {
+    polygonType index = this->triangle_indices_[corner];
+    if (index < vertices_count) this->adjacency_[next[index]++] = corner;
+  }
+}
+
+void Model::UpdateNormals() {
+  size_t vertices_count = this->GetVerticesCount();
+  size_t triangles_count = this->triangle_indices_.size() / 3;
+  const vertexType* vertices = this->vertices_.data();
+  const polygonType* triangles = this->triangle_indices_.data();
+
+  // Unnormalized normal of the triangle and the angle at its corner
+  auto corner_normal = [=](size_t corner, vertexType normal[3],
+                           vertexType* angle) {
+    size_t first = corner - corner % 3;
+    const vertexType* p[3];
+    for (size_t k = 0; k < 3; ++k) {
+      polygonType index = triangles[first + (corner - first + k) % 3];
+      if (index >= vertices_count) {
+        normal[0] = normal[1] = normal[2] = 0;
+        return;
+      }
+      p[k] = vertices + size_t(index) * 3;
+    }
+
+    vertexType a[3], b[3];
+    for (int i = 0; i < 3; ++i) {
+      a[i] = p[1][i] - p[0][i];
+      b[i] = p[2][i] - p[0][i];
+    }
+    normal[0] = a[1] * b[2] - a[2] * b[1];
+    normal[1] = a[2] * b[0] - a[0] * b[2];
+    normal[2] = a[0] * b[1] - a[1] * b[0];
+
+    if (angle) {
+      vertexType length_a = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+      vertexType length_b = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+      vertexType cosine = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) /
+                          std::max(length_a * length_b,
+                                   std::numeric_limits<vertexType>::min());
+      *angle = std::acos(std::clamp(cosine, vertexType(-1), vertexType(1)));
+    }
+  };
+
+  auto normalize = [](vertexType* normal) {
+    vertexType length = std::sqrt(normal[0] * normal[0] +
+                                  normal[1] * normal[1] +
+                                  normal[2] * normal[2]);
+    if (length > 0) {
+      for (int i = 0; i < 3; ++i) normal[i] /= length;
+    }
+  };
+
+  if (this->normals_mode_ == kFlatNormals) {
+    this->surface_normals_.resize(triangles_count * 3);
+    vertexType* normals = this->surface_normals_.data();
+    this->pool_->ParallelFor(triangles_count, kBlockSize,
+                             [=](size_t begin, size_t end) {
+                               for (size_t i = begin; i < end; ++i) {
+                                 corner_normal(i * 3, normals + i * 3,
+                                               nullptr);
+                                 normalize(normals + i * 3);
+                               }
+                             });
+  } else if (this->normals_mode_ == kSmoothNormals) {
+    this->surface_normals_.resize(vertices_count * 3);
+    vertexType* normals = this->surface_normals_.data();
+    const polygonType* offsets = this->adjacency_offsets_.data();
+    const polygonType* adjacency = this->adjacency_.data();
+
+    // Every vertex gathers own corners, so threads do not share the result
+    this->pool_->ParallelFor(
+        vertices_count, this->GetBlockSize(), [=](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            vertexType* normal = normals + i * 3;
+            normal[0] = normal[1] = normal[2] = 0;
+            for (polygonType k = offsets[i]; k < offsets[i + 1]; ++k) {
+              vertexType face[3], angle = 0;
+              corner_normal(adjacency[k], face, &angle);
+              normalize(face);
+              for (int j = 0; j < 3; ++j) normal[j] += face[j] * angle;
+            }
+            normalize(normal);
+          }
+        });
+  }
+}
+
+void Model::Triangulate(const std::vector<polygonType>& polygons,
+                        std::vector<polygonType>& triangles_out) {
+  triangles_out.clear();
+
+  // Vertices of the face are the starts of its edges
+  for (size_t face = 0; face < polygons.size();) {
+    size_t face_end = FileWriter::FindFaceEnd(polygons, face);
+
+    for (size_t i = face + 2; i + 2 < face_end; i += 2) {
+      triangles_out.push_back(polygons[face]);
+      triangles_out.push_back(polygons[i]);
+      triangles_out.push_back(polygons[i + 2]);
+    }
+
+    face = face_end;
+  }
+}
+
+void Model::SetStableTransform(bool enable) {
+  if (enable == this->is_stable_) {
+    return;
+  }
+
+  this->is_stable_ = enable;
+  this->transform_ = AffineTransform();
+
+  if (enable) {
+    this->source_vertices_.assign(this->vertices_.begin(),
+                                  this->vertices_.end());
+  } else {
+    std::vector<double>().swap(this->source_vertices_);
+  }
+}
+
+void Model::SetThreadPool(ThreadPool* pool) { this->pool_ = pool; }
+
+void Model::SetMemoryBudget(size_t memory_budget) {
+  this->parser_.SetMemoryBudget(memory_budget);
+}
+
+size_t Model::GetBlockSize() {
+  size_t vertices_count = this->GetVerticesCount();
+
+  // Small models are processed by the calling thread only
+  if (vertices_count < kParallelThreshold) {
+    return std::max<size_t>(vertices_count, 1);
+  }
+
+  return kBlockSize;
+}
+
 vertexType* Model::GetVertices() { return this->vertices_.data(); }
 
 polygonType* Model::GetPolygons() { return this->polygon_indices_.data(); }
 
+polygonType* Model::GetTriangles() { return this->triangle_indices_.data(); }
+
 unsigned int Model::GetVerticesCount() { return this->vertices_.size() / 3; }
 
 unsigned int Model::GetEdgeCount() { return this->edges_count_; }
@@ -72,4 +425,32 @@ unsigned int Model::GetEdgeCount() { return this->edges_count_; }
 unsigned int Model::GetFacesIndicesCount() {
   return this->polygon_indices_.size();
 }
+
+unsigned int Model::GetTrianglesIndicesCount() {
+  return this->triangle_indices_.size();
+}
+
+const vertexType* Model::GetSurfaceNormals() {
+  return this->surface_normals_.data();
+}
+
+unsigned int Model::GetSurfaceNormalsCount() {
+  return this->surface_normals_.size() / 3;
+}
+
+const std::vector<vertexType>& Model::GetTexCoords() {
+  return this->tex_coords_;
+}
+
+const std::vector<vertexType>& Model::GetNormals() { return this->normals_; }
+
+const std::vector<polygonType>& Model::GetTexCoordIndices() {
+  return this->tex_coord_indices_;
+}
+
+const std::vector<polygonType>& Model::GetNormalIndices() {
+  return this->normal_indices_;
+}
+
+const std::vector<MeshGroup>& Model::GetGroups() { return this->groups_; }
 }  // namespace ModelViewer3D
@@ -7,8 +7,12 @@
 #include <string>
 #include <vector>
 
+#include "model/affine_transform.h"
+#include "model/chunked_obj_parser.h"
 #include "model/file_parser.h"
+#include "model/mesh_data.h"
 #include "model/model_types.h"
+#include "model/thread_pool.h"
 
 namespace ModelViewer3D {
 class Model {
@@ -24,6 +28,34 @@ class Model {
    */
   void Load(std::string filepath_);
 
+  /** @brief Parse the file without change of the model
+   * @param[in] filepath Path to file
+   * @param[out] mesh_out Structure for store the parsed model
+   * @throw runtime_error
+   */
+  void Parse(const std::string& filepath, MeshData& mesh_out);
+
+  /** @brief Parse the changed file again, obj files reuse parsed chunks
+   * which are equal to chunks of the previous call
+   * The model itself is not changed, so the method may run on another thread
+   * while the model is used, but not concurrently with itself
+   * @param[in] filepath Path to file
+   * @param[out] mesh_out Structure for store the parsed model
+   * @throw runtime_error
+   */
+  void ParseChanges(const std::string& filepath, MeshData& mesh_out);
+
+  /** @brief Replace the model by the parsed one
+   * @param[in, out] mesh Parsed model, its arrays are moved to the model
+   */
+  void SetMesh(MeshData& mesh);
+
+  /** @brief Replace the model by the new version of file, transforms
+   * applied since the model was set are applied to the new one too
+   * @param[in, out] mesh Parsed model, its arrays are moved to the model
+   */
+  void ReloadMesh(MeshData& mesh);
+
   /** @brief Rotate model around the X axis */
   void RotateX(float angle);
 
@@ -42,12 +74,75 @@ class Model {
    */
   void Translate(float value, unsigned i);
 
+  /** @brief Apply an arbitrary affine transform to the model in one pass
+   * Large models are split between several threads
+   * @param transform 3x4 matrix of the transform
+   */
+  void Transform(const AffineTransform& transform);
+
+  /** @brief Get the axis aligned bounding box of the model
+   * @param[out] min Minimal coordinates on the XYZ axis
+   * @param[out] max Maximal coordinates on the XYZ axis
+   */
+  void GetBounds(vertexType min[3], vertexType max[3]);
+
+  /** @brief Enable or disable the stable transform mode
+   * In this mode a pristine double precision copy of the loaded vertices is
+   * kept, transforms are accumulated in a single matrix and the vertices are
+   * rebuilt from the copy in one pass, so repeated transforms do not distort
+   * the model
+   * @param enable Mode state
+   */
+  void SetStableTransform(bool enable);
+
+  /** @brief Enable the triangulation of faces
+   * Faces are split into fans of triangles when the model is set, the
+   * indices are kept only while the mode is enabled
+   * @param enable Mode state
+   */
+  void SetKeepTriangles(bool enable);
+
+  /** @brief Set the kind of normals of triangles, they are recomputed in
+   * parallel when the model is set or transformed
+   * Normals are computed only for kept triangles, the arrays are freed when
+   * the mode is disabled
+   * @param mode Per triangle, per vertex or no normals
+   */
+  void SetSurfaceNormals(SurfaceNormals mode);
+
+  /** @brief Split faces into fans of triangles from their first vertex
+   * @param[in] polygons Consecutive pairs of edge indices of faces
+   * @param[out] triangles_out Consecutive triples of vertex indices
+   */
+  static void Triangulate(const std::vector<polygonType>& polygons,
+                          std::vector<polygonType>& triangles_out);
+
+  /** @brief Set the pool for parallel processing of large models
+   * @param pool Pool of threads, by default the shared one
+   */
+  void SetThreadPool(ThreadPool* pool);
+
+  /** @brief Set the memory budget of load, larger models are parsed through
+   * temporary files
+   * @param memory_budget Size in bytes, zero for unlimited
+   */
+  void SetMemoryBudget(size_t memory_budget);
+
+  /** @brief Copy the transformed vertices, polygons and groups of the model
+   * @param[out] mesh_out Structure for store the model
+   */
+  void CopyMesh(MeshData& mesh_out);
+
   /** @brief Get the raw vertices_ array */
   vertexType* GetVertices();
 
   /** @brief Get the raw polygon indices array */
   polygonType* GetPolygons();
 
+  /** @brief Get the raw triangle indices array, empty if the mode of
+   * triangulation is disabled */
+  polygonType* GetTriangles();
+
   /** @brief Get the count vertices_ */
   unsigned int GetVerticesCount();
 
@@ -57,11 +152,82 @@ class Model {
   /** @brief Get the count faces */
   unsigned int GetFacesIndicesCount();
 
+  /** @brief Get the count of triangle indices */
+  unsigned int GetTrianglesIndicesCount();
+
+  /** @brief Get normals of triangles or vertices as of the surface normals
+   * mode, sequentially laid out coordinates of unit vectors */
+  const vertexType* GetSurfaceNormals();
+
+  /** @brief Get the count of surface normals */
+  unsigned int GetSurfaceNormalsCount();
+
+  /** @brief Get the texture coordinates, empty if the file has not them */
+  const std::vector<vertexType>& GetTexCoords();
+
+  /** @brief Get the normals, empty if the file has not them */
+  const std::vector<vertexType>& GetNormals();
+
+  /** @brief Get indices of texture coordinates per corner of faces, empty
+   * if faces have not them */
+  const std::vector<polygonType>& GetTexCoordIndices();
+
+  /** @brief Get indices of normals per corner of faces, empty if faces
+   * have not them */
+  const std::vector<polygonType>& GetNormalIndices();
+
+  /** @brief Get the ranges of polygon indices of objects, groups and
+   * materials, empty if the file has not them */
+  const std::vector<MeshGroup>& GetGroups();
+
  private:
+  /** @brief Apply a row major 3x4 matrix to the vertices in [begin, end) */
+  void TransformRange(const vertexType* matrix, size_t begin, size_t end);
+
+  /** @brief Rebuild the vertices in [begin, end) from the pristine copy
+   * using a row major 3x4 matrix */
+  void RebuildRange(const double* matrix, size_t begin, size_t end);
+
+  /** @brief Build the triangles adjacent to each vertex for smooth normals */
+  void BuildAdjacency();
+
+  /** @brief Compute normals of the surface normals mode in parallel */
+  void UpdateNormals();
+
+  /** @brief Get the count of vertices in one block of parallel processing */
+  size_t GetBlockSize();
+
+  // Vertices count since which processing is split between threads
+  static constexpr size_t kParallelThreshold = 1 << 16;
+  // Vertices in one block of parallel processing, 192 KiB fits in L2 cache
+  static constexpr size_t kBlockSize = 1 << 14;
+
   std::vector<vertexType> vertices_;
+  // Pristine vertices and accumulated transform of the stable mode
+  std::vector<double> source_vertices_;
+  AffineTransform transform_;
+  bool is_stable_ = false;
+  // All transforms since the model was set, in any mode
+  AffineTransform mesh_transform_;
   std::vector<polygonType> polygon_indices_;
+  // Triples of vertex indices, filled only in the mode of triangulation
+  std::vector<polygonType> triangle_indices_;
+  bool is_triangles_kept_ = false;
+  SurfaceNormals normals_mode_ = kNoNormals;
+  std::vector<vertexType> surface_normals_;
+  // Corners of triangles (triangle * 3 + corner) around each vertex, the
+  // range of vertex i starts at adjacency_offsets_[i]
+  std::vector<polygonType> adjacency_offsets_;
+  std::vector<polygonType> adjacency_;
+  std::vector<vertexType> tex_coords_;
+  std::vector<vertexType> normals_;
+  std::vector<polygonType> tex_coord_indices_;
+  std::vector<polygonType> normal_indices_;
+  std::vector<MeshGroup> groups_;
   FileParser parser_;
+  ChunkedObjParser reload_parser_;
   uint64_t edges_count_;
+  ThreadPool* pool_ = &ThreadPool::Instance();
 };  // Model
 }  // namespace ModelViewer3D
 #endif  // SRC_MODEL_MODEL_H_
@@ -6,4 +6,15 @@
 using vertexType = float;
 using polygonType = unsigned int;
 
+namespace ModelViewer3D {
+/** @brief Normals of triangles for the shading of faces */
+enum SurfaceNormals {
+  kNoNormals,
+  // Normal per triangle
+  kFlatNormals,
+  // Normal per vertex, averaged over triangles by their angles
+  kSmoothNormals
+};
+}  // namespace ModelViewer3D
+
 #endif  // SRC_MODEL_MODEL_TYPES_H_
@@ -0,0 +1,48 @@
+/** @file
+ * @brief Definition of locale independent number parsing functions
+ */
+#include "model/number_parser.h"
+
+#include <cctype>
+#include <charconv>
+#include <system_error>
+
+namespace ModelViewer3D {
+/** @brief SubMethod for skip what strtod skips, from_chars does not */
+static const char* SkipPrefix(const char* text_p, const char* end) {
+  while (text_p != end && isspace(static_cast<unsigned char>(*text_p))) {
+    text_p++;
+  }
+
+  // Plus is skipped only before the number, "+-1" is not a number
+  if (text_p != end && *text_p == '+' && end - text_p > 1 &&
+      text_p[1] != '-' && text_p[1] != '+') {
+    text_p++;
+  }
+
+  return text_p;
+}
+
+template <typename Number>
+static const char* ParseNumber(const char* begin, const char* end,
+                               Number& value) {
+  const char* text_p = SkipPrefix(begin, end);
+  Number result = 0;
+  std::from_chars_result parsed = std::from_chars(text_p, end, result);
+
+  if (parsed.ec != std::errc()) {
+    return begin;
+  }
+
+  value = result;
+  return parsed.ptr;
+}
+
+const char* ParseFloat(const char* begin, const char* end, float& value) {
+  return ParseNumber(begin, end, value);
+}
+
+const char* ParseDouble(const char* begin, const char* end, double& value) {
+  return ParseNumber(begin, end, value);
+}
+}  // namespace ModelViewer3D
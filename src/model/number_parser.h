@@ -0,0 +1,23 @@
+/** @file
+ * @brief Declaration of locale independent number parsing functions
+ */
+#ifndef SRC_MODEL_NUMBER_PARSER_H_
+#define SRC_MODEL_NUMBER_PARSER_H_
+
+namespace ModelViewer3D {
+/** @brief Parse the number with the decimal point, whatever LC_NUMERIC is
+ * Leading whitespace and the plus sign are skipped as by strtof
+ * @param[in] begin Pointer to the text
+ * @param[in] end Pointer to the end of text
+ * @param[out] value Parsed number, unchanged if there is no number
+ * @return Pointer after the number, begin if there is no number or it is
+ * out of range
+ */
+const char* ParseFloat(const char* begin, const char* end, float& value);
+
+/** @brief Parse the number with the decimal point in double precision
+ * @see ParseFloat
+ */
+const char* ParseDouble(const char* begin, const char* end, double& value);
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_NUMBER_PARSER_H_
@@ -0,0 +1,522 @@
+/** @file
+ * @brief Definition of ParserListGLTF class
+ */
+#include "model/parser_gltf.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ModelViewer3D {
+// Values of gltf specification
+static constexpr uint32_t kGlbMagic = 0x46546C67;
+static constexpr uint32_t kGlbChunkJson = 0x4E4F534A;
+static constexpr uint32_t kGlbChunkBin = 0x004E4942;
+static constexpr int kComponentUInt8 = 5121;
+static constexpr int kComponentUInt16 = 5123;
+static constexpr int kComponentUInt32 = 5125;
+static constexpr int kComponentFloat = 5126;
+static constexpr int kModeTriangles = 4;
+static constexpr int kModeTriangleStrip = 5;
+static constexpr int kModeTriangleFan = 6;
+
+bool ParserListGLTF::Accepts(const FileProbe& probe) {
+  const std::string& header = probe.GetHeader();
+  // Buffers are read by offsets, compressed file is not seekable
+  bool is_accepted = header.compare(0, 4, "glTF") == 0;
+
+  if (!is_accepted) {
+    size_t first_char = header.find_first_not_of(" \t\r\n");
+    is_accepted = first_char != std::string::npos &&
+                  header[first_char] == '{' &&
+                  header.find("\"asset\"") != std::string::npos;
+  }
+
+  return is_accepted && !probe.IsCompressed();
+}
+
+bool ParserListGLTF::ParseConcrete(FileProbe& probe, MeshData& mesh_out) {
+  std::istream& file = probe.Rewind();
+  uint64_t bin_offset = 0;
+  uint64_t bin_size = 0;
+  const char* json = nullptr;
+  size_t json_size = 0;
+
+  if (probe.GetHeader().compare(0, 4, "glTF") == 0) {
+    json = this->ReadGlb(file, probe.GetFileSize(), json_size, bin_offset,
+                         bin_size);
+
+  } else {
+    json_size = probe.GetFileSize();
+    char* text = this->arena_->AllocateArray<char>(json_size);
+    file.read(text, json_size);
+    json = text;
+  }
+
+  this->document_ = JsonValue::Parse(json, json + json_size);
+  this->OpenBuffers(probe.GetFilename(), file, bin_offset, bin_size);
+
+  size_t face_count = 0;
+  const JsonValue& scenes = this->document_["scenes"];
+  this->visited_nodes_.assign(this->document_["nodes"].Size(), false);
+
+  if (scenes.Size() != 0) {
+    size_t scene_index = ParseIndex(this->document_["scene"], 0);
+    const JsonValue& nodes = scenes[scene_index]["nodes"];
+
+    for (size_t i = 0; i < nodes.Size(); ++i) {
+      face_count +=
+          this->ParseNode(ParseIndex(nodes[i]), AffineTransform(), 0, mesh_out);
+    }
+
+  } else {
+    // File without scenes is a library of meshes
+    for (size_t i = 0; i < this->document_["meshes"].Size(); ++i) {
+      face_count += this->ParseMesh(i, AffineTransform(), mesh_out);
+    }
+  }
+
+  this->buffers_.clear();
+  this->visited_nodes_.clear();
+  this->document_ = JsonValue();
+
+  if (face_count != 0) {
+    mesh_out.edges_count = (mesh_out.vertices.size() / 3) + face_count - 2;
+  }
+
+  return false;
+}
+
+const char* ParserListGLTF::ReadGlb(std::istream& file, uint64_t file_size,
+                                    size_t& json_size, uint64_t& bin_offset,
+                                    uint64_t& bin_size) {
+  uint32_t header[5] = {0};
+  file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+  // Magic, version, length and the first chunk length and type
+  if (!file || header[0] != kGlbMagic || header[1] != 2 ||
+      header[4] != kGlbChunkJson) {
+    throw std::runtime_error("Corupted format of GLB file");
+  }
+
+  // Chunks are bounded by the total length before they are allocated
+  uint64_t json_end = sizeof(header) + uint64_t(header[3]);
+  if (json_end > header[2] || header[2] > file_size) {
+    throw std::runtime_error("Corupted format of GLB file");
+  }
+
+  json_size = header[3];
+  char* json = this->arena_->AllocateArray<char>(json_size);
+  file.read(json, json_size);
+
+  uint32_t chunk_header[2] = {0};
+  if (file && json_end + sizeof(chunk_header) <= header[2]) {
+    file.read(reinterpret_cast<char*>(chunk_header), sizeof(chunk_header));
+  }
+
+  if (!file) {
+    throw std::runtime_error("Corupted format of GLB file");
+  }
+
+  if (chunk_header[1] == kGlbChunkBin) {
+    bin_offset = json_end + sizeof(chunk_header);
+    bin_size = chunk_header[0];
+
+    if (bin_offset + bin_size > header[2]) {
+      throw std::runtime_error("Corupted format of GLB file");
+    }
+  }
+
+  file.clear();
+  return json;
+}
+
+void ParserListGLTF::OpenBuffers(const std::string& filename,
+                                 std::istream& file, uint64_t bin_offset,
+                                 uint64_t bin_size) {
+  const JsonValue& buffers = this->document_["buffers"];
+  size_t directory_end = filename.find_last_of("/\\");
+  std::string directory = (directory_end == std::string::npos)
+                              ? std::string()
+                              : filename.substr(0, directory_end + 1);
+
+  this->buffers_.resize(buffers.Size());
+
+  for (size_t i = 0; i < buffers.Size(); ++i) {
+    GltfBuffer& buffer = this->buffers_[i];
+    const std::string& uri = buffers[i]["uri"].AsString();
+    uint64_t byte_length = ParseIndex(buffers[i]["byteLength"]);
+
+    if (uri.empty()) {
+      // The buffer without uri is the binary chunk of glb
+      if (i != 0 || bin_size == 0) {
+        throw std::runtime_error("Corupted format of GLTF file");
+      }
+      buffer.file = &file;
+      buffer.offset = bin_offset;
+      buffer.size = bin_size;
+
+    } else if (uri.compare(0, 5, "data:") == 0) {
+      size_t data_begin = uri.find(";base64,");
+      if (data_begin == std::string::npos) {
+        throw std::runtime_error("Corupted format of GLTF file");
+      }
+      buffer.memory = DecodeBase64(uri.substr(data_begin + 8));
+      buffer.size = buffer.memory.size();
+
+    } else {
+      buffer.own_file = std::make_unique<std::ifstream>(directory + uri,
+                                                        std::ios::binary);
+      if (buffer.own_file->fail()) {
+        throw std::runtime_error("Could not open buffer of GLTF file");
+      }
+      buffer.own_file->seekg(0, std::ios::end);
+      buffer.size = buffer.own_file->tellg();
+      buffer.file = buffer.own_file.get();
+    }
+
+    if (buffer.size < byte_length) {
+      throw std::runtime_error("Corupted format of GLTF file");
+    }
+  }
+}
+
+size_t ParserListGLTF::ParseNode(size_t node_index,
+                                 const AffineTransform& parent, int depth,
+                                 MeshData& mesh_out) {
+  // Node hierarchy of gltf is a forest, the node reached twice is shared
+  // or is a part of a cycle, deep nesting would overflow the stack
+  const int kMaxDepth = 64;
+  const JsonValue& node = this->document_["nodes"][node_index];
+
+  if (node.GetType() != JsonValue::kObject || depth > kMaxDepth ||
+      this->visited_nodes_[node_index]) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  this->visited_nodes_[node_index] = true;
+
+  AffineTransform transform = parent * NodeTransform(node);
+  size_t face_count = 0;
+
+  if (node.Has("mesh")) {
+    face_count +=
+        this->ParseMesh(ParseIndex(node["mesh"]), transform, mesh_out);
+  }
+
+  const JsonValue& children = node["children"];
+  for (size_t i = 0; i < children.Size(); ++i) {
+    face_count += this->ParseNode(ParseIndex(children[i]), transform,
+                                  depth + 1, mesh_out);
+  }
+
+  return face_count;
+}
+
+size_t ParserListGLTF::ParseMesh(size_t mesh_index,
+                                 const AffineTransform& transform,
+                                 MeshData& mesh_out) {
+  const JsonValue& mesh = this->document_["meshes"][mesh_index];
+  const JsonValue& primitives = mesh["primitives"];
+  std::vector<polygonType> indices;
+  size_t face_count = 0;
+
+  if (mesh.GetType() != JsonValue::kObject) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  for (size_t i = 0; i < primitives.Size(); ++i) {
+    const JsonValue& primitive = primitives[i];
+    size_t mode = ParseIndex(primitive["mode"], kModeTriangles);
+
+    // Points and lines have no faces
+    if (!primitive["attributes"].Has("POSITION") ||
+        (mode != kModeTriangles && mode != kModeTriangleStrip &&
+         mode != kModeTriangleFan)) {
+      continue;
+    }
+
+    size_t first_vertex = mesh_out.vertices.size() / 3;
+    size_t vertices_count = this->ReadPositions(
+        ParseIndex(primitive["attributes"]["POSITION"]), mesh_out.vertices);
+
+    if (!transform.IsIdentity()) {
+      vertexType* vertex = mesh_out.vertices.data() + first_vertex * 3;
+      for (size_t j = 0; j < vertices_count; ++j, vertex += 3) {
+        double x = vertex[0], y = vertex[1], z = vertex[2];
+        for (unsigned row = 0; row < 3; ++row) {
+          vertex[row] = transform(row, 0) * x + transform(row, 1) * y +
+                        transform(row, 2) * z + transform(row, 3);
+        }
+      }
+    }
+
+    indices.clear();
+    if (primitive.Has("indices")) {
+      this->ReadIndices(ParseIndex(primitive["indices"]), indices);
+    } else {
+      for (size_t j = 0; j < vertices_count; ++j) {
+        indices.push_back(j);
+      }
+    }
+
+    for (polygonType& index : indices) {
+      if (index >= vertices_count) {
+        throw std::runtime_error("Corupted format of GLTF file");
+      }
+      index += first_vertex;
+    }
+
+    size_t triangles_count = indices.size() / 3;
+    if (mode != kModeTriangles) {
+      triangles_count = (indices.size() < 3) ? 0 : indices.size() - 2;
+    }
+    mesh_out.polygons.reserve(mesh_out.polygons.size() + triangles_count * 6);
+
+    for (size_t j = 0; j < triangles_count; ++j) {
+      polygonType face[3];
+
+      if (mode == kModeTriangles) {
+        face[0] = indices[j * 3];
+        face[1] = indices[j * 3 + 1];
+        face[2] = indices[j * 3 + 2];
+      } else if (mode == kModeTriangleStrip) {
+        face[0] = indices[j];
+        face[1] = indices[j + 1 + j % 2];
+        face[2] = indices[j + 2 - j % 2];
+      } else {
+        face[0] = indices[0];
+        face[1] = indices[j + 1];
+        face[2] = indices[j + 2];
+      }
+
+      AppendPolygonEdges(face, 3, mesh_out.polygons);
+    }
+
+    face_count += triangles_count;
+  }
+
+  return face_count;
+}
+
+size_t ParserListGLTF::ReadPositions(size_t accessor_index,
+                                     std::vector<vertexType>& vertices_out) {
+  const JsonValue& accessor = this->document_["accessors"][accessor_index];
+  const JsonValue& view =
+      this->document_["bufferViews"][accessor["bufferView"].AsIndex()];
+  size_t count = ParseIndex(accessor["count"]);
+  const size_t kVertexSize = 3 * sizeof(vertexType);
+
+  if (view.GetType() != JsonValue::kObject ||
+      accessor["componentType"].AsNumber() != kComponentFloat ||
+      accessor["type"].AsString() != "VEC3") {
+    throw std::runtime_error("Unsupported accessor of GLTF file");
+  }
+
+  size_t buffer_index = 0;
+  uint64_t begin = 0;
+  uint64_t length = this->CheckView(view, buffer_index, begin);
+  uint64_t offset = ParseIndex(accessor["byteOffset"], 0);
+  uint64_t stride = ParseIndex(view["byteStride"], kVertexSize);
+  uint64_t available = (offset > length) ? 0 : length - offset;
+
+  // Count is checked by the view before the size, which could overflow
+  if (stride < kVertexSize ||
+      (count != 0 && (available < kVertexSize ||
+                      count - 1 > (available - kVertexSize) / stride))) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  uint64_t size = (count == 0) ? 0 : (count - 1) * stride + kVertexSize;
+  begin += offset;
+
+  size_t first_value = vertices_out.size();
+  vertices_out.resize(first_value + count * 3);
+  char* vertices_p = reinterpret_cast<char*>(vertices_out.data() + first_value);
+
+  if (stride == kVertexSize) {
+    // Layout of buffer is equal to layout of vertices, read all at once
+    this->ReadBuffer(buffer_index, begin, size, vertices_p);
+
+  } else {
+    char* interleaved = this->arena_->AllocateArray<char>(size);
+    this->ReadBuffer(buffer_index, begin, size, interleaved);
+
+    for (size_t i = 0; i < count; ++i) {
+      std::memcpy(vertices_p + i * kVertexSize, interleaved + i * stride,
+                  kVertexSize);
+    }
+  }
+
+  return count;
+}
+
+void ParserListGLTF::ReadIndices(size_t accessor_index,
+                                 std::vector<polygonType>& indices_out) {
+  const JsonValue& accessor = this->document_["accessors"][accessor_index];
+  const JsonValue& view =
+      this->document_["bufferViews"][accessor["bufferView"].AsIndex()];
+  size_t count = ParseIndex(accessor["count"]);
+  size_t component_type = ParseIndex(accessor["componentType"], 0);
+  size_t component_size = 0;
+
+  if (component_type == kComponentUInt8) {
+    component_size = 1;
+  } else if (component_type == kComponentUInt16) {
+    component_size = 2;
+  } else if (component_type == kComponentUInt32) {
+    component_size = 4;
+  }
+
+  if (view.GetType() != JsonValue::kObject || component_size == 0 ||
+      accessor["type"].AsString() != "SCALAR") {
+    throw std::runtime_error("Unsupported accessor of GLTF file");
+  }
+
+  size_t buffer_index = 0;
+  uint64_t begin = 0;
+  uint64_t length = this->CheckView(view, buffer_index, begin);
+
+  // Count is below 2^53, the size does not overflow
+  uint64_t size = count * component_size;
+  uint64_t offset = ParseIndex(accessor["byteOffset"], 0);
+  if (offset + size > length) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  unsigned char* data = this->arena_->AllocateArray<unsigned char>(size);
+  this->ReadBuffer(buffer_index, begin + offset, size,
+                   reinterpret_cast<char*>(data));
+
+  indices_out.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (component_size == 1) {
+      indices_out[i] = data[i];
+    } else if (component_size == 2) {
+      uint16_t index;
+      std::memcpy(&index, data + i * 2, sizeof(index));
+      indices_out[i] = index;
+    } else {
+      uint32_t index;
+      std::memcpy(&index, data + i * 4, sizeof(index));
+      indices_out[i] = index;
+    }
+  }
+}
+
+uint64_t ParserListGLTF::CheckView(const JsonValue& view, size_t& buffer_out,
+                                   uint64_t& begin_out) {
+  buffer_out = ParseIndex(view["buffer"]);
+  begin_out = ParseIndex(view["byteOffset"], 0);
+  uint64_t length = ParseIndex(view["byteLength"]);
+
+  // Values are below 2^53, the sum does not overflow
+  if (buffer_out >= this->buffers_.size() ||
+      begin_out + length > this->buffers_[buffer_out].size) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  return length;
+}
+
+void ParserListGLTF::ReadBuffer(size_t buffer_index, uint64_t offset,
+                                uint64_t size, char* data_out) {
+  if (buffer_index >= this->buffers_.size() ||
+      offset + size > this->buffers_[buffer_index].size) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  GltfBuffer& buffer = this->buffers_[buffer_index];
+
+  if (buffer.file) {
+    buffer.file->clear();
+    buffer.file->seekg(buffer.offset + offset, std::ios::beg);
+    buffer.file->read(data_out, size);
+
+    if (!*buffer.file) {
+      throw std::runtime_error("Corupted format of GLTF file");
+    }
+
+  } else {
+    std::memcpy(data_out, buffer.memory.data() + offset, size);
+  }
+}
+
+size_t ParserListGLTF::ParseIndex(const JsonValue& value,
+                                  size_t default_value) {
+  size_t index = value.AsIndex(default_value);
+
+  if (index == JsonValue::kNoIndex) {
+    throw std::runtime_error("Corupted format of GLTF file");
+  }
+
+  return index;
+}
+
+AffineTransform ParserListGLTF::NodeTransform(const JsonValue& node) {
+  AffineTransform transform;
+
+  if (node.Has("matrix")) {
+    // Column major 4x4 matrix
+    const JsonValue& matrix = node["matrix"];
+    for (unsigned row = 0; row < 3; ++row) {
+      for (unsigned col = 0; col < 4; ++col) {
+        transform(row, col) = matrix[col * 4 + row].AsNumber(row == col);
+      }
+    }
+
+  } else {
+    const JsonValue& rotation = node["rotation"];
+    double x = rotation[0].AsNumber(0), y = rotation[1].AsNumber(0);
+    double z = rotation[2].AsNumber(0), w = rotation[3].AsNumber(1);
+    double rotation_matrix[3][3] = {
+        {1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)},
+        {2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)},
+        {2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)}};
+
+    for (unsigned row = 0; row < 3; ++row) {
+      for (unsigned col = 0; col < 3; ++col) {
+        transform(row, col) =
+            rotation_matrix[row][col] * node["scale"][col].AsNumber(1);
+      }
+      transform(row, 3) = node["translation"][row].AsNumber(0);
+    }
+  }
+
+  return transform;
+}
+
+std::vector<char> ParserListGLTF::DecodeBase64(const std::string& text) {
+  std::vector<char> result;
+  result.reserve(text.size() * 3 / 4);
+  uint32_t accumulator = 0;
+  int bits = 0;
+
+  for (char symbol : text) {
+    int value = -1;
+
+    if (symbol >= 'A' && symbol <= 'Z') {
+      value = symbol - 'A';
+    } else if (symbol >= 'a' && symbol <= 'z') {
+      value = symbol - 'a' + 26;
+    } else if (symbol >= '0' && symbol <= '9') {
+      value = symbol - '0' + 52;
+    } else if (symbol == '+') {
+      value = 62;
+    } else if (symbol == '/') {
+      value = 63;
+    }
+
+    if (value >= 0) {
+      accumulator = (accumulator << 6) | value;
+      bits += 6;
+
+      if (bits >= 8) {
+        bits -= 8;
+        result.push_back(char((accumulator >> bits) & 0xFF));
+      }
+    }
+  }
+
+  return result;
+}
+}  // namespace ModelViewer3D
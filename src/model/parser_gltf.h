@@ -0,0 +1,149 @@
+/** @file
+ * @brief Declaration of ParserListGLTF class
+ */
+#ifndef SRC_MODEL_PARSER_GLTF_H_
+#define SRC_MODEL_PARSER_GLTF_H_
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/affine_transform.h"
+#include "model/json_value.h"
+#include "model/parser_list.h"
+
+namespace ModelViewer3D {
+/** @brief Part of linked list struct for parse files with gltf 2.0 format,
+ * both json .gltf and binary .glb
+ * Tightly packed float positions are read from the file straight into the
+ * vertex array, without intermediate buffers
+ */
+class ParserListGLTF : public ParserList {
+ protected:
+  /** @brief Check the file starts with glb magic or is a json with gltf
+   * asset description
+   * @param[in] probe Opened file with the read header
+   */
+  bool Accepts(const FileProbe& probe) override;
+
+  /** @brief Parse meshes of the default scene of gltf or glb file
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  bool ParseConcrete(FileProbe& probe, MeshData& mesh_out) override;
+
+ private:
+  /** @brief Data of gltf buffer, which is a region of a file or decoded
+   * data uri
+   */
+  struct GltfBuffer {
+    std::istream* file = nullptr;
+    std::unique_ptr<std::ifstream> own_file;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::vector<char> memory;
+  };
+
+  /** @brief SubMethod for read glb container
+   * @param[in, out] file Opened glb file
+   * @param file_size Size of the file for check lengths of chunks
+   * @param[out] json_size Size of the json chunk
+   * @param[out] bin_offset Offset of the binary chunk data in file
+   * @param[out] bin_size Size of the binary chunk data, zero if there is no
+   * binary chunk
+   * @return Text of the json chunk in the arena
+   * @throw runtime_error
+   */
+  const char* ReadGlb(std::istream& file, uint64_t file_size,
+                      size_t& json_size, uint64_t& bin_offset,
+                      uint64_t& bin_size);
+
+  /** @brief SubMethod for open buffers declared in json
+   * @param[in] filename Path to gltf file for resolve relative uris
+   * @param[in] file Opened gltf file
+   * @param bin_offset Offset of the binary chunk data of glb
+   * @param bin_size Size of the binary chunk data of glb
+   * @throw runtime_error
+   */
+  void OpenBuffers(const std::string& filename, std::istream& file,
+                   uint64_t bin_offset, uint64_t bin_size);
+
+  /** @brief SubMethod for walk the node hierarchy and parse meshes of nodes
+   * @param node_index Index of node
+   * @param[in] parent Transform of the parent node
+   * @param depth Nesting depth for protection of the stack
+   * @param[out] mesh_out Structure for store the model
+   * @return Count of parsed triangles
+   * @throw runtime_error
+   */
+  size_t ParseNode(size_t node_index, const AffineTransform& parent,
+                   int depth, MeshData& mesh_out);
+
+  /** @brief SubMethod for parse all primitives of mesh
+   * @param mesh_index Index of mesh
+   * @param[in] transform Transform of the node with the mesh
+   * @param[out] mesh_out Structure for store the model
+   * @return Count of parsed triangles
+   * @throw runtime_error
+   */
+  size_t ParseMesh(size_t mesh_index, const AffineTransform& transform,
+                   MeshData& mesh_out);
+
+  /** @brief SubMethod for read positions accessor into vertex array
+   * @param accessor_index Index of accessor
+   * @param[out] vertices_out Vector for store vertices
+   * @return Count of read vertices
+   * @throw runtime_error
+   */
+  size_t ReadPositions(size_t accessor_index,
+                       std::vector<vertexType>& vertices_out);
+
+  /** @brief SubMethod for read indices accessor
+   * @param accessor_index Index of accessor
+   * @param[out] indices_out Vector for store indices
+   * @throw runtime_error
+   */
+  void ReadIndices(size_t accessor_index,
+                   std::vector<polygonType>& indices_out);
+
+  /** @brief SubMethod for check the buffer view fits into its buffer, so
+   * accessors bounded by the view are allocated by real data only
+   * @param[in] view Buffer view
+   * @param[out] buffer_out Index of the buffer
+   * @param[out] begin_out Offset of the view in the buffer
+   * @return Length of the view
+   * @throw runtime_error
+   */
+  uint64_t CheckView(const JsonValue& view, size_t& buffer_out,
+                     uint64_t& begin_out);
+
+  /** @brief Read bytes of buffer into memory
+   * @throw runtime_error
+   */
+  void ReadBuffer(size_t buffer_index, uint64_t offset, uint64_t size,
+                  char* data_out);
+
+  /** @brief Get the index, count or offset of json value
+   * @param[in] value Value, which is a non negative integral number
+   * @param default_value Value if there is no value
+   * @throw runtime_error
+   */
+  static size_t ParseIndex(const JsonValue& value,
+                           size_t default_value = JsonValue::kNoIndex);
+
+  /** @brief Get the local transform of node */
+  static AffineTransform NodeTransform(const JsonValue& node);
+
+  /** @brief Decode base64 text of data uri */
+  static std::vector<char> DecodeBase64(const std::string& text);
+
+  JsonValue document_;
+  std::vector<GltfBuffer> buffers_;
+  // Nodes of the scene which are already parsed
+  std::vector<bool> visited_nodes_;
+};  // ParserListGLTF
+}  // namespace  ModelViewer3D
+#endif  // SRC_MODEL_PARSER_GLTF_H_
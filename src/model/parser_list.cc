@@ -21,13 +21,55 @@ ParserList::~ParserList() {
 
 void ParserList::SetNext(ParserList* next) { this->next_ = next; }
 
+void ParserList::SetMemoryBudget(size_t memory_budget) {
+  this->memory_budget_ = memory_budget;
+
+  if (this->next_) {
+    this->next_->SetMemoryBudget(memory_budget);
+  }
+}
+
+void ParserList::SetArena(Arena* arena) {
+  this->arena_ = arena;
+
+  if (this->next_) {
+    this->next_->SetArena(arena);
+  }
+}
+
+void ParserList::AppendPolygonEdges(const polygonType* face, size_t size,
+                                    std::vector<polygonType>& polygons_out) {
+  for (size_t i = 0; i < size; ++i) {
+    polygons_out.push_back(face[i]);
+    polygons_out.push_back(face[(i + 1) % size]);
+  }
+}
+
 void ParserList::Parse(std::string filename,
                        std::vector<vertexType>& vertices_out,
                        std::vector<polygonType>& polygons_out,
                        uint64_t& edges_count_out) {
-  if (ParseConcrete(filename, vertices_out, polygons_out, edges_count_out)) {
+  MeshData mesh;
+  mesh.vertices.swap(vertices_out);
+  mesh.polygons.swap(polygons_out);
+  mesh.edges_count = edges_count_out;
+
+  this->Parse(filename, mesh);
+
+  vertices_out.swap(mesh.vertices);
+  polygons_out.swap(mesh.polygons);
+  edges_count_out = mesh.edges_count;
+}
+
+void ParserList::Parse(std::string filename, MeshData& mesh_out) {
+  FileProbe probe(filename);
+  this->Parse(probe, mesh_out);
+}
+
+void ParserList::Parse(FileProbe& probe, MeshData& mesh_out) {
+  if (!Accepts(probe) || ParseConcrete(probe, mesh_out)) {
     if (this->next_) {
-      this->next_->Parse(filename, vertices_out, polygons_out, edges_count_out);
+      this->next_->Parse(probe, mesh_out);
     } else {
       throw std::runtime_error("No parser for this filetype");
     }
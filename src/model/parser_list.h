@@ -7,6 +7,9 @@
 #include <string>
 #include <vector>
 
+#include "model/arena.h"
+#include "model/file_probe.h"
+#include "model/mesh_data.h"
 #include "model/model_types.h"
 
 namespace ModelViewer3D {
@@ -29,18 +32,64 @@ class ParserList {
   void Parse(std::string filename, std::vector<vertexType>& vertices_out,
              std::vector<polygonType>& polygons_out, uint64_t& edges_count_out);
 
+  /** @brief Call a next parser in a chain or throw exception
+   * @param[in] filename Path to file
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  void Parse(std::string filename, MeshData& mesh_out);
+
+  /** @brief Pass the probed file along the chain up to the parser which
+   * accepts its content, or throw exception
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  void Parse(FileProbe& probe, MeshData& mesh_out);
+
   /** @brief Set next parses into chain
    * @param[in] next class inherited from it's
    */
   void SetNext(ParserList* next);
 
+  /** @brief Set the memory budget of parse for this and next parsers
+   * @param memory_budget Size in bytes, after which the parser buffers are
+   * moved to temporary files, zero for unlimited
+   */
+  void SetMemoryBudget(size_t memory_budget);
+
+  /** @brief Set the arena for scratch memory of this and next parsers
+   * @param arena Arena, which is released by the owner after each load
+   */
+  void SetArena(Arena* arena);
+
  protected:
   ParserList* next_ = nullptr;
+  size_t memory_budget_ = 0;
+  Arena* arena_ = nullptr;
+
+  /** @brief Append edges of the closed polygon as consecutive pairs of
+   * indices
+   * @param[in] face Indices of the polygon vertices
+   * @param size Count of the polygon vertices
+   * @param[out] polygons_out Vector for store polygon indices
+   */
+  static void AppendPolygonEdges(const polygonType* face, size_t size,
+                                 std::vector<polygonType>& polygons_out);
 
-  virtual bool ParseConcrete(std::string filename,
-                             std::vector<vertexType>& vertices_out,
-                             std::vector<polygonType>& polygons_out,
-                             uint64_t& edges_count_out) = 0;
+  /** @brief Check the file has a format of the concrete parser by its
+   * header, without access to the file
+   * @param[in] probe Opened file with the read header
+   */
+  virtual bool Accepts(const FileProbe& probe) = 0;
+
+  /** @brief Parse the file accepted by the concrete parser
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @return true if the file is not for this parser after all
+   * @throw runtime_error
+   */
+  virtual bool ParseConcrete(FileProbe& probe, MeshData& mesh_out) = 0;
 };  // ParserList
 }  // namespace  ModelViewer3D
 #endif  // SRC_MODEL_PARSER_LIST_H_
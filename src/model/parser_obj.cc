@@ -5,140 +5,410 @@
 
 #include "model/parser_obj.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 #if DEBUG == 1
 #include <iostream>
 #endif  // DEBUG == 1
 
 #include "model/model_types.h"
+#include "model/number_parser.h"
 
 namespace ModelViewer3D {
-bool ParserListOBJ::ParseConcrete(std::string filename,
-                                  std::vector<vertexType>& vertices_out,
-                                  std::vector<polygonType>& polygons_out,
-                                  uint64_t& edges_count_out) {
+bool ParserListOBJ::Accepts(const FileProbe& probe) {
+  const std::string& header = probe.GetHeader();
+
+  if (header.find('\0') != std::string::npos) {
+    return false;
+  }
+
+  // The last line of the header may be cut
+  size_t checked_size = header.size();
+  if (!probe.IsWholeFile()) {
+    size_t last_line_end = header.rfind('\n');
+    checked_size = (last_line_end == std::string::npos) ? 0 : last_line_end;
+  }
+
+  // Text with a vertex or face line is obj whatever other lines are, text
+  // without them is obj if all its lines are obj statements
+  bool is_statements = true;
+
+  for (size_t line_begin = 0; line_begin < header.size();) {
+    size_t line_end = std::min(header.find('\n', line_begin), header.size());
+    const char* line_p = header.data() + line_begin;
+    const char* end_p = header.data() + line_end;
+
+    while (line_p != end_p && isspace(*line_p)) {
+      line_p++;
+    }
+
+    if (end_p - line_p >= 2 && (line_p[0] == 'v' || line_p[0] == 'f') &&
+        isspace(line_p[1])) {
+      return true;
+    }
+
+    if (line_end <= checked_size) {
+      is_statements = is_statements && IsStatement(line_p, end_p);
+    }
+    line_begin = line_end + 1;
+  }
+
+  return is_statements;
+}
+
+bool ParserListOBJ::IsStatement(const char* line_p, const char* end_p) {
+  static const char* const kKeywords[] = {
+      "v",     "vt",     "vn",       "vp",       "f",         "l",
+      "p",     "o",      "g",        "s",        "mg",        "mtllib",
+      "usemtl", "usemap", "maplib",  "cstype",   "deg",       "bmat",
+      "step",  "curv",   "curv2",    "surf",     "parm",      "trim",
+      "hole",  "scrv",   "sp",       "end",      "con",       "bevel",
+      "c_interp", "d_interp", "lod", "shadow_obj", "trace_obj", "ctech",
+      "stech", "call",   "csh"};
+
+  while (line_p != end_p && isspace(*line_p)) {
+    line_p++;
+  }
+
+  const char* token_end = line_p;
+  while (token_end != end_p && !isspace(*token_end)) {
+    token_end++;
+  }
+
+  bool is_statement = line_p == end_p || *line_p == '#';
+
+  for (const char* keyword : kKeywords) {
+    if (!is_statement && size_t(token_end - line_p) == strlen(keyword) &&
+        std::strncmp(line_p, keyword, token_end - line_p) == 0) {
+      is_statement = true;
+    }
+  }
+
+  return is_statement;
+}
+
+bool ParserListOBJ::ParseConcrete(FileProbe& probe, MeshData& mesh_out) {
 #if DEBUG == 1
   std::cout << "Parse method of ParserListOBJ @" << this << std::endl;
 #endif  // DEBUG == 1
-  bool is_error = false;
   size_t face_count = 0;
+  size_t first_polygon = mesh_out.polygons.size();
+  SpillBuffer<vertexType> vertices(this->memory_budget_);
+  SpillBuffer<polygonType> polygons(this->memory_budget_);
+  this->relative_indices_.clear();
+  this->max_index_ = 0;
+  this->tex_coord_corners_ = CornerIndices();
+  this->normal_corners_ = CornerIndices();
+
+  // Second pass over compressed file costs a second decompression
+  if (!probe.IsCompressed()) {
+    ObjCounts counts;
+    this->PreScan(probe.Rewind(), counts);
+    vertices.reserve(counts.vertices * 3);
+    polygons.reserve(counts.polygon_indices);
+    mesh_out.tex_coords.reserve(mesh_out.tex_coords.size() +
+                                counts.tex_coords * 2);
+    mesh_out.normals.reserve(mesh_out.normals.size() + counts.normals * 3);
+  }
+
+  std::istream& file = probe.Rewind();
+  std::string line;
 
-  // Check the file extension - non zero is bad
-  if (filename.compare(filename.rfind('.'), 4, std::string(".obj")) != 0) {
-    is_error = true;
+  while (std::getline(file, line)) {
+    if (this->ParseStatement(line, vertices, polygons, first_polygon,
+                             mesh_out)) {
+      ++face_count;
+    }
   }
 
-  std::vector<int64_t> tmp_polygons;
+  int64_t vertices_size = (mesh_out.vertices.size() + vertices.size()) / 3;
+  this->PostProcessing(vertices_size, polygons);
+  std::vector<std::pair<size_t, int64_t>>().swap(this->relative_indices_);
+
+  vertices.MoveTo(mesh_out.vertices);
+  polygons.MoveTo(mesh_out.polygons);
 
-  if (!is_error) {
-    std::ifstream file(filename);
+  size_t corners_count = mesh_out.polygons.size() / 2;
+  ResolveCornerIndices(mesh_out.tex_coords.size() / 2, corners_count,
+                       mesh_out.tex_coord_indices, this->tex_coord_corners_);
+  ResolveCornerIndices(mesh_out.normals.size() / 3, corners_count,
+                       mesh_out.normal_indices, this->normal_corners_);
+
+  if (face_count != 0) {
+    mesh_out.edges_count = vertices_size + face_count - 2;
+  }
 
-    if (file.fail()) {
-      is_error = true;
+  if (!mesh_out.groups.empty()) {
+    MeshGroup& last_group = mesh_out.groups.back();
+    last_group.indices_count =
+        mesh_out.polygons.size() - last_group.first_index;
+  }
 
 #if DEBUG == 1
-      std::perror("ERROR on file open: ");
+  std::cout << "Parsed file: " << probe.GetFilename() << std::endl;
+  std::cout << "Count of vertices: " << vertices_size << std::endl;
+  std::cout << "Count of face indices in array: " << mesh_out.polygons.size()
+            << std::endl;
+  std::cout << "\nFace indices:\n\t";
+  for (auto el : mesh_out.polygons) {
+    std::cout << el << " ";
+  }
+  std::cout << std::endl;
 #endif  // DEBUG == 1
+
+  return false;
+}
+
+bool ParserListOBJ::ParseStatement(std::string& line,
+                                   SpillBuffer<vertexType>& vertices,
+                                   SpillBuffer<polygonType>& polygons,
+                                   size_t first_polygon, MeshData& mesh_out) {
+  char* line_p = line.data();
+  const char* end_p = line.data() + line.size();
+  bool is_face = false;
+
+  switch (line_p[0]) {
+    case 'v':
+      ++line_p;
+      if (*line_p == 't') {
+        this->ParseTexCoord(++line_p, end_p, mesh_out.tex_coords);
+      } else if (*line_p == 'n') {
+        this->ParseNormal(++line_p, end_p, mesh_out.normals);
+      } else {
+        this->ParseVertex(line_p, end_p, vertices);
+      }
+      break;
+
+    case 'f':
+      this->ParsePolygon(++line_p, (first_polygon + polygons.size()) / 2,
+                         polygons, mesh_out);
+      is_face = true;
+      break;
+
+    case 'o':
+    case 'g':
+      if (isspace(line_p[1])) {
+        this->ParseGroup(++line_p, false, first_polygon + polygons.size(),
+                         mesh_out.groups);
+      }
+      break;
+
+    case 'u':
+      if (line.compare(0, 6, "usemtl") == 0 && isspace(line_p[6])) {
+        this->ParseGroup(line_p + 6, true, first_polygon + polygons.size(),
+                         mesh_out.groups);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return is_face;
+}
+
+void ParserListOBJ::PreScan(std::istream& file, ObjCounts& counts_out) {
+  // One byte is reserved for line feed after the last line
+  size_t capacity = Arena::kBlockSize / 2;
+  char* block = this->arena_->AllocateArray<char>(capacity + 1);
+  size_t tail_size = 0;
+
+  while (file) {
+    if (tail_size == capacity) {
+      // Line is longer than the block
+      char* large_block = this->arena_->AllocateArray<char>(capacity * 2 + 1);
+      std::memcpy(large_block, block, tail_size);
+      block = large_block;
+      capacity *= 2;
     }
 
-    std::string line;
+    file.read(block + tail_size, capacity - tail_size);
+    size_t block_size = tail_size + file.gcount();
+    if (!file) {
+      // The last line of file may have no line feed
+      block[block_size++] = '\n';
+    }
 
-    while (!is_error && std::getline(file, line)) {
-      char* line_p = line.data();
+    const char* line_p = block;
+    const char* block_end = block + block_size;
+    const char* line_end;
 
-      switch (line_p[0]) {
-        case 'v':
-          this->ParseVertex(++line_p, vertices_out);
-          break;
+    // Search of line feed by memchr is vectorized by the C library
+    while ((line_end = static_cast<const char*>(
+                std::memchr(line_p, '\n', block_end - line_p)))) {
+      CountStatement(line_p, line_end, counts_out);
+      line_p = line_end + 1;
+    }
 
-        case 'f':
-          this->ParsePolygon(++line_p, tmp_polygons);
-          ++face_count;
-          break;
+    tail_size = block_end - line_p;
+    std::memmove(block, line_p, tail_size);
+  }
+}
 
-        default:
-          break;
-      }
+void ParserListOBJ::CountStatement(const char* line_p, const char* end_p,
+                                   ObjCounts& counts_out) {
+  if (end_p - line_p < 2) {
+    return;
+  }
+
+  if (line_p[0] == 'v') {
+    if (isspace(line_p[1])) {
+      ++counts_out.vertices;
+    } else if (line_p[1] == 't') {
+      ++counts_out.tex_coords;
+    } else if (line_p[1] == 'n') {
+      ++counts_out.normals;
+    }
+
+  } else if (line_p[0] == 'f' && isspace(line_p[1])) {
+    // Each vertex of polygon gives two indices of edges
+    bool is_space = true;
+    for (++line_p; line_p != end_p; ++line_p) {
+      bool is_separator = *line_p == ' ' || *line_p == '\t' || *line_p == '\r';
+      counts_out.polygon_indices += (is_space && !is_separator) ? 2 : 0;
+      is_space = is_separator;
     }
   }
+}
+
+void ParserListOBJ::ParseVertex(const char* line_p, const char* end_p,
+                                SpillBuffer<vertexType>& vertices_out) {
+  if (!isspace(*line_p)) {
+    return;
+  }
+
+  vertexType vertex[3];
 
-  if (!is_error) {
-    int64_t vertices_size = vertices_out.size() / 3;
-    this->PostProcessing(vertices_size, tmp_polygons, polygons_out);
+  for (int i = 0; i < 3; ++i) {
+    const char* number_end = ParseFloat(line_p, end_p, vertex[i]);
 
-    if (face_count != 0) {
-      edges_count_out = (vertices_out.size() / 3) + face_count - 2;
+    if (number_end == line_p) {
+      throw std::runtime_error("Invalid format of OBJ file");
     }
+    line_p = number_end;
   }
 
-#if DEBUG == 1
-  std::cout << "Parsed file: " << filename << std::endl;
-  std::cout << "Count of vertices: " << vertices_out.size() / 3 << std::endl;
-  std::cout << "Count of face indices in array: " << polygons_out.size()
-            << std::endl;
-  std::cout << "Count of tmp face indices in array: " << tmp_polygons.size()
-            << std::endl;
-  std::cout << "\nFace indices:\n\t";
-  for (auto el : polygons_out) {
-    std::cout << el << " ";
+  vertices_out.push_back(vertex[0]);
+  vertices_out.push_back(vertex[1]);
+  vertices_out.push_back(vertex[2]);
+}
+
+void ParserListOBJ::ParseTexCoord(const char* line_p, const char* end_p,
+                                  std::vector<vertexType>& tex_coords_out) {
+  if (!isspace(*line_p)) {
+    return;
   }
-  std::cout << std::endl;
 
-  std::cout << "\nTMP Face indices:\n\t";
-  for (auto el : tmp_polygons) {
-    std::cout << el << " ";
+  vertexType u = 0;
+  const char* number_end = ParseFloat(line_p, end_p, u);
+
+  if (number_end == line_p) {
+    throw std::runtime_error("Invalid format of OBJ file");
   }
-  std::cout << std::endl;
-#endif  // DEBUG == 1
 
-  return is_error;
+  // V coordinate is optional and zero by default
+  vertexType v = 0;
+  ParseFloat(number_end, end_p, v);
+
+  tex_coords_out.push_back(u);
+  tex_coords_out.push_back(v);
 }
 
-void ParserListOBJ::ParseVertex(char* line_p,
-                                std::vector<vertexType>& vertices_out) {
+void ParserListOBJ::ParseNormal(const char* line_p, const char* end_p,
+                                std::vector<vertexType>& normals_out) {
   if (!isspace(*line_p)) {
     return;
   }
 
-  vertexType x, y, z;
-  std::istringstream line_stream(line_p);
-  line_stream >> x >> y >> z;
+  for (int i = 0; i < 3; ++i) {
+    vertexType component = 0;
+    const char* number_end = ParseFloat(line_p, end_p, component);
+
+    if (number_end == line_p) {
+      throw std::runtime_error("Invalid format of OBJ file");
+    }
+
+    normals_out.push_back(component);
+    line_p = number_end;
+  }
+}
+
+void ParserListOBJ::ParseGroup(char* line_p, bool is_material,
+                               size_t first_index,
+                               std::vector<MeshGroup>& groups_out) {
+  while (isspace(*line_p)) {
+    line_p++;
+  }
+
+  char* end_p = line_p + strlen(line_p);
+  while (end_p != line_p && isspace(*(end_p - 1))) {
+    end_p--;
+  }
+
+  MeshGroup group;
+  if (!groups_out.empty()) {
+    group.name = groups_out.back().name;
+    group.material = groups_out.back().material;
+  }
+
+  (is_material ? group.material : group.name).assign(line_p, end_p);
+  group.first_index = first_index;
 
-  if (!line_stream.fail()) {
-    vertices_out.push_back(x);
-    vertices_out.push_back(y);
-    vertices_out.push_back(z);
+  // Names which follow each other without faces describe the same range
+  if (!groups_out.empty() && groups_out.back().first_index == first_index) {
+    groups_out.back() = group;
 
   } else {
-    throw std::runtime_error("Invalid format of OBJ file");
+    if (!groups_out.empty()) {
+      groups_out.back().indices_count =
+          first_index - groups_out.back().first_index;
+    }
+
+    groups_out.push_back(group);
   }
 }
 
-void ParserListOBJ::ParsePolygon(char* line_p,
-                                 std::vector<int64_t>& polygons_out) {
+void ParserListOBJ::ParsePolygon(char* line_p, size_t first_corner,
+                                 SpillBuffer<polygonType>& polygons_out,
+                                 MeshData& mesh_out) {
   if (!isspace(*line_p)) {
     throw std::runtime_error("Corupted format of OBJ file");
   }
 
+  size_t corner = first_corner;
   bool is_first_found = false;
   int64_t current_index, first_index = 0;
 
   while (*line_p != '\0') {
     if (isdigit(*line_p) || *line_p == '-') {
-      current_index = std::strtol(line_p, &line_p, 0);
+      current_index = std::strtol(line_p, &line_p, 10);
 
       if (!is_first_found) {
         first_index = current_index;
         is_first_found = true;
-        polygons_out.push_back(current_index);
+        this->PushIndex(current_index, polygons_out);
 
       } else {
-        polygons_out.push_back(current_index);
-        polygons_out.push_back(current_index);
+        this->PushIndex(current_index, polygons_out);
+        this->PushIndex(current_index, polygons_out);
       }
 
+      // Texture coordinate and normal of the corner follow after slashes
+      if (*line_p == '/' && (isdigit(*++line_p) || *line_p == '-')) {
+        PushCornerIndex(std::strtol(line_p, &line_p, 10),
+                        mesh_out.tex_coords.size() / 2, corner,
+                        mesh_out.tex_coord_indices, this->tex_coord_corners_);
+      }
+      if (*line_p == '/' && (isdigit(*++line_p) || *line_p == '-')) {
+        PushCornerIndex(std::strtol(line_p, &line_p, 10),
+                        mesh_out.normals.size() / 3, corner,
+                        mesh_out.normal_indices, this->normal_corners_);
+      }
+      ++corner;
+
       while (*line_p != '\0' && !isspace(*line_p)) {
         line_p++;
       }
@@ -148,35 +418,89 @@ void ParserListOBJ::ParsePolygon(char* line_p,
     }
   }
 
-  polygons_out.push_back(first_index);
+  this->PushIndex(first_index, polygons_out);
 }
 
-void ParserListOBJ::PostProcessing(int64_t vertices_size,
-                                   std::vector<int64_t>& tmp_polygons,
-                                   std::vector<polygonType>& polygons_out) {
-  bool is_error = false;
+void ParserListOBJ::PushIndex(int64_t index,
+                              SpillBuffer<polygonType>& polygons_out) {
+  if (index == 0) {
+    throw std::runtime_error("Corupted format of OBJ file");
+  }
 
-  for (int64_t el : tmp_polygons) {
-    if (el == 0 || el > vertices_size) {
-      is_error = true;
-    }
+  if (index > 0) {
+    // Final form is known at once, the range is checked after parse
+    this->max_index_ = std::max(this->max_index_, index);
+    polygons_out.push_back(index - 1);
 
-    if (el < 0) {
-      el = vertices_size + el;
+  } else {
+    this->relative_indices_.emplace_back(polygons_out.size(), index);
+    polygons_out.push_back(0);
+  }
+}
+
+void ParserListOBJ::PushCornerIndex(int64_t index, size_t count,
+                                    size_t corner,
+                                    std::vector<polygonType>& indices_out,
+                                    CornerIndices& corners) {
+  if (indices_out.size() < corner) {
+    indices_out.resize(corner, MeshData::kNoIndex);
+  }
 
-      if (el < 0) {
-        is_error = true;
+  if (index == 0) {
+    indices_out.push_back(MeshData::kNoIndex);
+
+  } else if (index > 0) {
+    corners.max_index = std::max(corners.max_index, index);
+    indices_out.push_back(index - 1);
+
+  } else {
+    // Negative index counts back from the last attribute before the line
+    corners.relative.emplace_back(indices_out.size(), int64_t(count) + index);
+    indices_out.push_back(MeshData::kNoIndex);
+  }
+}
+
+void ParserListOBJ::ResolveCornerIndices(
+    int64_t count, size_t corners_count,
+    std::vector<polygonType>& indices_out, CornerIndices& corners) {
+  // Vertices are enough to draw the face, so broken indices of other
+  // attributes are dropped instead of rejecting the file
+  if (corners.max_index > count) {
+    for (polygonType& index : indices_out) {
+      if (index != MeshData::kNoIndex && index >= count) {
+        index = MeshData::kNoIndex;
       }
+    }
+  }
 
-    } else {
-      el -= 1;
+  for (const std::pair<size_t, int64_t>& relative : corners.relative) {
+    if (relative.second >= 0) {
+      indices_out[relative.first] = relative.second;
     }
+  }
+
+  if (!indices_out.empty() && indices_out.size() < corners_count) {
+    indices_out.resize(corners_count, MeshData::kNoIndex);
+  }
 
-    if (is_error) {
+  corners = CornerIndices();
+}
+
+void ParserListOBJ::PostProcessing(int64_t vertices_size,
+                                   SpillBuffer<polygonType>& polygons_out) {
+  if (this->max_index_ > vertices_size) {
+    throw std::runtime_error("Corupted format of OBJ file");
+  }
+
+  // Negative indices count from the end of the whole vertex list
+  for (const std::pair<size_t, int64_t>& relative : this->relative_indices_) {
+    int64_t el = vertices_size + relative.second;
+
+    if (el < 0) {
       throw std::runtime_error("Corupted format of OBJ file");
     }
 
-    polygons_out.push_back(el);
+    polygons_out[relative.first] = el;
   }
 }
 }  // namespace ModelViewer3D
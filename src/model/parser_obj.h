@@ -9,44 +9,177 @@
 #include <vector>
 
 #include "model/parser_list.h"
+#include "model/spill_buffer.h"
 
 namespace ModelViewer3D {
 /** @brief Part of linked list struct for parse files with obj format */
 class ParserListOBJ : public ParserList {
  protected:
-  /** @brief Parse given file of obj format, load vertices and polygons into
-   * vectors
-   * @param[in] filename Path to file
-   * @param[out] vertices_out Vector for store vertices
-   * @param[out] polygons_out Vector for store polygon indices
+  /** @brief Check the file is a text with a vertex or face line in the
+   * header, or which lines start with obj statements or comments
+   * @param[in] probe Opened file with the read header
+   */
+  bool Accepts(const FileProbe& probe) override;
+
+  /** @brief Parse given file of obj format, load vertices, polygons,
+   * texture coordinates, normals and groups into the mesh arrays
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
    * @throw runtime_error
    */
-  bool ParseConcrete(std::string filename,
-                     std::vector<vertexType>& vertices_out,
-                     std::vector<polygonType>& polygons_out,
-                     uint64_t& edges_count_out) override;
+  bool ParseConcrete(FileProbe& probe, MeshData& mesh_out) override;
+
+  /** @brief Parse one line of obj file
+   * Positive polygon indices are stored in final form, negative ones are
+   * collected in relative_indices_ for resolve after the whole file
+   * @param[in, out] line Line from file without line feed
+   * @param[out] vertices Buffer for store vertices
+   * @param[out] polygons Buffer for store polygon indices
+   * @param first_polygon Count of polygon indices before the buffer
+   * @param[out] mesh_out Structure for store other attributes of the model
+   * @return true if the line is a polygon (face)
+   * @throw runtime_error
+   */
+  bool ParseStatement(std::string& line, SpillBuffer<vertexType>& vertices,
+                      SpillBuffer<polygonType>& polygons,
+                      size_t first_polygon, MeshData& mesh_out);
+
+  /** @brief Indices of texture coordinates or normals of corners, which
+   * are checked after the whole file
+   */
+  struct CornerIndices {
+    // Positions of negative indices and their values counted from the
+    // beginning of the parsed text
+    std::vector<std::pair<size_t, int64_t>> relative;
+    int64_t max_index = 0;
+  };
+
+  /** @brief SubMethod for check the range of corner indices, resolve
+   * negative ones and fill missing indices of the last corners. Indices
+   * out of range are replaced by kNoIndex
+   * @param count Count of texture coordinates or normals
+   * @param corners_count Count of corners of all faces
+   * @param[in, out] indices_out Indices of the attribute per corner
+   * @param[in, out] corners Range and negative indices, they are reset
+   */
+  static void ResolveCornerIndices(int64_t count, size_t corners_count,
+                                   std::vector<polygonType>& indices_out,
+                                   CornerIndices& corners);
+
+  // Positions of negative indices in polygons and the indices themselves
+  std::vector<std::pair<size_t, int64_t>> relative_indices_;
+  int64_t max_index_ = 0;
+  CornerIndices tex_coord_corners_;
+  CornerIndices normal_corners_;
 
  private:
+  /** @brief Check the line is empty, comment or starts with obj keyword
+   * @param[in] line_p Pointer to the beginning of line
+   * @param[in] end_p Pointer to the end of line
+   */
+  static bool IsStatement(const char* line_p, const char* end_p);
+
+  /** @brief Counts of obj statements for allocate all buffers once */
+  struct ObjCounts {
+    size_t vertices = 0;
+    size_t tex_coords = 0;
+    size_t normals = 0;
+    size_t polygon_indices = 0;
+  };
+
+  /** @brief SubMethod for fast pass over file, which counts statements and
+   * vertices of polygons without parse of numbers, the block of file is
+   * taken from the arena
+   * @param[in, out] file Opened file at the beginning
+   * @param[out] counts_out Counts of statements
+   */
+  void PreScan(std::istream& file, ObjCounts& counts_out);
+
+  /** @brief SubMethod for count the line of file
+   * @param[in] line_p Pointer to the beginning of line
+   * @param[in] end_p Pointer to the end of line
+   * @param[out] counts_out Counts of statements
+   */
+  static void CountStatement(const char* line_p, const char* end_p,
+                             ObjCounts& counts_out);
+
   /** @brief SubMethod for parse line with vertices data from file
-   * @param[in, out] line_p Pointer to line from file
+   * @param[in] line_p Pointer to line from file
+   * @param[in] end_p Pointer to the end of line
    * @param[out] vertices_out Vector for store vertices
    * @throw runtime_error
    */
-  void ParseVertex(char* line_p, std::vector<vertexType>& vertices_out);
+  void ParseVertex(const char* line_p, const char* end_p,
+                   SpillBuffer<vertexType>& vertices_out);
+
+  /** @brief SubMethod for parse line with texture coordinates from file
+   * @param[in] line_p Pointer to line from file
+   * @param[in] end_p Pointer to the end of line
+   * @param[out] tex_coords_out Vector for store UV coordinates
+   * @throw runtime_error
+   */
+  void ParseTexCoord(const char* line_p, const char* end_p,
+                     std::vector<vertexType>& tex_coords_out);
+
+  /** @brief SubMethod for parse line with normal data from file
+   * @param[in] line_p Pointer to line from file
+   * @param[in] end_p Pointer to the end of line
+   * @param[out] normals_out Vector for store normals
+   * @throw runtime_error
+   */
+  void ParseNormal(const char* line_p, const char* end_p,
+                   std::vector<vertexType>& normals_out);
 
-  /** @brief SubMethod for parse line with polygon (face) data from file
+  /** @brief SubMethod for parse line with object, group or material name,
+   * which starts a new range of polygon indices
+   * @param[in, out] line_p Pointer to name in the line from file
+   * @param is_material Name is a material of the range
+   * @param first_index Index of the first polygon index of the range
+   * @param[out] groups_out Vector for store groups
+   */
+  void ParseGroup(char* line_p, bool is_material, size_t first_index,
+                  std::vector<MeshGroup>& groups_out);
+
+  /** @brief SubMethod for parse line with polygon (face) data from file,
+   * indices of texture coordinates and normals are kept per corner
    * @param[in, out] line_p Pointer to line from file
-   * @param[out] polygons_out Vector for store polygon indices
+   * @param first_corner Index of the first corner of the face
+   * @param[out] polygons_out Buffer for store polygon indices
+   * @param[out] mesh_out Structure for store indices of corners
+   * @throw runtime_error
+   */
+  void ParsePolygon(char* line_p, size_t first_corner,
+                    SpillBuffer<polygonType>& polygons_out,
+                    MeshData& mesh_out);
+
+  /** @brief SubMethod for store polygon index in final form, negative index
+   * is stored as placeholder until the count of vertices is known
+   * @param index Index from file
+   * @param[out] polygons_out Buffer for store polygon indices
+   * @throw runtime_error
+   */
+  void PushIndex(int64_t index, SpillBuffer<polygonType>& polygons_out);
+
+  /** @brief SubMethod for store the index of texture coordinate or normal
+   * of the corner, previous corners without the attribute get kNoIndex
+   * @param index Index from file
+   * @param count Count of the attribute before the line
+   * @param corner Index of the corner
+   * @param[out] indices_out Indices of the attribute per corner
+   * @param[in, out] corners Range and negative indices of the attribute
    */
-  void ParsePolygon(char* line_p, std::vector<int64_t>& polygons_out);
+  static void PushCornerIndex(int64_t index, size_t count, size_t corner,
+                              std::vector<polygonType>& indices_out,
+                              CornerIndices& corners);
 
-  /** @brief SubMethod for correct processing polygon (face) indices
-   * @param[out] tmp_polygons Vector for store unprocessed polygon indices
-   * @param[out] polygons_out Vector for store polygon indices
+  /** @brief SubMethod for check the range of polygon (face) indices and
+   * resolve negative ones
+   * @param vertices_size Count of vertices
+   * @param[in, out] polygons_out Buffer with polygon indices
    * @throw runtime_error
    */
-  void PostProcessing(int64_t vertices_size, std::vector<int64_t>& tmp_polygons,
-                      std::vector<polygonType>& polygons_out);
+  void PostProcessing(int64_t vertices_size,
+                      SpillBuffer<polygonType>& polygons_out);
 
   void ProcessUniqueEdges(std::vector<int64_t> polygons_out,
                           size_t polygon_last_index);
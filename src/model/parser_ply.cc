@@ -0,0 +1,538 @@
+/** @file
+ * @brief Definition of ParserListPLY class
+ */
+#include "model/parser_ply.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "model/number_parser.h"
+
+namespace ModelViewer3D {
+bool ParserListPLY::Accepts(const FileProbe& probe) {
+  const std::string& header = probe.GetHeader();
+
+  // Data section is read at once by the size of file
+  return !probe.IsCompressed() && header.compare(0, 3, "ply") == 0 &&
+         header.size() > 3 && (header[3] == '\n' || header[3] == '\r');
+}
+
+bool ParserListPLY::ParseConcrete(FileProbe& probe, MeshData& mesh_out) {
+  std::istream& file = probe.Rewind();
+  std::vector<PlyElement> elements;
+  this->data_p_ = this->data_end_ = nullptr;
+  this->ParseHeader(file, elements);
+
+  std::streamoff data_begin = file.tellg();
+  std::streamoff data_size = probe.GetFileSize() - data_begin;
+
+  size_t first_vertex = mesh_out.vertices.size() / 3;
+  size_t face_count = 0;
+
+  for (const PlyElement& element : elements) {
+    // Count is bounded by the data before anything is allocated for it
+    size_t min_size = this->MinElementSize(element);
+    if (min_size != 0 && element.count > size_t(data_size + 1) / min_size) {
+      throw std::runtime_error("Corupted format of PLY file");
+    }
+  }
+
+  for (const PlyElement& element : elements) {
+    // Packed vertices are read from the file straight into the mesh, the
+    // data after them is read at once by the first other element
+    if (element.name == "vertex" && !this->data_p_ &&
+        this->IsPacked(element)) {
+      this->ReadPackedVertices(file, element, data_size, mesh_out.vertices);
+      continue;
+    }
+
+    if (!this->data_p_) {
+      this->ReadData(file, data_size);
+    }
+
+    if (element.name == "vertex") {
+      this->ParseVertices(element, mesh_out.vertices);
+
+    } else if (element.name == "face") {
+      face_count +=
+          this->ParseFaces(element, first_vertex, mesh_out.vertices.size() / 3,
+                           mesh_out.polygons);
+
+    } else {
+      this->SkipElement(element);
+    }
+  }
+
+  // Data is the memory of arena
+  this->data_p_ = this->data_end_ = nullptr;
+
+  if (face_count != 0) {
+    mesh_out.edges_count = (mesh_out.vertices.size() / 3) + face_count - 2;
+  }
+
+  return false;
+}
+
+void ParserListPLY::ParseHeader(std::istream& file,
+                                std::vector<PlyElement>& elements) {
+  std::string line;
+  bool is_magic_found = false;
+  bool is_end_found = false;
+
+  while (!is_end_found && std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    std::istringstream line_stream(line);
+    std::string keyword;
+    line_stream >> keyword;
+
+    if (!is_magic_found) {
+      if (keyword != "ply") {
+        throw std::runtime_error("Corupted format of PLY file");
+      }
+      is_magic_found = true;
+
+    } else if (keyword == "format") {
+      std::string format;
+      line_stream >> format;
+
+      if (format == "ascii") {
+        this->format_ = kAscii;
+      } else if (format == "binary_little_endian") {
+        this->format_ = kBinaryLittleEndian;
+      } else if (format == "binary_big_endian") {
+        this->format_ = kBinaryBigEndian;
+      } else {
+        throw std::runtime_error("Corupted format of PLY file");
+      }
+
+    } else if (keyword == "element") {
+      PlyElement element;
+      long long count = -1;
+      line_stream >> element.name >> count;
+
+      if (line_stream.fail() || count < 0) {
+        throw std::runtime_error("Corupted format of PLY file");
+      }
+
+      element.count = size_t(count);
+      elements.push_back(element);
+
+    } else if (keyword == "property") {
+      PlyProperty property;
+      std::string type;
+      line_stream >> type;
+
+      if (type == "list") {
+        std::string count_type;
+        line_stream >> count_type >> type;
+        property.is_list = true;
+        property.count_type = ParseType(count_type);
+      }
+
+      property.type = ParseType(type);
+      line_stream >> property.name;
+
+      if (line_stream.fail() || elements.empty() ||
+          property.type == kUnknownType ||
+          (property.is_list && !IsIntegral(property.count_type))) {
+        throw std::runtime_error("Corupted format of PLY file");
+      }
+
+      elements.back().properties.push_back(property);
+
+    } else if (keyword == "end_header") {
+      is_end_found = true;
+    }
+  }
+
+  if (!is_end_found) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+}
+
+void ParserListPLY::ParseVertices(const PlyElement& element,
+                                  std::vector<vertexType>& vertices_out) {
+  const std::vector<PlyProperty>& properties = element.properties;
+  size_t coordinate_index[3] = {properties.size(), properties.size(),
+                                properties.size()};
+
+  for (size_t i = 0; i < properties.size(); ++i) {
+    if (!properties[i].is_list && properties[i].name.size() == 1 &&
+        properties[i].name[0] >= 'x' && properties[i].name[0] <= 'z') {
+      coordinate_index[properties[i].name[0] - 'x'] = i;
+    }
+  }
+
+  if (coordinate_index[0] == properties.size() ||
+      coordinate_index[1] == properties.size() ||
+      coordinate_index[2] == properties.size()) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  size_t first_value = vertices_out.size();
+  vertices_out.resize(first_value + element.count * 3);
+  vertexType* vertex = vertices_out.data() + first_value;
+
+  if (this->IsPacked(element)) {
+    // Layout of file is equal to layout of vertices, copy all at once
+    size_t size = element.count * 3 * sizeof(vertexType);
+
+    if (size_t(this->data_end_ - this->data_p_) < size) {
+      throw std::runtime_error("Corupted format of PLY file");
+    }
+
+    std::memcpy(vertex, this->data_p_, size);
+    this->data_p_ += size;
+
+  } else {
+    for (size_t i = 0; i < element.count; ++i, vertex += 3) {
+      for (size_t j = 0; j < properties.size(); ++j) {
+        if (properties[j].is_list) {
+          size_t count = this->ReadCount(properties[j].count_type);
+          for (size_t k = 0; k < count; ++k) {
+            this->ReadValue(properties[j].type);
+          }
+
+        } else {
+          double value = this->ReadValue(properties[j].type);
+
+          for (int axis = 0; axis < 3; ++axis) {
+            if (coordinate_index[axis] == j) {
+              vertex[axis] = value;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+bool ParserListPLY::IsPacked(const PlyElement& element) const {
+  const std::vector<PlyProperty>& properties = element.properties;
+  bool is_packed =
+      this->format_ == kBinaryLittleEndian && properties.size() == 3;
+
+  for (size_t i = 0; i < properties.size() && is_packed; ++i) {
+    is_packed = !properties[i].is_list && properties[i].type == kFloat32 &&
+                properties[i].name.size() == 1 &&
+                properties[i].name[0] == char('x' + i);
+  }
+
+  return is_packed;
+}
+
+void ParserListPLY::ReadPackedVertices(std::istream& file,
+                                       const PlyElement& element,
+                                       std::streamoff& data_size,
+                                       std::vector<vertexType>& vertices_out) {
+  size_t size = element.count * 3 * sizeof(vertexType);
+
+  if (uint64_t(data_size) < size) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  size_t first_value = vertices_out.size();
+  vertices_out.resize(first_value + element.count * 3);
+  file.read(reinterpret_cast<char*>(vertices_out.data() + first_value), size);
+
+  if (!file) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  data_size -= size;
+}
+
+void ParserListPLY::ReadData(std::istream& file, std::streamoff data_size) {
+  char* data = this->arena_->AllocateArray<char>(data_size + 1);
+  file.read(data, data_size);
+
+  if (file.gcount() != data_size) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  data[data_size] = '\0';
+  this->data_p_ = data;
+  this->data_end_ = data + data_size;
+}
+
+size_t ParserListPLY::ParseFaces(const PlyElement& element,
+                                 size_t first_vertex, size_t vertices_count,
+                                 std::vector<polygonType>& polygons_out) {
+  const std::vector<PlyProperty>& properties = element.properties;
+  size_t indices_property = properties.size();
+
+  for (size_t i = 0; i < properties.size(); ++i) {
+    if (properties[i].is_list && (properties[i].name == "vertex_indices" ||
+                                  properties[i].name == "vertex_index")) {
+      indices_property = i;
+    }
+  }
+
+  // Integral type guarantees that indices are finite integers
+  if (indices_property == properties.size() ||
+      !IsIntegral(properties[indices_property].type)) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  std::vector<polygonType> face;
+  size_t face_count = 0;
+
+  for (size_t i = 0; i < element.count; ++i) {
+    for (size_t j = 0; j < properties.size(); ++j) {
+      if (!properties[j].is_list) {
+        this->ReadValue(properties[j].type);
+        continue;
+      }
+
+      size_t count = this->ReadCount(properties[j].count_type);
+      face.clear();
+
+      for (size_t k = 0; k < count; ++k) {
+        double index = this->ReadValue(properties[j].type);
+
+        if (j == indices_property) {
+          if (index < 0 || first_vertex + index >= vertices_count) {
+            throw std::runtime_error("Corupted format of PLY file");
+          }
+          face.push_back(first_vertex + polygonType(index));
+        }
+      }
+
+      if (j == indices_property && !face.empty()) {
+        AppendPolygonEdges(face.data(), face.size(), polygons_out);
+        ++face_count;
+      }
+    }
+  }
+
+  return face_count;
+}
+
+void ParserListPLY::SkipElement(const PlyElement& element) {
+  size_t stride = 0;
+  bool is_fixed = this->format_ != kAscii;
+
+  for (const PlyProperty& property : element.properties) {
+    is_fixed = is_fixed && !property.is_list;
+    stride += TypeSize(property.type);
+  }
+
+  if (is_fixed) {
+    if (size_t(this->data_end_ - this->data_p_) < stride * element.count) {
+      throw std::runtime_error("Corupted format of PLY file");
+    }
+
+    this->data_p_ += stride * element.count;
+
+  } else {
+    for (size_t i = 0; i < element.count; ++i) {
+      for (const PlyProperty& property : element.properties) {
+        size_t count = 1;
+        if (property.is_list) {
+          count = this->ReadCount(property.count_type);
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+          this->ReadValue(property.type);
+        }
+      }
+    }
+  }
+}
+
+size_t ParserListPLY::MinElementSize(const PlyElement& element) const {
+  size_t size = 0;
+
+  for (const PlyProperty& property : element.properties) {
+    if (this->format_ == kAscii) {
+      // Digit and separator, empty lists have only the count
+      size += 2;
+    } else {
+      size += TypeSize(property.is_list ? property.count_type : property.type);
+    }
+  }
+
+  return size;
+}
+
+double ParserListPLY::ReadValue(PlyType type) {
+  if (this->format_ == kAscii) {
+    double value = 0;
+    const char* end_p = ParseDouble(this->data_p_, this->data_end_, value);
+
+    if (end_p == this->data_p_ || !IsValueOfType(type, value)) {
+      throw std::runtime_error("Corupted format of PLY file");
+    }
+
+    this->data_p_ = end_p;
+    return value;
+  }
+
+  size_t size = TypeSize(type);
+  if (size_t(this->data_end_ - this->data_p_) < size) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  unsigned char bytes[8];
+  std::memcpy(bytes, this->data_p_, size);
+  this->data_p_ += size;
+
+  // Host byte order is expected to be little endian
+  if (this->format_ == kBinaryBigEndian) {
+    std::reverse(bytes, bytes + size);
+  }
+
+  double value = 0;
+  switch (type) {
+    case kInt8:
+      value = *reinterpret_cast<int8_t*>(bytes);
+      break;
+    case kUInt8:
+      value = bytes[0];
+      break;
+    case kInt16: {
+      int16_t typed;
+      std::memcpy(&typed, bytes, size);
+      value = typed;
+    } break;
+    case kUInt16: {
+      uint16_t typed;
+      std::memcpy(&typed, bytes, size);
+      value = typed;
+    } break;
+    case kInt32: {
+      int32_t typed;
+      std::memcpy(&typed, bytes, size);
+      value = typed;
+    } break;
+    case kUInt32: {
+      uint32_t typed;
+      std::memcpy(&typed, bytes, size);
+      value = typed;
+    } break;
+    case kFloat32: {
+      float typed;
+      std::memcpy(&typed, bytes, size);
+      value = typed;
+    } break;
+    case kFloat64:
+      std::memcpy(&value, bytes, size);
+      break;
+    default:
+      throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  return value;
+}
+
+size_t ParserListPLY::ReadCount(PlyType type) {
+  double count = this->ReadValue(type);
+
+  if (count < 0) {
+    throw std::runtime_error("Corupted format of PLY file");
+  }
+
+  return size_t(count);
+}
+
+bool ParserListPLY::IsIntegral(PlyType type) {
+  return type != kUnknownType && type != kFloat32 && type != kFloat64;
+}
+
+bool ParserListPLY::IsValueOfType(PlyType type, double value) {
+  double min = 0;
+  double max = 0;
+  bool is_integral = true;
+
+  switch (type) {
+    case kInt8:
+      min = INT8_MIN;
+      max = INT8_MAX;
+      break;
+    case kUInt8:
+      max = UINT8_MAX;
+      break;
+    case kInt16:
+      min = INT16_MIN;
+      max = INT16_MAX;
+      break;
+    case kUInt16:
+      max = UINT16_MAX;
+      break;
+    case kInt32:
+      min = INT32_MIN;
+      max = INT32_MAX;
+      break;
+    case kUInt32:
+      max = UINT32_MAX;
+      break;
+    default:
+      // Floating values are not limited
+      is_integral = false;
+  }
+
+  // Comparisons are false for nan
+  return !is_integral ||
+         (value >= min && value <= max && value == std::floor(value));
+}
+
+ParserListPLY::PlyType ParserListPLY::ParseType(const std::string& name) {
+  PlyType type = kUnknownType;
+
+  if (name == "char" || name == "int8") {
+    type = kInt8;
+  } else if (name == "uchar" || name == "uint8") {
+    type = kUInt8;
+  } else if (name == "short" || name == "int16") {
+    type = kInt16;
+  } else if (name == "ushort" || name == "uint16") {
+    type = kUInt16;
+  } else if (name == "int" || name == "int32") {
+    type = kInt32;
+  } else if (name == "uint" || name == "uint32") {
+    type = kUInt32;
+  } else if (name == "float" || name == "float32") {
+    type = kFloat32;
+  } else if (name == "double" || name == "float64") {
+    type = kFloat64;
+  }
+
+  return type;
+}
+
+size_t ParserListPLY::TypeSize(PlyType type) {
+  size_t size = 0;
+
+  switch (type) {
+    case kInt8:
+    case kUInt8:
+      size = 1;
+      break;
+    case kInt16:
+    case kUInt16:
+      size = 2;
+      break;
+    case kInt32:
+    case kUInt32:
+    case kFloat32:
+      size = 4;
+      break;
+    case kFloat64:
+      size = 8;
+      break;
+    default:
+      break;
+  }
+
+  return size;
+}
+}  // namespace ModelViewer3D
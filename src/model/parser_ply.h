@@ -0,0 +1,150 @@
+/** @file
+ * @brief Declaration of ParserListPLY class
+ */
+#ifndef SRC_MODEL_PARSER_PLY_H_
+#define SRC_MODEL_PARSER_PLY_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "model/parser_list.h"
+
+namespace ModelViewer3D {
+/** @brief Part of linked list struct for parse files with ascii or binary
+ * ply format
+ */
+class ParserListPLY : public ParserList {
+ protected:
+  /** @brief Check the file starts with ply magic line
+   * @param[in] probe Opened file with the read header
+   */
+  bool Accepts(const FileProbe& probe) override;
+
+  /** @brief Parse given file of ply format, load vertices and faces of the
+   * model
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  bool ParseConcrete(FileProbe& probe, MeshData& mesh_out) override;
+
+ private:
+  enum PlyFormat { kAscii, kBinaryLittleEndian, kBinaryBigEndian };
+
+  enum PlyType {
+    kUnknownType,
+    kInt8,
+    kUInt8,
+    kInt16,
+    kUInt16,
+    kInt32,
+    kUInt32,
+    kFloat32,
+    kFloat64
+  };
+
+  struct PlyProperty {
+    std::string name;
+    PlyType type = kUnknownType;
+    // Type of the count for list properties
+    PlyType count_type = kUnknownType;
+    bool is_list = false;
+  };
+
+  struct PlyElement {
+    std::string name;
+    size_t count = 0;
+    std::vector<PlyProperty> properties;
+  };
+
+  /** @brief SubMethod for parse header of file up to end_header line
+   * @param[in, out] file File positioned at the beginning
+   * @param[out] elements Elements declared by the header
+   * @throw runtime_error
+   */
+  void ParseHeader(std::istream& file, std::vector<PlyElement>& elements);
+
+  /** @brief SubMethod for parse element with vertices, packed binary float
+   * coordinates are copied at once
+   * @param[in] element Declaration of the element
+   * @param[out] vertices_out Vector for store vertices
+   * @throw runtime_error
+   */
+  void ParseVertices(const PlyElement& element,
+                     std::vector<vertexType>& vertices_out);
+
+  /** @brief Check the element is little endian float x, y and z, which
+   * has the layout of vertices
+   */
+  bool IsPacked(const PlyElement& element) const;
+
+  /** @brief SubMethod for read packed vertices from the file straight into
+   * the vertex array, without a copy of the data
+   * @param[in, out] file File positioned at the element
+   * @param[in] element Declaration of the element
+   * @param[in, out] data_size Size of data left in the file
+   * @param[out] vertices_out Vector for store vertices
+   * @throw runtime_error
+   */
+  void ReadPackedVertices(std::istream& file, const PlyElement& element,
+                          std::streamoff& data_size,
+                          std::vector<vertexType>& vertices_out);
+
+  /** @brief SubMethod for read the data left in the file into the arena,
+   * ascii data ends with zero
+   * @throw runtime_error
+   */
+  void ReadData(std::istream& file, std::streamoff data_size);
+
+  /** @brief SubMethod for parse element with faces
+   * @param[in] element Declaration of the element
+   * @param first_vertex Index of the first vertex of the file
+   * @param vertices_count Count of vertices for check indices
+   * @param[out] polygons_out Vector for store polygon indices
+   * @return Count of parsed faces
+   * @throw runtime_error
+   */
+  size_t ParseFaces(const PlyElement& element, size_t first_vertex,
+                    size_t vertices_count,
+                    std::vector<polygonType>& polygons_out);
+
+  /** @brief SubMethod for skip element which is not used */
+  void SkipElement(const PlyElement& element);
+
+  /** @brief Get the least size of one item of the element in the data,
+   * ascii values take the digit and the separator
+   */
+  size_t MinElementSize(const PlyElement& element) const;
+
+  /** @brief Read one value of the given type from the data at the cursor
+   * @throw runtime_error
+   */
+  double ReadValue(PlyType type);
+
+  /** @brief Read the count of list, which must not be negative
+   * @throw runtime_error
+   */
+  size_t ReadCount(PlyType type);
+
+  /** @brief Check the type is one of integer types */
+  static bool IsIntegral(PlyType type);
+
+  /** @brief Check the ascii value is representable by the type, integer
+   * types accept only integral numbers in their range
+   */
+  static bool IsValueOfType(PlyType type, double value);
+
+  /** @brief Get the type by name in header */
+  static PlyType ParseType(const std::string& name);
+
+  /** @brief Get the size of binary value of the type */
+  static size_t TypeSize(PlyType type);
+
+  PlyFormat format_ = kAscii;
+  // Data of the file after the header, ascii data ends with zero
+  const char* data_p_ = nullptr;
+  const char* data_end_ = nullptr;
+};  // ParserListPLY
+}  // namespace  ModelViewer3D
+#endif  // SRC_MODEL_PARSER_PLY_H_
@@ -0,0 +1,218 @@
+/** @file
+ * @brief Definition of ParserListSTL class
+ */
+#include "model/parser_stl.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "model/number_parser.h"
+
+namespace ModelViewer3D {
+bool ParserListSTL::Accepts(const FileProbe& probe) {
+  const std::string& header = probe.GetHeader();
+  bool is_accepted = IsBinary(probe);
+
+  if (!is_accepted) {
+    size_t solid_position = header.find_first_not_of(" \t\r\n");
+    is_accepted =
+        solid_position != std::string::npos &&
+        header.compare(solid_position, 5, "solid") == 0 &&
+        (header.find("facet", solid_position) != std::string::npos ||
+         header.find("endsolid", solid_position) != std::string::npos);
+  }
+
+  return is_accepted;
+}
+
+bool ParserListSTL::IsBinary(const FileProbe& probe) {
+  // 80 bytes of header and count of triangles
+  uint32_t triangles_count = 0;
+  if (probe.GetHeader().size() >= 84) {
+    std::memcpy(&triangles_count, probe.GetHeader().data() + 80,
+                sizeof(triangles_count));
+  }
+
+  // Size of compressed file is not equal to size of data
+  return !probe.IsCompressed() && probe.GetHeader().size() >= 84 &&
+         probe.GetFileSize() == 84 + uint64_t(50) * triangles_count;
+}
+
+bool ParserListSTL::ParseConcrete(FileProbe& probe, MeshData& mesh_out) {
+  std::istream& file = probe.Rewind();
+  size_t first_polygon = mesh_out.polygons.size();
+  this->first_vertex_ = mesh_out.vertices.size() / 3;
+  this->welded_count_ = 0;
+
+  if (IsBinary(probe)) {
+    uint32_t triangles_count = 0;
+    std::memcpy(&triangles_count, probe.GetHeader().data() + 80,
+                sizeof(triangles_count));
+    file.seekg(84, std::ios::beg);
+    this->ParseBinary(file, triangles_count, mesh_out);
+
+  } else {
+    this->ParseAscii(file, mesh_out);
+  }
+
+  // Table is the memory of arena
+  this->weld_table_ = nullptr;
+  this->weld_capacity_ = 0;
+
+  size_t face_count = (mesh_out.polygons.size() - first_polygon) / 6;
+  if (face_count != 0) {
+    mesh_out.edges_count = (mesh_out.vertices.size() / 3) + face_count - 2;
+  }
+
+  return false;
+}
+
+void ParserListSTL::ParseBinary(std::istream& file, uint32_t triangles_count,
+                                MeshData& mesh_out) {
+  // Normal, three vertices and attribute byte count
+  const size_t kRecordSize = 50;
+  const size_t kBlockTriangles = 1 << 16;
+  char* block =
+      this->arena_->AllocateArray<char>(kBlockTriangles * kRecordSize);
+
+  // Closed meshes have about a half of unique vertices per triangle
+  size_t capacity = 1024;
+  while (capacity < triangles_count) {
+    capacity <<= 1;
+  }
+  this->Rehash(capacity, mesh_out.vertices);
+  mesh_out.vertices.reserve(mesh_out.vertices.size() + triangles_count * 3 / 2);
+  mesh_out.polygons.reserve(mesh_out.polygons.size() + triangles_count * 6);
+
+  for (uint32_t done = 0; done < triangles_count;) {
+    size_t count = std::min<size_t>(kBlockTriangles, triangles_count - done);
+    file.read(block, count * kRecordSize);
+
+    if (!file) {
+      throw std::runtime_error("Corupted format of STL file");
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      vertexType vertices[9];
+      std::memcpy(vertices, block + i * kRecordSize + 12,
+                  sizeof(vertices));
+
+      polygonType face[3];
+      for (int j = 0; j < 3; ++j) {
+        face[j] = this->WeldVertex(vertices + j * 3, mesh_out.vertices);
+      }
+
+      AppendPolygonEdges(face, 3, mesh_out.polygons);
+    }
+
+    done += count;
+  }
+}
+
+void ParserListSTL::ParseAscii(std::istream& file, MeshData& mesh_out) {
+  this->Rehash(1024, mesh_out.vertices);
+
+  std::string line;
+  polygonType face[3];
+  int face_size = 0;
+
+  while (std::getline(file, line)) {
+    char* line_p = line.data();
+    while (isspace(*line_p)) {
+      line_p++;
+    }
+
+    if (std::strncmp(line_p, "vertex", 6) == 0) {
+      line_p += 6;
+      vertexType vertex[3];
+
+      const char* number_p = line_p;
+      const char* line_end = line.data() + line.size();
+      for (int i = 0; i < 3; ++i) {
+        const char* number_end = ParseFloat(number_p, line_end, vertex[i]);
+
+        if (number_end == number_p) {
+          throw std::runtime_error("Corupted format of STL file");
+        }
+        number_p = number_end;
+      }
+
+      if (face_size == 3) {
+        throw std::runtime_error("Corupted format of STL file");
+      }
+      face[face_size++] = this->WeldVertex(vertex, mesh_out.vertices);
+
+    } else if (std::strncmp(line_p, "endloop", 7) == 0) {
+      if (face_size != 3) {
+        throw std::runtime_error("Corupted format of STL file");
+      }
+
+      AppendPolygonEdges(face, 3, mesh_out.polygons);
+      face_size = 0;
+    }
+  }
+}
+
+polygonType ParserListSTL::WeldVertex(const vertexType* vertex,
+                                      std::vector<vertexType>& vertices_out) {
+  if ((this->welded_count_ + 1) * 2 > this->weld_capacity_) {
+    this->Rehash(this->weld_capacity_ * 2, vertices_out);
+  }
+
+  // Adding of zero turns negative zero into positive one
+  vertexType key[3] = {vertex[0] + 0.0f, vertex[1] + 0.0f, vertex[2] + 0.0f};
+  size_t mask = this->weld_capacity_ - 1;
+  size_t slot = HashVertex(key) & mask;
+
+  while (this->weld_table_[slot] != 0) {
+    polygonType index = this->weld_table_[slot] - 1;
+
+    if (std::memcmp(vertices_out.data() + index * 3, key, sizeof(key)) == 0) {
+      return index;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  polygonType index = vertices_out.size() / 3;
+  vertices_out.insert(vertices_out.end(), key, key + 3);
+  this->weld_table_[slot] = index + 1;
+  ++this->welded_count_;
+
+  return index;
+}
+
+void ParserListSTL::Rehash(size_t capacity,
+                           const std::vector<vertexType>& vertices_out) {
+  // Previous table stays in the arena until the end of load
+  this->weld_table_ = this->arena_->AllocateArray<polygonType>(capacity);
+  this->weld_capacity_ = capacity;
+  std::fill(this->weld_table_, this->weld_table_ + capacity, 0);
+  size_t mask = capacity - 1;
+
+  for (size_t index = this->first_vertex_; index < vertices_out.size() / 3;
+       ++index) {
+    size_t slot = HashVertex(vertices_out.data() + index * 3) & mask;
+
+    while (this->weld_table_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+
+    this->weld_table_[slot] = index + 1;
+  }
+}
+
+size_t ParserListSTL::HashVertex(const vertexType* vertex) {
+  uint32_t bits[3];
+  std::memcpy(bits, vertex, sizeof(bits));
+
+  uint64_t hash = bits[0] * 0x9E3779B97F4A7C15ull;
+  hash ^= bits[1] + 0x7F4A7C159E3779B9ull + (hash << 6) + (hash >> 2);
+  hash ^= bits[2] + 0x94D049BB133111EBull + (hash << 6) + (hash >> 2);
+  hash ^= hash >> 31;
+
+  return hash;
+}
+}  // namespace ModelViewer3D
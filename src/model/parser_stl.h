@@ -0,0 +1,80 @@
+/** @file
+ * @brief Declaration of ParserListSTL class
+ */
+#ifndef SRC_MODEL_PARSER_STL_H_
+#define SRC_MODEL_PARSER_STL_H_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "model/parser_list.h"
+
+namespace ModelViewer3D {
+/** @brief Part of linked list struct for parse files with stl format
+ * Every triangle of stl has own copies of vertices, so equal vertices are
+ * welded into one with a hash table
+ */
+class ParserListSTL : public ParserList {
+ protected:
+  /** @brief Check the size of file matches the count of triangles of
+   * binary stl, or the file starts with solid keyword of ascii stl
+   * @param[in] probe Opened file with the read header
+   */
+  bool Accepts(const FileProbe& probe) override;
+
+  /** @brief Parse given file of binary or ascii stl format
+   * @param[in, out] probe Opened file with the read header
+   * @param[out] mesh_out Structure for store all attributes of the model
+   * @throw runtime_error
+   */
+  bool ParseConcrete(FileProbe& probe, MeshData& mesh_out) override;
+
+ private:
+  /** @brief Check the file is a binary stl by its size */
+  static bool IsBinary(const FileProbe& probe);
+
+  /** @brief SubMethod for parse triangle records of binary stl, they are
+   * read from the file in big blocks
+   * @param[in, out] file File positioned at the first triangle
+   * @param triangles_count Count of triangles from the header
+   * @param[out] mesh_out Structure for store the model
+   * @throw runtime_error
+   */
+  void ParseBinary(std::istream& file, uint32_t triangles_count,
+                   MeshData& mesh_out);
+
+  /** @brief SubMethod for parse ascii stl
+   * @param[in, out] file File positioned at the beginning
+   * @param[out] mesh_out Structure for store the model
+   * @throw runtime_error
+   */
+  void ParseAscii(std::istream& file, MeshData& mesh_out);
+
+  /** @brief Get the index of the vertex, adding it if it is new
+   * @param[in] vertex XYZ coordinates
+   * @param[in, out] vertices_out Vector of vertices
+   * @return Index of the vertex in vertices_out
+   */
+  polygonType WeldVertex(const vertexType* vertex,
+                         std::vector<vertexType>& vertices_out);
+
+  /** @brief Resize the hash table and insert all vertices again
+   * @param capacity New power of two size of the table
+   * @param[in] vertices_out Vector of vertices
+   */
+  void Rehash(size_t capacity, const std::vector<vertexType>& vertices_out);
+
+  /** @brief Get the hash of the vertex by bits of coordinates */
+  static size_t HashVertex(const vertexType* vertex);
+
+  // Open addressing table of vertex indices plus one, zero is empty slot
+  polygonType* weld_table_ = nullptr;
+  size_t weld_capacity_ = 0;
+  size_t welded_count_ = 0;
+  // Index of the first vertex of the current file
+  size_t first_vertex_ = 0;
+};  // ParserListSTL
+}  // namespace  ModelViewer3D
+#endif  // SRC_MODEL_PARSER_STL_H_
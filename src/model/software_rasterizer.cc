@@ -0,0 +1,552 @@
+/** @file
+ * @brief Definition of SoftwareRasterizer class
+ */
+#include "model/software_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ModelViewer3D {
+/** @brief Convert the coordinate to pixel index, far values are clamped
+ * before conversion
+ */
+static int ToPixel(float value, int limit) {
+  return static_cast<int>(
+      std::floor(std::clamp(value, -1.0f, static_cast<float>(limit) + 1)));
+}
+
+/** @brief Scale channels of the color by the light, alpha is kept */
+static uint32_t Shade(uint32_t color, float light) {
+  uint32_t result = color & 0xFF000000u;
+  for (int shift = 0; shift < 24; shift += 8) {
+    float channel = ((color >> shift) & 0xFF) * light + 0.5f;
+    result |= uint32_t(std::clamp(channel, 0.0f, 255.0f)) << shift;
+  }
+  return result;
+}
+
+void SoftwareRasterizer::Resize(int width, int height) {
+  this->width_ = std::max(width, 0);
+  this->height_ = std::max(height, 0);
+  this->tiles_x_ = (this->width_ + kTileSize - 1) / kTileSize;
+  this->tiles_y_ = (this->height_ + kTileSize - 1) / kTileSize;
+
+  size_t pixels_count = size_t(this->width_) * this->height_;
+  this->color_.resize(pixels_count);
+  this->depth_.resize(pixels_count);
+  this->is_projected_ = false;
+}
+
+void SoftwareRasterizer::Clear(uint32_t color) {
+  std::fill(this->color_.begin(), this->color_.end(), color);
+  std::fill(this->depth_.begin(), this->depth_.end(), 1.0f);
+}
+
+void SoftwareRasterizer::SetMatrix(const float* matrix) {
+  std::memcpy(this->matrix_, matrix, sizeof(this->matrix_));
+  this->is_projected_ = false;
+}
+
+void SoftwareRasterizer::SetGeometry(const vertexType* vertices,
+                                     size_t vertices_count) {
+  this->vertices_ = vertices;
+  this->vertices_count_ = vertices ? vertices_count : 0;
+  this->is_projected_ = false;
+}
+
+void SoftwareRasterizer::Project() {
+  if (this->is_projected_) return;
+
+  this->projected_.resize(this->vertices_count_);
+  const float* m = this->matrix_;
+  const vertexType* vertices = this->vertices_;
+  ClipVertex* out = this->projected_.data();
+
+  // Straight loop over the block is vectorized by the compiler
+  this->pool_->ParallelFor(
+      this->vertices_count_, kBinBlockSize, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          float x = vertices[i * 3];
+          float y = vertices[i * 3 + 1];
+          float z = vertices[i * 3 + 2];
+          out[i].x = m[0] * x + m[4] * y + m[8] * z + m[12];
+          out[i].y = m[1] * x + m[5] * y + m[9] * z + m[13];
+          out[i].z = m[2] * x + m[6] * y + m[10] * z + m[14];
+          out[i].w = m[3] * x + m[7] * y + m[11] * z + m[15];
+        }
+      });
+
+  this->is_projected_ = true;
+}
+
+void SoftwareRasterizer::BinAndRaster(size_t count, const BoundsTask& bounds,
+                                      const RasterTask& raster) {
+  size_t tiles_count = size_t(this->tiles_x_) * this->tiles_y_;
+  if (!count || !tiles_count) return;
+
+  size_t blocks_count = (count + kBinBlockSize - 1) / kBinBlockSize;
+  // Bins of a tile follow each other in the order of blocks
+  size_t bins_count = tiles_count * blocks_count;
+  this->tile_bounds_.resize(count);
+  this->bin_offsets_.assign(bins_count + 1, 0);
+
+  // Primitives are counted per bin first, so all bins fit one array
+  this->pool_->ParallelFor(blocks_count, 1, [&](size_t begin, size_t end) {
+    for (size_t block = begin; block < end; ++block) {
+      size_t last = std::min(count, (block + 1) * kBinBlockSize);
+      for (size_t i = block * kBinBlockSize; i < last; ++i) {
+        Rect rect;
+        Rect& tiles = this->tile_bounds_[i];
+        if (!bounds(i, rect)) {
+          tiles = Rect{0, 0, 0, 0};
+          continue;
+        }
+
+        tiles.x0 = std::max(rect.x0, 0) / kTileSize;
+        tiles.y0 = std::max(rect.y0, 0) / kTileSize;
+        tiles.x1 = (std::min(rect.x1, this->width_) - 1) / kTileSize + 1;
+        tiles.y1 = (std::min(rect.y1, this->height_) - 1) / kTileSize + 1;
+        for (int ty = tiles.y0; ty < tiles.y1; ++ty) {
+          for (int tx = tiles.x0; tx < tiles.x1; ++tx) {
+            size_t tile_index = size_t(ty) * this->tiles_x_ + tx;
+            ++this->bin_offsets_[tile_index * blocks_count + block + 1];
+          }
+        }
+      }
+    }
+  });
+
+  for (size_t bin = 0; bin < bins_count; ++bin) {
+    this->bin_offsets_[bin + 1] += this->bin_offsets_[bin];
+  }
+  this->bin_indices_.resize(this->bin_offsets_.back());
+  this->bin_cursors_.assign(this->bin_offsets_.begin(),
+                            this->bin_offsets_.end() - 1);
+
+  // Every block writes only its own bins
+  this->pool_->ParallelFor(blocks_count, 1, [&](size_t begin, size_t end) {
+    for (size_t block = begin; block < end; ++block) {
+      size_t last = std::min(count, (block + 1) * kBinBlockSize);
+      for (size_t i = block * kBinBlockSize; i < last; ++i) {
+        const Rect& tiles = this->tile_bounds_[i];
+        for (int ty = tiles.y0; ty < tiles.y1; ++ty) {
+          for (int tx = tiles.x0; tx < tiles.x1; ++tx) {
+            size_t tile_index = size_t(ty) * this->tiles_x_ + tx;
+            size_t& cursor = this->bin_cursors_[tile_index * blocks_count +
+                                                block];
+            this->bin_indices_[cursor++] = i;
+          }
+        }
+      }
+    }
+  });
+
+  this->pool_->ParallelFor(tiles_count, 1, [&](size_t begin, size_t end) {
+    for (size_t tile_index = begin; tile_index < end; ++tile_index) {
+      int tx = tile_index % this->tiles_x_;
+      int ty = tile_index / this->tiles_x_;
+      Rect tile{tx * kTileSize, ty * kTileSize,
+                std::min((tx + 1) * kTileSize, this->width_),
+                std::min((ty + 1) * kTileSize, this->height_)};
+
+      size_t first = this->bin_offsets_[tile_index * blocks_count];
+      size_t last = this->bin_offsets_[(tile_index + 1) * blocks_count];
+      for (size_t bin_index = first; bin_index < last; ++bin_index) {
+        raster(this->bin_indices_[bin_index], tile);
+      }
+    }
+  });
+}
+
+void SoftwareRasterizer::DrawLines(const polygonType* indices,
+                                   size_t indices_count, uint32_t color,
+                                   int width, uint16_t pattern, int factor) {
+  if (!indices || indices_count < 2 || !this->width_ || !this->height_) {
+    return;
+  }
+
+  this->Project();
+  width = std::max(width, 1);
+  factor = std::max(factor, 1);
+
+  size_t lines_count = indices_count / 2;
+  this->segments_.resize(lines_count);
+  const float half_width = this->width_ * 0.5f;
+  const float half_height = this->height_ * 0.5f;
+
+  this->pool_->ParallelFor(
+      lines_count, kBinBlockSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          Segment& segment = this->segments_[i];
+          segment.is_visible = false;
+          if (indices[i * 2] >= this->vertices_count_ ||
+              indices[i * 2 + 1] >= this->vertices_count_) {
+            continue;
+          }
+
+          ClipVertex a = this->projected_[indices[i * 2]];
+          ClipVertex b = this->projected_[indices[i * 2 + 1]];
+
+          // Clip by near (z >= -w) and far (z <= w) planes
+          float t0 = 0, t1 = 1;
+          bool is_inside = true;
+          for (float sign : {1.0f, -1.0f}) {
+            float da = a.w + sign * a.z;
+            float db = b.w + sign * b.z;
+            if (da < 0 && db < 0) {
+              is_inside = false;
+            } else if (da < 0) {
+              t0 = std::max(t0, da / (da - db));
+            } else if (db < 0) {
+              t1 = std::min(t1, da / (da - db));
+            }
+          }
+          if (!is_inside || t0 > t1) continue;
+
+          auto to_window = [&](float t, float& x, float& y, float& z) {
+            ClipVertex v{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                         a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t};
+            x = (v.x / v.w + 1) * half_width;
+            y = (v.y / v.w + 1) * half_height;
+            z = v.z / v.w * 0.5f + 0.5f;
+          };
+          to_window(t0, segment.x0, segment.y0, segment.z0);
+          to_window(t1, segment.x1, segment.y1, segment.z1);
+          segment.is_visible = true;
+        }
+      });
+
+  const int extent = width / 2 + 1;
+  this->BinAndRaster(
+      lines_count,
+      [&](size_t i, Rect& rect) {
+        const Segment& segment = this->segments_[i];
+        if (!segment.is_visible) return false;
+        rect.x0 = ToPixel(std::min(segment.x0, segment.x1), this->width_) -
+                  extent;
+        rect.x1 = ToPixel(std::max(segment.x0, segment.x1), this->width_) +
+                  extent + 1;
+        rect.y0 = ToPixel(std::min(segment.y0, segment.y1), this->height_) -
+                  extent;
+        rect.y1 = ToPixel(std::max(segment.y0, segment.y1), this->height_) +
+                  extent + 1;
+        return rect.x1 > 0 && rect.y1 > 0 && rect.x0 < this->width_ &&
+               rect.y0 < this->height_;
+      },
+      [&](size_t i, const Rect& tile) {
+        this->RasterSegment(this->segments_[i], tile, color, width, pattern,
+                            factor);
+      });
+}
+
+void SoftwareRasterizer::RasterSegment(const Segment& segment,
+                                       const Rect& tile, uint32_t color,
+                                       int width, uint16_t pattern,
+                                       int factor) {
+  float dx = segment.x1 - segment.x0;
+  float dy = segment.y1 - segment.y0;
+  bool is_x_major = std::fabs(dx) >= std::fabs(dy);
+
+  // Coordinates along the major axis (a) and across it (b)
+  float a0 = is_x_major ? segment.x0 : segment.y0;
+  float a1 = is_x_major ? segment.x1 : segment.y1;
+  float b0 = is_x_major ? segment.y0 : segment.x0;
+  float b1 = is_x_major ? segment.y1 : segment.x1;
+  if (a0 == a1) return;
+
+  const float start = a0;
+  float z0 = segment.z0, z1 = segment.z1;
+  if (a1 < a0) {
+    std::swap(a0, a1);
+    std::swap(b0, b1);
+    std::swap(z0, z1);
+  }
+
+  // Pixels with centers in [a0, a1) along the major axis, as the diamond
+  // exit rule of GL
+  int tile_a0 = is_x_major ? tile.x0 : tile.y0;
+  int tile_a1 = is_x_major ? tile.x1 : tile.y1;
+  int tile_b0 = is_x_major ? tile.y0 : tile.x0;
+  int tile_b1 = is_x_major ? tile.y1 : tile.x1;
+  // Limits are applied before conversion, ends may be far off the screen
+  int a_first = static_cast<int>(
+      std::max(std::ceil(a0 - 0.5f), static_cast<float>(tile_a0)));
+  int a_last = static_cast<int>(
+      std::min(std::ceil(a1 - 0.5f), static_cast<float>(tile_a1))) - 1;
+
+  const float slope = (b1 - b0) / (a1 - a0);
+  const float z_slope = (z1 - z0) / (a1 - a0);
+  const float half_span = (width - 1) * 0.5f;
+
+  for (int a = a_first; a <= a_last; ++a) {
+    float center = a + 0.5f;
+    if (pattern != 0xFFFF) {
+      int bit = (static_cast<int>(std::fabs(center - start)) / factor) & 15;
+      if (!((pattern >> bit) & 1)) continue;
+    }
+
+    float offset = center - a0;
+    float b = b0 + slope * offset;
+    float z = z0 + z_slope * offset;
+    float b_low = std::clamp(b - half_span, static_cast<float>(tile_b0 - width),
+                             static_cast<float>(tile_b1));
+    int b_first = static_cast<int>(std::floor(b_low));
+    int b_last = std::min(b_first + width, tile_b1) - 1;
+    b_first = std::max(b_first, tile_b0);
+
+    for (int b_pixel = b_first; b_pixel <= b_last; ++b_pixel) {
+      if (is_x_major) {
+        this->Plot(a, b_pixel, z, color);
+      } else {
+        this->Plot(b_pixel, a, z, color);
+      }
+    }
+  }
+}
+
+void SoftwareRasterizer::DrawOccluders(const polygonType* indices,
+                                       size_t indices_count) {
+  this->DrawTriangles(indices, indices_count, nullptr, false, nullptr);
+}
+
+void SoftwareRasterizer::DrawSurface(const polygonType* indices,
+                                     size_t indices_count,
+                                     const vertexType* normals, bool is_smooth,
+                                     uint32_t color) {
+  this->DrawTriangles(indices, indices_count, normals, is_smooth, &color);
+}
+
+void SoftwareRasterizer::DrawTriangles(const polygonType* indices,
+                                       size_t indices_count,
+                                       const vertexType* normals,
+                                       bool is_smooth, const uint32_t* color) {
+  if (!indices || indices_count < 3 || !this->width_ || !this->height_) {
+    return;
+  }
+
+  this->Project();
+  size_t triangles_count = indices_count / 3;
+  this->polygons_.resize(triangles_count);
+  const float half_width = this->width_ * 0.5f;
+  const float half_height = this->height_ * 0.5f;
+
+  this->pool_->ParallelFor(
+      triangles_count, kBinBlockSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          Polygon& polygon = this->polygons_[i];
+          polygon.count = 0;
+          ClipVertex triangle[3];
+          float light[3] = {1, 1, 1};
+          bool is_valid = true;
+          for (int k = 0; k < 3 && is_valid; ++k) {
+            polygonType index = indices[i * 3 + k];
+            is_valid = index < this->vertices_count_;
+            if (!is_valid) break;
+            triangle[k] = this->projected_[index];
+
+            // Two sided light goes along the Z axis, towards the viewer
+            if (normals) {
+              const vertexType* normal =
+                  normals + (is_smooth ? size_t(index) : i) * 3;
+              light[k] = kAmbient + kDiffuse * std::fabs(normal[2]);
+            }
+          }
+          if (!is_valid) continue;
+
+          // Clip by the near plane (z >= -w), far fragments fail the depth
+          // test by themselves
+          ClipVertex clipped[4];
+          float clipped_light[4];
+          int count = 0;
+          for (int k = 0; k < 3; ++k) {
+            int next = (k + 1) % 3;
+            const ClipVertex& a = triangle[k];
+            const ClipVertex& b = triangle[next];
+            float da = a.w + a.z;
+            float db = b.w + b.z;
+            if (da >= 0) {
+              clipped_light[count] = light[k];
+              clipped[count++] = a;
+            }
+            if ((da >= 0) != (db >= 0)) {
+              float t = da / (da - db);
+              clipped_light[count] = light[k] + (light[next] - light[k]) * t;
+              clipped[count++] = {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                                  a.z + (b.z - a.z) * t,
+                                  a.w + (b.w - a.w) * t};
+            }
+          }
+
+          for (int k = 0; k < count; ++k) {
+            const ClipVertex& v = clipped[k];
+            if (v.w <= 0) count = 0;
+            if (!count) break;
+            polygon.x[k] = (v.x / v.w + 1) * half_width;
+            polygon.y[k] = (v.y / v.w + 1) * half_height;
+            polygon.z[k] = v.z / v.w * 0.5f + 0.5f;
+            polygon.light[k] = clipped_light[k];
+          }
+          polygon.count = count;
+        }
+      });
+
+  this->BinAndRaster(
+      triangles_count,
+      [&](size_t i, Rect& rect) {
+        const Polygon& polygon = this->polygons_[i];
+        if (polygon.count < 3) return false;
+        auto [x_min, x_max] =
+            std::minmax_element(polygon.x, polygon.x + polygon.count);
+        auto [y_min, y_max] =
+            std::minmax_element(polygon.y, polygon.y + polygon.count);
+        rect.x0 = ToPixel(*x_min, this->width_);
+        rect.x1 = ToPixel(*x_max, this->width_) + 1;
+        rect.y0 = ToPixel(*y_min, this->height_);
+        rect.y1 = ToPixel(*y_max, this->height_) + 1;
+        return rect.x1 > 0 && rect.y1 > 0 && rect.x0 < this->width_ &&
+               rect.y0 < this->height_;
+      },
+      [&](size_t i, const Rect& tile) {
+        const Polygon& polygon = this->polygons_[i];
+        for (int k = 1; k + 1 < polygon.count; ++k) {
+          this->RasterTriangle(polygon, k, k + 1, tile, color);
+        }
+      });
+}
+
+void SoftwareRasterizer::RasterTriangle(const Polygon& polygon, int i1,
+                                        int i2, const Rect& tile,
+                                        const uint32_t* color) {
+  float x[3] = {polygon.x[0], polygon.x[i1], polygon.x[i2]};
+  float y[3] = {polygon.y[0], polygon.y[i1], polygon.y[i2]};
+  float z[3] = {polygon.z[0], polygon.z[i1], polygon.z[i2]};
+  float light[3] = {polygon.light[0], polygon.light[i1], polygon.light[i2]};
+
+  // Counterclockwise order keeps the inside on the left of edges
+  float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (area == 0 || std::isnan(area)) return;
+  if (area < 0) {
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(z[1], z[2]);
+    std::swap(light[1], light[2]);
+    area = -area;
+  }
+
+  // Gradients of a value linear over the window
+  auto gradient = [&](const float* value, float& d_dx, float& d_dy) {
+    d_dx = ((value[1] - value[0]) * (y[2] - y[0]) -
+            (value[2] - value[0]) * (y[1] - y[0])) /
+           area;
+    d_dy = ((value[2] - value[0]) * (x[1] - x[0]) -
+            (value[1] - value[0]) * (x[2] - x[0])) /
+           area;
+  };
+  float dz_dx = 0, dz_dy = 0, dlight_dx = 0, dlight_dy = 0;
+  gradient(z, dz_dx, dz_dy);
+  gradient(light, dlight_dx, dlight_dy);
+  const float offset = std::max(std::fabs(dz_dx), std::fabs(dz_dy)) +
+                       kDepthBias;
+
+  int x_first = std::max(tile.x0, ToPixel(*std::min_element(x, x + 3),
+                                          this->width_));
+  int x_last = std::min(tile.x1, ToPixel(*std::max_element(x, x + 3),
+                                         this->width_) + 1);
+  int y_first = std::max(tile.y0, ToPixel(*std::min_element(y, y + 3),
+                                          this->height_));
+  int y_last = std::min(tile.y1, ToPixel(*std::max_element(y, y + 3),
+                                         this->height_) + 1);
+
+  // Edge k goes from vertex k to the next one, left edges and horizontal
+  // top edges own the pixels on them
+  bool is_owner[3];
+  for (int k = 0; k < 3; ++k) {
+    float dx = x[(k + 1) % 3] - x[k];
+    float dy = y[(k + 1) % 3] - y[k];
+    is_owner[k] = dy < 0 || (dy == 0 && dx < 0);
+  }
+
+  for (int py = y_first; py < y_last; ++py) {
+    float cy = py + 0.5f;
+    for (int px = x_first; px < x_last; ++px) {
+      float cx = px + 0.5f;
+      bool is_inside = true;
+      for (int k = 0; k < 3 && is_inside; ++k) {
+        int next = (k + 1) % 3;
+        float edge = (x[next] - x[k]) * (cy - y[k]) -
+                     (y[next] - y[k]) * (cx - x[k]);
+        is_inside = edge > 0 || (edge == 0 && is_owner[k]);
+      }
+      if (!is_inside) continue;
+
+      float depth = z[0] + dz_dx * (cx - x[0]) + dz_dy * (cy - y[0]) + offset;
+      size_t index = size_t(this->height_ - 1 - py) * this->width_ + px;
+      if (!(depth < this->depth_[index])) continue;
+
+      this->depth_[index] = depth;
+      if (color) {
+        float value =
+            light[0] + dlight_dx * (cx - x[0]) + dlight_dy * (cy - y[0]);
+        this->color_[index] = Shade(*color, value);
+      }
+    }
+  }
+}
+
+void SoftwareRasterizer::DrawPoints(uint32_t color, int size, bool is_round) {
+  if (!this->width_ || !this->height_) return;
+
+  this->Project();
+  size = std::max(size, 1);
+  const float half_size = size * 0.5f;
+  const float half_width = this->width_ * 0.5f;
+  const float half_height = this->height_ * 0.5f;
+
+  auto to_window = [&](size_t i, float& x, float& y, float& z) {
+    const ClipVertex& v = this->projected_[i];
+    if (v.z < -v.w || v.z > v.w || v.w <= 0) return false;
+    x = (v.x / v.w + 1) * half_width;
+    y = (v.y / v.w + 1) * half_height;
+    z = v.z / v.w * 0.5f + 0.5f;
+    return true;
+  };
+
+  this->BinAndRaster(
+      this->vertices_count_,
+      [&](size_t i, Rect& rect) {
+        float x = 0, y = 0, z = 0;
+        if (!to_window(i, x, y, z)) return false;
+        rect.x0 = ToPixel(x - half_size, this->width_);
+        rect.y0 = ToPixel(y - half_size, this->height_);
+        rect.x1 = ToPixel(x + half_size, this->width_) + 1;
+        rect.y1 = ToPixel(y + half_size, this->height_) + 1;
+        return rect.x1 > 0 && rect.y1 > 0 && rect.x0 < this->width_ &&
+               rect.y0 < this->height_;
+      },
+      [&](size_t i, const Rect& tile) {
+        float x = 0, y = 0, z = 0;
+        to_window(i, x, y, z);
+
+        // Pixels with centers inside the square of the point
+        auto first_pixel = [&](float value) {
+          return static_cast<int>(std::ceil(value - half_size - 0.5f));
+        };
+        int x_first = std::max(tile.x0, first_pixel(x));
+        int x_last = std::min(tile.x1, first_pixel(x + size));
+        int y_first = std::max(tile.y0, first_pixel(y));
+        int y_last = std::min(tile.y1, first_pixel(y + size));
+
+        for (int py = y_first; py < y_last; ++py) {
+          for (int px = x_first; px < x_last; ++px) {
+            float ox = px + 0.5f - x;
+            float oy = py + 0.5f - y;
+            if (is_round && ox * ox + oy * oy > half_size * half_size) {
+              continue;
+            }
+            this->Plot(px, py, z, color);
+          }
+        }
+      });
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,203 @@
+/** @file
+ * @brief Declaration of SoftwareRasterizer class
+ */
+#ifndef SRC_MODEL_SOFTWARE_RASTERIZER_H_
+#define SRC_MODEL_SOFTWARE_RASTERIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "model/model_types.h"
+#include "model/thread_pool.h"
+
+namespace ModelViewer3D {
+/** @brief Rasterizer of edges and vertices of the model on the CPU
+ * Vertices are projected by the matrix of the projection strategy, and
+ * primitives are binned to screen tiles. Tiles are rasterized in parallel
+ * with a depth test, so threads never write the same pixel. Coverage and
+ * depth follow the rules of GL for aliased lines and points
+ */
+class SoftwareRasterizer {
+ public:
+  SoftwareRasterizer() = default;
+
+  SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+  SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+  /** @brief Set the pool for parallel projection and rasterization
+   * @param pool Pool of threads, by default the shared one
+   */
+  void SetThreadPool(ThreadPool* pool) { this->pool_ = pool; }
+
+  /** @brief Set the size of image, the content is undefined until Clear */
+  void Resize(int width, int height);
+  int GetWidth() const { return this->width_; }
+  int GetHeight() const { return this->height_; }
+
+  /** @brief Fill the image by the color and reset the depth
+   * @param color Color as 0xAARRGGBB
+   */
+  void Clear(uint32_t color);
+
+  /** @brief Set the transform from model coordinates to clip space
+   * @param[in] matrix 16 values of 4x4 matrix by columns, as of GL
+   */
+  void SetMatrix(const float* matrix);
+
+  /** @brief Set vertices of the model, they are projected on the next draw
+   * @param[in] vertices Sequentially laid out coordinates
+   * @param vertices_count Count of vertices
+   */
+  void SetGeometry(const vertexType* vertices, size_t vertices_count);
+
+  /** @brief Draw edges of the model
+   * @param[in] indices Consecutive pairs of indices of edges
+   * @param indices_count Count of indices
+   * @param color Color as 0xAARRGGBB
+   * @param width Width of lines in pixels
+   * @param pattern Bits of the dash pattern, one bit per factor pixels
+   * @param factor Count of pixels per bit of pattern
+   */
+  void DrawLines(const polygonType* indices, size_t indices_count,
+                 uint32_t color, int width, uint16_t pattern = 0xFFFF,
+                 int factor = 1);
+
+  /** @brief Draw all vertices of the model
+   * @param color Color as 0xAARRGGBB
+   * @param size Size of points in pixels
+   * @param is_round Draw circles instead of squares
+   */
+  void DrawPoints(uint32_t color, int size, bool is_round);
+
+  /** @brief Fill the depth of faces without change of colors, so edges
+   * behind them fail the depth test. The depth is pushed away by its
+   * greatest slope per pixel, as of glPolygonOffset(1, 1), so edges of
+   * the faces pass it
+   * @param[in] indices Consecutive triples of indices of triangles
+   * @param indices_count Count of indices
+   */
+  void DrawOccluders(const polygonType* indices, size_t indices_count);
+
+  /** @brief Draw faces lit by the two sided light along the Z axis of model
+   * coordinates, which goes towards the viewer. The depth is pushed away
+   * as of occluders
+   * @param[in] indices Consecutive triples of indices of triangles
+   * @param indices_count Count of indices
+   * @param[in] normals Unit normals per triangle, or per vertex if smooth
+   * @param is_smooth Light is computed per vertex and interpolated
+   * @param color Color of faces lit by the full light as 0xAARRGGBB
+   */
+  void DrawSurface(const polygonType* indices, size_t indices_count,
+                   const vertexType* normals, bool is_smooth, uint32_t color);
+
+  /** @brief Get pixels as 0xAARRGGBB, rows go from the top */
+  const uint32_t* GetPixels() const { return this->color_.data(); }
+
+  /** @brief Get the depth of pixel in [0, 1], rows go from the top */
+  float GetDepth(int x, int y) const {
+    return this->depth_[size_t(y) * this->width_ + x];
+  }
+
+  // Side of square screen tile in pixels
+  static constexpr int kTileSize = 64;
+  // Count of primitives binned by one task
+  static constexpr size_t kBinBlockSize = 1 << 14;
+  // Constant part of the push of the depth of occluders
+  static constexpr float kDepthBias = 1e-6f;
+  // Light of faces is kAmbient + kDiffuse * |cos| of the angle to the light
+  static constexpr float kAmbient = 0.2f;
+  static constexpr float kDiffuse = 0.8f;
+
+ private:
+  /** @brief Vertex in clip space */
+  struct ClipVertex {
+    float x, y, z, w;
+  };
+
+  /** @brief Line clipped by near and far planes in window coordinates */
+  struct Segment {
+    float x0, y0, z0;
+    float x1, y1, z1;
+    bool is_visible;
+  };
+
+  /** @brief Triangle clipped by the near plane in window coordinates, the
+   * fan of its vertices covers it
+   */
+  struct Polygon {
+    float x[4], y[4], z[4];
+    float light[4];
+    int count;
+  };
+
+  /** @brief Rectangle of pixels [x0, x1) x [y0, y1), y goes up as in GL */
+  struct Rect {
+    int x0, y0, x1, y1;
+  };
+
+  using BoundsTask = std::function<bool(size_t primitive, Rect& bounds)>;
+  using RasterTask = std::function<void(size_t primitive, const Rect& tile)>;
+
+  /** @brief SubMethod for project vertices, if they or the matrix changed */
+  void Project();
+
+  /** @brief Bin primitives to tiles in parallel blocks, then rasterize the
+   * tiles in parallel, primitives of a tile keep the order of submission
+   * @param count Count of primitives
+   * @param bounds Pixels covered by the primitive, false if none
+   * @param raster Draw the primitive clipped by the tile
+   */
+  void BinAndRaster(size_t count, const BoundsTask& bounds,
+                    const RasterTask& raster);
+
+  /** @brief SubMethod for write the pixel if it passes the depth test */
+  void Plot(int x, int y, float z, uint32_t color) {
+    size_t index = size_t(this->height_ - 1 - y) * this->width_ + x;
+    if (z < this->depth_[index]) {
+      this->depth_[index] = z;
+      this->color_[index] = color;
+    }
+  }
+
+  void RasterSegment(const Segment& segment, const Rect& tile, uint32_t color,
+                     int width, uint16_t pattern, int factor);
+
+  /** @brief Clip and draw triangles, only their depth if color is null */
+  void DrawTriangles(const polygonType* indices, size_t indices_count,
+                     const vertexType* normals, bool is_smooth,
+                     const uint32_t* color);
+
+  /** @brief SubMethod for fill pixels of the triangle of polygon vertices
+   * with centers inside it, edges shared by triangles are filled once by
+   * the top left rule
+   * @param color Shaded color, only the depth is written if null
+   */
+  void RasterTriangle(const Polygon& polygon, int i1, int i2, const Rect& tile,
+                      const uint32_t* color);
+
+  ThreadPool* pool_ = &ThreadPool::Instance();
+  int width_ = 0;
+  int height_ = 0;
+  int tiles_x_ = 0;
+  int tiles_y_ = 0;
+  std::vector<uint32_t> color_;
+  std::vector<float> depth_;
+  float matrix_[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  const vertexType* vertices_ = nullptr;
+  size_t vertices_count_ = 0;
+  bool is_projected_ = false;
+  std::vector<ClipVertex> projected_;
+  std::vector<Segment> segments_;
+  std::vector<Polygon> polygons_;
+  // Range of tiles covered by every primitive of the draw
+  std::vector<Rect> tile_bounds_;
+  // Indices of primitives of all bins, ordered by tile and then by block of
+  // binning, bin_offsets_ has the beginning of every bin and the end
+  std::vector<uint32_t> bin_indices_;
+  std::vector<size_t> bin_offsets_;
+  std::vector<size_t> bin_cursors_;
+};  // SoftwareRasterizer
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_SOFTWARE_RASTERIZER_H_
@@ -0,0 +1,71 @@
+/** @file
+ * @brief Definition of SpillFile class
+ */
+#include "model/spill_buffer.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace ModelViewer3D {
+#ifdef _WIN32
+// Buffers do not create files, if they are not supported
+SpillFile::SpillFile() {
+  throw std::runtime_error("Could not create temporary file");
+}
+
+SpillFile::~SpillFile() {}
+
+char* SpillFile::Resize(size_t) {
+  throw std::runtime_error("Could not map temporary file");
+}
+#else
+SpillFile::SpillFile() {
+  // Temporary file is removed by system after close
+  std::FILE* file = std::tmpfile();
+  if (!file) {
+    throw std::runtime_error("Could not create temporary file");
+  }
+
+  this->descriptor_ = dup(fileno(file));
+  std::fclose(file);
+
+  if (this->descriptor_ < 0) {
+    throw std::runtime_error("Could not create temporary file");
+  }
+}
+
+SpillFile::~SpillFile() {
+  if (this->mapping_) {
+    munmap(this->mapping_, this->size_);
+  }
+  close(this->descriptor_);
+}
+
+char* SpillFile::Resize(size_t size) {
+  if (this->mapping_) {
+    munmap(this->mapping_, this->size_);
+    this->mapping_ = nullptr;
+    this->size_ = 0;
+  }
+
+  if (ftruncate(this->descriptor_, size) != 0) {
+    throw std::runtime_error("Could not extend temporary file");
+  }
+
+  void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       this->descriptor_, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Could not map temporary file");
+  }
+
+  this->mapping_ = static_cast<char*>(mapping);
+  this->size_ = size;
+  return this->mapping_;
+}
+#endif  // _WIN32
+}  // namespace ModelViewer3D
@@ -0,0 +1,164 @@
+/** @file
+ * @brief Declaration of SpillFile and SpillBuffer classes
+ */
+#ifndef SRC_MODEL_SPILL_BUFFER_H_
+#define SRC_MODEL_SPILL_BUFFER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Anonymous temporary file mapped into memory
+ * Pages of the mapping are backed by the file, so the system can evict them
+ * instead of running out of memory. Files are mapped by POSIX calls, on
+ * other systems buffers stay in memory
+ */
+class SpillFile {
+ public:
+#ifdef _WIN32
+  static constexpr bool kIsSupported = false;
+#else
+  static constexpr bool kIsSupported = true;
+#endif  // _WIN32
+
+  /** @brief Create the temporary file, it is deleted on close
+   * @throw runtime_error
+   */
+  SpillFile();
+
+  SpillFile(const SpillFile&) = delete;
+  SpillFile& operator=(const SpillFile&) = delete;
+
+  /** @brief Unmap and close the file */
+  ~SpillFile();
+
+  /** @brief Change the size of file and map it again, the content is kept
+   * @param size New size in bytes
+   * @return Pointer to the beginning of the new mapping
+   * @throw runtime_error
+   */
+  char* Resize(size_t size);
+
+ private:
+  int descriptor_ = -1;
+  char* mapping_ = nullptr;
+  size_t size_ = 0;
+};  // SpillFile
+
+/** @brief Growable array, which is kept in memory up to the memory budget
+ * and is moved into a mapped temporary file when growth exceeds the budget
+ * @tparam T Trivially copyable type of elements
+ */
+template <typename T>
+class SpillBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpillBuffer stores elements as raw bytes");
+
+ public:
+  /** @brief Create empty buffer
+   * @param memory_budget Size in bytes, after which the buffer is moved to
+   * file, zero for unlimited
+   */
+  explicit SpillBuffer(size_t memory_budget = 0)
+      : memory_budget_(memory_budget) {}
+
+  SpillBuffer(const SpillBuffer&) = delete;
+  SpillBuffer& operator=(const SpillBuffer&) = delete;
+
+  /** @brief Append the element to the end */
+  void push_back(const T& value) {
+    if (this->size_ == this->capacity_) {
+      this->Grow(this->size_ + 1);
+    }
+    this->data_[this->size_++] = value;
+  }
+
+  /** @brief Allocate space for the given count of elements at once
+   * The exact size is allocated in memory, unless the buffer is in file
+   * already, so it is passed to the vector without copy
+   * @throw runtime_error, bad_alloc
+   */
+  void reserve(size_t capacity) {
+    if (capacity > this->capacity_) {
+      this->Reallocate(capacity, false);
+    }
+  }
+
+  T& operator[](size_t index) { return this->data_[index]; }
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+
+  /** @brief Check the buffer is moved to file */
+  bool IsSpilled() const { return this->file_ != nullptr; }
+
+  /** @brief Append all elements to the vector and clear the buffer
+   * Buffer in memory is passed without copy if the vector is empty,
+   * otherwise the vector grows only once. Buffer in file is copied, which
+   * happens only if it grew over the budget without reserve
+   * @param[out] vector_out Vector for store elements
+   * @throw bad_alloc
+   */
+  void MoveTo(std::vector<T>& vector_out) {
+    if (!this->file_ && vector_out.empty()) {
+      this->memory_.resize(this->size_);
+      this->memory_.swap(vector_out);
+
+    } else {
+      vector_out.reserve(vector_out.size() + this->size_);
+      vector_out.insert(vector_out.end(), this->data_,
+                        this->data_ + this->size_);
+    }
+
+    std::vector<T>().swap(this->memory_);
+    this->file_.reset();
+    this->data_ = nullptr;
+    this->size_ = 0;
+    this->capacity_ = 0;
+  }
+
+ private:
+  /** @brief Extend capacity geometrically up to the required one */
+  void Grow(size_t required_capacity) {
+    this->Reallocate(
+        std::max({required_capacity, this->capacity_ * 2, size_t(1024)}),
+        true);
+  }
+
+  /** @brief Move elements to storage of the given capacity
+   * @param is_spill_allowed Storage in memory may be moved to file
+   */
+  void Reallocate(size_t capacity, bool is_spill_allowed) {
+    if (SpillFile::kIsSupported && is_spill_allowed && !this->file_ &&
+        this->memory_budget_ != 0 &&
+        capacity * sizeof(T) > this->memory_budget_) {
+      this->file_ = std::make_unique<SpillFile>();
+      T* data = reinterpret_cast<T*>(this->file_->Resize(capacity * sizeof(T)));
+      std::memcpy(data, this->memory_.data(), this->size_ * sizeof(T));
+      std::vector<T>().swap(this->memory_);
+      this->data_ = data;
+
+    } else if (this->file_) {
+      this->data_ =
+          reinterpret_cast<T*>(this->file_->Resize(capacity * sizeof(T)));
+
+    } else {
+      this->memory_.resize(capacity);
+      this->data_ = this->memory_.data();
+    }
+
+    this->capacity_ = capacity;
+  }
+
+  size_t memory_budget_;
+  std::vector<T> memory_;
+  std::unique_ptr<SpillFile> file_;
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};  // SpillBuffer
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_SPILL_BUFFER_H_
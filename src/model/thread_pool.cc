@@ -0,0 +1,104 @@
+/** @file
+ * @brief Definition of ThreadPool class
+ */
+#include "model/thread_pool.h"
+
+#include <algorithm>
+
+namespace ModelViewer3D {
+ThreadPool::ThreadPool(unsigned threads_count) {
+  for (unsigned i = 1; i < threads_count; ++i) {
+    this->workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->stop_ = true;
+  }
+  this->wake_.notify_all();
+
+  for (std::thread& worker : this->workers_) {
+    worker.join();
+  }
+}
+
+ThreadPool& ThreadPool::Instance() {
+  static ThreadPool shared(std::thread::hardware_concurrency());
+  return shared;
+}
+
+unsigned ThreadPool::GetThreadsCount() const {
+  return this->workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t block_size,
+                             const RangeTask& task) {
+  if (block_size == 0) {
+    block_size = 1;
+  }
+
+  if (count <= block_size || this->workers_.empty()) {
+    if (count != 0) {
+      task(0, count);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> call_lock(this->call_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->task_ = &task;
+    this->count_ = count;
+    this->block_size_ = block_size;
+    this->next_block_ = 0;
+    this->busy_workers_ = this->workers_.size();
+    ++this->generation_;
+  }
+  this->wake_.notify_all();
+
+  this->RunBlocks();
+
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->done_.wait(lock, [this] { return this->busy_workers_ == 0; });
+  this->task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  uint64_t seen_generation = 0;
+
+  while (true) {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->wake_.wait(lock, [this, seen_generation] {
+      return this->stop_ || this->generation_ != seen_generation;
+    });
+
+    if (this->stop_) {
+      return;
+    }
+
+    seen_generation = this->generation_;
+    lock.unlock();
+
+    this->RunBlocks();
+
+    lock.lock();
+    if (--this->busy_workers_ == 0) {
+      this->done_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::RunBlocks() {
+  size_t blocks_count =
+      (this->count_ + this->block_size_ - 1) / this->block_size_;
+
+  for (size_t block = this->next_block_++; block < blocks_count;
+       block = this->next_block_++) {
+    size_t begin = block * this->block_size_;
+    size_t end = std::min(begin + this->block_size_, this->count_);
+    (*this->task_)(begin, end);
+  }
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,71 @@
+/** @file
+ * @brief Declaration of ThreadPool class
+ */
+#ifndef SRC_MODEL_THREAD_POOL_H_
+#define SRC_MODEL_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Persistent set of worker threads for data parallel loops over
+ * model arrays
+ */
+class ThreadPool {
+ public:
+  /** @brief Task for a range of elements [begin, end) */
+  using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+  /** @brief Start the workers
+   * @param threads_count Count of threads including the calling one
+   */
+  explicit ThreadPool(unsigned threads_count);
+
+  /** @brief Stop and join the workers */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /** @brief Gets a pool shared by the application, sized by the count of
+   * hardware threads
+   */
+  static ThreadPool& Instance();
+
+  /** @brief Get the count of threads including the calling one */
+  unsigned GetThreadsCount() const;
+
+  /** @brief Split [0, count) into blocks and run the task over them on all
+   * threads, returns when every block is done. A single block is run on the
+   * calling thread without waking the workers. Must not be called from
+   * inside a task
+   * @param count Count of elements
+   * @param block_size Count of elements in one block
+   * @param task Function called for each block
+   */
+  void ParallelFor(size_t count, size_t block_size, const RangeTask& task);
+
+ private:
+  void WorkerLoop();
+  void RunBlocks();
+
+  std::vector<std::thread> workers_;
+  std::mutex call_mutex_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const RangeTask* task_ = nullptr;
+  size_t count_ = 0;
+  size_t block_size_ = 0;
+  std::atomic<size_t> next_block_{0};
+  size_t busy_workers_ = 0;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+};  // ThreadPool
+}  // namespace ModelViewer3D
+#endif  // SRC_MODEL_THREAD_POOL_H_
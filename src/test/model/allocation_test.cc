@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "model/file_parser.h"
+
+// Hook of global allocation functions, which counts heap allocations of
+// the thread while a counter is alive. Functions are not inlined, so the
+// compiler does not pair free with the new expressions of callers
+static thread_local size_t* allocations_counter = nullptr;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+  if (allocations_counter) {
+    ++*allocations_counter;
+  }
+  void* memory = std::malloc(size ? size : 1);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+__attribute__((noinline)) void* operator new[](size_t size) {
+  return operator new(size);
+}
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+__attribute__((noinline)) void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+__attribute__((noinline)) void operator delete(void* memory,
+                                               size_t) noexcept {
+  std::free(memory);
+}
+__attribute__((noinline)) void operator delete[](void* memory,
+                                                 size_t) noexcept {
+  std::free(memory);
+}
+
+namespace ModelViewer3D {
+/** @brief Scope of counting allocations of the current thread */
+class AllocationCounter {
+ public:
+  AllocationCounter() { allocations_counter = &this->count_; }
+  ~AllocationCounter() { allocations_counter = nullptr; }
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  size_t GetCount() const { return this->count_; }
+
+ private:
+  size_t count_ = 0;
+};
+
+static size_t CountAllocations(FileParser& parser, const std::string& filename,
+                               MeshData& mesh) {
+  AllocationCounter counter;
+  parser.ParseFile(filename, mesh);
+  return counter.GetCount();
+}
+
+TEST(load_testing, allocation_count) {
+  FileParser parser;
+  MeshData warm_up, small, large;
+
+  try {
+    CountAllocations(parser, "test/model/test_data/cube.obj", warm_up);
+    size_t small_count =
+        CountAllocations(parser, "test/model/test_data/cube.obj", small);
+    size_t large_count =
+        CountAllocations(parser, "obj_files/banana.obj", large);
+    // Count of allocations does not grow with count of lines
+    EXPECT_LT(large_count, small_count * 2);
+    EXPECT_GT(large.vertices.size(), 100 * small.vertices.size());
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "model/file_parser.h"
+#include "model/file_writer.h"
+#include "model/thread_pool.h"
+#include "test/model/mesh_helpers.h"
+
+namespace ModelViewer3D {
+static std::string TempPath(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST(export_testing, obj_groups) {
+  FileParser parser;
+  FileWriter writer;
+  MeshData source, result;
+  std::string filename = TempPath("export_groups.obj");
+
+  try {
+    parser.ParseFile("test/model/test_data/groups.obj", source);
+    writer.WriteFile(filename, source);
+    parser.ParseFile(filename, result);
+
+    EXPECT_EQ(result.vertices, source.vertices);
+    EXPECT_EQ(result.polygons, source.polygons);
+    EXPECT_EQ(result.edges_count, source.edges_count);
+    ASSERT_EQ(result.groups.size(), source.groups.size());
+    for (size_t i = 0; i < source.groups.size(); ++i) {
+      EXPECT_EQ(result.groups[i].name, source.groups[i].name);
+      EXPECT_EQ(result.groups[i].material, source.groups[i].material);
+      EXPECT_EQ(result.groups[i].first_index, source.groups[i].first_index);
+      EXPECT_EQ(result.groups[i].indices_count,
+                source.groups[i].indices_count);
+    }
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(export_testing, obj_parallel_blocks) {
+  ThreadPool pool(3);
+  FileParser parser;
+  FileWriter writer;
+  writer.SetThreadPool(&pool);
+  MeshData source = MakeGrid(300), result;
+  std::string filename = TempPath("export_grid.obj");
+
+  try {
+    writer.WriteFile(filename, source);
+    parser.ParseFile(filename, result);
+
+    // Shortest representation of floats is read back exactly
+    EXPECT_EQ(result.vertices, source.vertices);
+    EXPECT_EQ(result.polygons, source.polygons);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(export_testing, stl_binary) {
+  FileParser parser;
+  FileWriter writer;
+  MeshData source, result;
+  std::string filename = TempPath("export_cube.stl");
+
+  try {
+    parser.ParseFile("test/model/test_data/cube.obj", source);
+    writer.WriteFile(filename, source);
+    EXPECT_EQ(std::filesystem::file_size(filename), 84 + 12 * 50);
+
+    // Quads are split into two triangles, vertices are welded back
+    parser.ParseFile(filename, result);
+    EXPECT_EQ(result.vertices.size(), source.vertices.size());
+    EXPECT_EQ(result.polygons.size(), 12 * 6);
+    EXPECT_EQ(result.edges_count, 8 + 12 - 2);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(export_testing, ply_binary) {
+  FileParser parser;
+  FileWriter writer;
+  MeshData source = MakeGrid(200), result;
+  std::string filename = TempPath("export_grid.ply");
+
+  // Polygon with more vertices than the list count of ply holds
+  size_t first_vertex = source.vertices.size() / 3;
+  for (polygonType i = 0; i < 300; ++i) {
+    source.vertices.insert(source.vertices.end(), {float(i), 0, 1});
+    source.polygons.push_back(first_vertex + i);
+    source.polygons.push_back(first_vertex + (i + 1) % 300);
+  }
+
+  try {
+    writer.WriteFile(filename, source, FileWriter::kPlyFormat);
+    parser.ParseFile(filename, result);
+
+    EXPECT_EQ(result.vertices, source.vertices);
+    size_t grid_size = source.polygons.size() - 600;
+    ASSERT_EQ(result.polygons.size(), grid_size + 298 * 6);
+    EXPECT_TRUE(std::equal(source.polygons.begin(),
+                           source.polygons.begin() + grid_size,
+                           result.polygons.begin()));
+    EXPECT_EQ(result.polygons[grid_size], first_vertex);
+    EXPECT_EQ(result.polygons[grid_size + 1], first_vertex + 1);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(export_testing, unsupported_format) {
+  FileWriter writer;
+  MeshData mesh;
+
+  try {
+    writer.WriteFile(TempPath("export_model.txt"), mesh);
+    FAIL() << "Expected: runtime_error";
+  } catch (std::runtime_error& exc) {
+    EXPECT_EQ(std::string(exc.what()), "Unsupported export format");
+  }
+
+  EXPECT_EQ(FileWriter::GetFormat("model.OBJ"), FileWriter::kObjFormat);
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,433 @@
+#include <gtest/gtest.h>
+
+#include <clocale>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "model/file_parser.h"
+#include "model/json_value.h"
+
+namespace ModelViewer3D {
+static void ExpectCubeVertices(const MeshData& mesh) {
+  ASSERT_EQ(mesh.vertices.size(), 24);
+  EXPECT_FLOAT_EQ(mesh.vertices[0], 1);
+  EXPECT_FLOAT_EQ(mesh.vertices[1], 1);
+  EXPECT_FLOAT_EQ(mesh.vertices[2], -1);
+  EXPECT_FLOAT_EQ(mesh.vertices[21], -1);
+  EXPECT_FLOAT_EQ(mesh.vertices[22], -1);
+  EXPECT_FLOAT_EQ(mesh.vertices[23], 1);
+}
+
+static void ExpectCubeQuads(const MeshData& mesh) {
+  ExpectCubeVertices(mesh);
+  EXPECT_EQ(mesh.polygons.size(), 48);
+  EXPECT_EQ(mesh.edges_count, 12);
+  EXPECT_EQ(mesh.polygons[0], 0);
+  EXPECT_EQ(mesh.polygons[1], 4);
+  EXPECT_EQ(mesh.polygons[2], 4);
+  EXPECT_EQ(mesh.polygons[3], 6);
+  EXPECT_EQ(mesh.polygons[6], 2);
+  EXPECT_EQ(mesh.polygons[7], 0);
+}
+
+TEST(load_testing, format_stl_binary) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.stl"), mesh);
+    // Welded vertices are numbered in order of the first appearance
+    ASSERT_EQ(mesh.vertices.size(), 24);
+    EXPECT_FLOAT_EQ(mesh.vertices[3], -1);
+    EXPECT_FLOAT_EQ(mesh.vertices[4], 1);
+    EXPECT_FLOAT_EQ(mesh.vertices[5], -1);
+    EXPECT_EQ(mesh.polygons.size(), 72);
+    EXPECT_EQ(mesh.edges_count, 18);
+    EXPECT_EQ(mesh.polygons[0], 0);
+    EXPECT_EQ(mesh.polygons[1], 1);
+    EXPECT_EQ(mesh.polygons[2], 1);
+    EXPECT_EQ(mesh.polygons[3], 2);
+    EXPECT_EQ(mesh.polygons[5], 0);
+    EXPECT_EQ(mesh.polygons[6], 0);
+    EXPECT_EQ(mesh.polygons[9], 3);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_stl_ascii) {
+  FileParser parser;
+  MeshData binary, ascii;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.stl"), binary);
+    parser.ParseFile(std::string("test/model/test_data/cube_ascii.stl"),
+                     ascii);
+    EXPECT_EQ(ascii.vertices, binary.vertices);
+    EXPECT_EQ(ascii.polygons, binary.polygons);
+    EXPECT_EQ(ascii.edges_count, binary.edges_count);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_ply_ascii) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.ply"), mesh);
+    ExpectCubeQuads(mesh);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_ply_binary) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube_binary.ply"),
+                     mesh);
+    ExpectCubeQuads(mesh);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_ply_big_endian) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube_big_endian.ply"),
+                     mesh);
+    ExpectCubeQuads(mesh);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_ply_invalid_index) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/invalid_index.ply"),
+                     mesh);
+    FAIL() << std::string("Expected: error");
+  } catch (std::exception& exc) {
+    SUCCEED();
+  }
+}
+
+TEST(load_testing, format_ply_invalid_count) {
+  FileParser parser;
+
+  // Counts which can not fit into the file are rejected before allocation
+  for (const char* file : {"test/model/test_data/invalid_count.ply",
+                           "test/model/test_data/negative_count.ply"}) {
+    MeshData mesh;
+
+    try {
+      parser.ParseFile(std::string(file), mesh);
+      FAIL() << std::string("Expected: error: ") + file;
+    } catch (std::runtime_error& exc) {
+      EXPECT_EQ(std::string(exc.what()), "Corupted format of PLY file");
+    }
+  }
+}
+
+TEST(load_testing, format_ply_invalid_integers) {
+  const std::string kHeader =
+      "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\n"
+      "property float y\nproperty float z\nelement face 1\n"
+      "property list uchar int vertex_indices\nend_header\n"
+      "0 0 0\n1 0 0\n0 1 0\n";
+  // Counts and indices of integer types are not truncated or wrapped
+  const char* kFaces[] = {"3.7 0 1 2\n", "3 0 1.9 2\n", "-3 0 1 2\n",
+                          "nan 0 1 2\n", "300 0 1 2\n"};
+  std::string path =
+      (std::filesystem::temp_directory_path() / "integers.ply").string();
+  FileParser parser;
+
+  for (const char* face : kFaces) {
+    std::ofstream(path) << kHeader << face;
+    MeshData mesh;
+
+    try {
+      parser.ParseFile(path, mesh);
+      ADD_FAILURE() << "Expected: error: " << face;
+    } catch (std::runtime_error& exc) {
+      EXPECT_EQ(std::string(exc.what()), "Corupted format of PLY file");
+    }
+  }
+
+  std::ofstream(path) << kHeader << "3 0 1 2\n";
+  MeshData mesh;
+  try {
+    parser.ParseFile(path, mesh);
+    EXPECT_EQ(mesh.polygons.size(), 6);
+  } catch (std::exception& exc) {
+    ADD_FAILURE() << "Expected: no error: " << exc.what();
+  }
+  std::remove(path.c_str());
+}
+
+TEST(load_testing, format_gltf_glb) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.glb"), mesh);
+    // Mesh is placed by the translation of the child node
+    ASSERT_EQ(mesh.vertices.size(), 24);
+    EXPECT_FLOAT_EQ(mesh.vertices[0], 1);
+    EXPECT_FLOAT_EQ(mesh.vertices[1], 1);
+    EXPECT_FLOAT_EQ(mesh.vertices[2], 1);
+    EXPECT_FLOAT_EQ(mesh.vertices[23], 3);
+    EXPECT_EQ(mesh.polygons.size(), 72);
+    EXPECT_EQ(mesh.edges_count, 18);
+    EXPECT_EQ(mesh.polygons[0], 0);
+    EXPECT_EQ(mesh.polygons[1], 4);
+    EXPECT_EQ(mesh.polygons[3], 6);
+    EXPECT_EQ(mesh.polygons[5], 0);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_gltf_buffers) {
+  FileParser parser;
+  MeshData embedded, external;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.gltf"), embedded);
+    parser.ParseFile(std::string("test/model/test_data/cube_external.gltf"),
+                     external);
+    ExpectCubeVertices(embedded);
+    EXPECT_EQ(embedded.polygons.size(), 72);
+    EXPECT_EQ(embedded.edges_count, 18);
+    ASSERT_EQ(external.vertices.size(), 24);
+    EXPECT_FLOAT_EQ(external.vertices[0], 2);
+    EXPECT_FLOAT_EQ(external.vertices[23], 2);
+    EXPECT_EQ(external.polygons, embedded.polygons);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_gltf_invalid_nodes) {
+  FileParser parser;
+
+  // Shared nodes are not expanded and indices must be non negative integers
+  for (const char* file :
+       {"test/model/test_data/invalid_shared_nodes.gltf",
+        "test/model/test_data/invalid_negative_index.gltf",
+        "test/model/test_data/invalid_fractional_index.gltf"}) {
+    MeshData mesh;
+
+    try {
+      parser.ParseFile(std::string(file), mesh);
+      FAIL() << std::string("Expected: error: ") + file;
+    } catch (std::runtime_error& exc) {
+      EXPECT_EQ(std::string(exc.what()), "Corupted format of GLTF file");
+    }
+  }
+}
+
+TEST(load_testing, format_gltf_invalid_sizes) {
+  FileParser parser;
+
+  // Views larger than buffers fail before accessors are allocated
+  for (const char* file : {"test/model/test_data/invalid_view_length.gltf",
+                           "test/model/test_data/invalid_indices_count.gltf"}) {
+    MeshData mesh;
+
+    try {
+      parser.ParseFile(std::string(file), mesh);
+      FAIL() << std::string("Expected: error: ") + file;
+    } catch (std::runtime_error& exc) {
+      EXPECT_EQ(std::string(exc.what()), "Corupted format of GLTF file");
+    }
+  }
+}
+
+TEST(load_testing, format_gltf_invalid_chunks) {
+  FileParser parser;
+
+  // Chunks longer than the container are not read
+  for (const char* file : {"test/model/test_data/invalid_json_chunk.glb",
+                           "test/model/test_data/invalid_bin_chunk.glb"}) {
+    MeshData mesh;
+
+    try {
+      parser.ParseFile(std::string(file), mesh);
+      FAIL() << std::string("Expected: error: ") + file;
+    } catch (std::runtime_error& exc) {
+      EXPECT_EQ(std::string(exc.what()), "Corupted format of GLB file");
+    }
+  }
+}
+
+TEST(load_testing, format_compressed_gzip) {
+  FileParser parser;
+  MeshData plain, compressed, members;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.obj"), plain);
+    parser.ParseFile(std::string("test/model/test_data/cube.obj.gz"),
+                     compressed);
+    parser.ParseFile(std::string("test/model/test_data/cube_members.obj.gz"),
+                     members);
+    EXPECT_EQ(compressed.vertices, plain.vertices);
+    EXPECT_EQ(compressed.polygons, plain.polygons);
+    EXPECT_EQ(compressed.edges_count, plain.edges_count);
+    EXPECT_EQ(members.vertices, plain.vertices);
+    EXPECT_EQ(members.polygons, plain.polygons);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_compressed_truncated) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(
+        std::string("test/model/test_data/invalid_truncated.obj.gz"), mesh);
+    FAIL() << std::string("Expected: error");
+  } catch (std::exception& exc) {
+    SUCCEED();
+  }
+}
+
+TEST(load_testing, format_compressed_zstd) {
+  FileParser parser;
+  MeshData plain, compressed;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.obj"), plain);
+    parser.ParseFile(std::string("test/model/test_data/cube.obj.zst"),
+                     compressed);
+#ifdef MODEL_VIEWER_ZSTD
+    EXPECT_EQ(compressed.vertices, plain.vertices);
+    EXPECT_EQ(compressed.polygons, plain.polygons);
+#else
+    FAIL() << std::string("Expected: error");
+#endif  // MODEL_VIEWER_ZSTD
+  } catch (std::exception& exc) {
+#ifdef MODEL_VIEWER_ZSTD
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+#else
+    EXPECT_EQ(std::string(exc.what()),
+              "Zstandard compression is not supported");
+#endif  // MODEL_VIEWER_ZSTD
+  }
+}
+
+TEST(load_testing, format_sniff_misnamed) {
+  FileParser parser;
+  MeshData ply, obj, stl;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/misnamed_ply.obj"), ply);
+    parser.ParseFile(std::string("test/model/test_data/misnamed_obj.dat"), obj);
+    parser.ParseFile(std::string("test/model/test_data/misnamed_stl.txt"), stl);
+    ExpectCubeQuads(ply);
+    EXPECT_EQ(obj.vertices.size(), 15);
+    EXPECT_EQ(obj.polygons.size(), 24);
+    EXPECT_EQ(stl.polygons.size(), 72);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_sniff_unknown_statements) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(
+        std::string("test/model/test_data/unknown_statements.obj"), mesh);
+    EXPECT_EQ(mesh.vertices.size(), 9);
+    EXPECT_EQ(mesh.polygons.size(), 6);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, format_sniff_text) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(
+        std::string("test/model/test_data/invalid_fileformat.notobj"), mesh);
+    FAIL() << std::string("Expected: error");
+  } catch (std::exception& exc) {
+    EXPECT_EQ(std::string(exc.what()), "No parser for this filetype");
+  }
+}
+TEST(load_testing, format_comma_locale) {
+  // GUI applications take LC_NUMERIC from the environment
+  const char* kCommaLocales[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE",
+                                 "ru_RU.UTF-8", "fr_FR.UTF-8", "German"};
+  std::string previous = std::setlocale(LC_NUMERIC, nullptr);
+  bool is_comma = false;
+  for (const char* name : kCommaLocales) {
+    if (!is_comma && std::setlocale(LC_NUMERIC, name)) {
+      is_comma = std::localeconv()->decimal_point[0] == ',';
+    }
+  }
+  if (!is_comma) {
+    std::setlocale(LC_NUMERIC, previous.c_str());
+    GTEST_SKIP() << "No locale with the decimal comma";
+  }
+
+  const std::string kVertices = "0.5 -1.25 2.75\n1.5 0 0\n0 1.5 0\n";
+  const std::pair<std::string, std::string> kFiles[] = {
+      {"comma_locale.obj",
+       "v 0.5 -1.25 2.75\nv 1.5 0 0\nv 0 1.5 0\nf 1 2 3\n"},
+      {"comma_locale.stl",
+       "solid t\nfacet normal 0 0 1\nouter loop\nvertex 0.5 -1.25 2.75\n"
+       "vertex 1.5 0 0\nvertex 0 1.5 0\nendloop\nendfacet\nendsolid t\n"},
+      {"comma_locale.ply",
+       "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\n"
+       "property float y\nproperty float z\nelement face 1\n"
+       "property list uchar int vertex_indices\nend_header\n" +
+           kVertices + "3 0 1 2\n"}};
+
+  FileParser parser;
+  for (const auto& [name, text] : kFiles) {
+    std::string path =
+        (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream(path) << text;
+
+    MeshData mesh;
+    try {
+      parser.ParseFile(path, mesh);
+      ASSERT_EQ(mesh.vertices.size(), 9) << name;
+      EXPECT_FLOAT_EQ(mesh.vertices[0], 0.5f) << name;
+      EXPECT_FLOAT_EQ(mesh.vertices[1], -1.25f) << name;
+      EXPECT_FLOAT_EQ(mesh.vertices[2], 2.75f) << name;
+      EXPECT_FLOAT_EQ(mesh.vertices[3], 1.5f) << name;
+    } catch (std::exception& exc) {
+      ADD_FAILURE() << name << ": expected no error: " << exc.what();
+    }
+    std::remove(path.c_str());
+  }
+
+  const char kJson[] = "[1.25, -0.5e1]";
+  JsonValue json = JsonValue::Parse(kJson, kJson + sizeof(kJson) - 1);
+  EXPECT_DOUBLE_EQ(json[size_t(0)].AsNumber(), 1.25);
+  EXPECT_DOUBLE_EQ(json[size_t(1)].AsNumber(), -5);
+
+  std::setlocale(LC_NUMERIC, previous.c_str());
+}
+}  // namespace ModelViewer3D
@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 #include <vector>
 
+#include "model/chunked_obj_parser.h"
 #include "model/file_parser.h"
+#include "model/mesh_cache.h"
+#include "model/model.h"
+#include "model/spill_buffer.h"
+#include "test/model/mesh_helpers.h"
 
 namespace ModelViewer3D {
 
@@ -240,4 +251,446 @@ TEST(load_testing, invalid_vertices_8) {
     SUCCEED();
   }
 }
+TEST(load_testing, attributes_1_cube) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/cube.obj"), mesh);
+    EXPECT_EQ(mesh.vertices.size(), 24);
+    EXPECT_EQ(mesh.polygons.size(), 48);
+    EXPECT_EQ(mesh.edges_count, 12);
+    EXPECT_EQ(mesh.normals.size(), 18);
+    EXPECT_EQ(mesh.tex_coords.size(), 28);
+    EXPECT_FLOAT_EQ(mesh.normals[1], 1);
+    EXPECT_FLOAT_EQ(mesh.normals[5], 1);
+    EXPECT_FLOAT_EQ(mesh.tex_coords[0], 0.625);
+    EXPECT_FLOAT_EQ(mesh.tex_coords[1], 0.5);
+    ASSERT_EQ(mesh.tex_coord_indices.size(), 24);
+    ASSERT_EQ(mesh.normal_indices.size(), 24);
+    EXPECT_EQ(mesh.tex_coord_indices[0], 0);
+    EXPECT_EQ(mesh.normal_indices[3], 0);
+    EXPECT_EQ(mesh.normal_indices[4], 1);
+    ASSERT_EQ(mesh.groups.size(), 1);
+    EXPECT_EQ(mesh.groups[0].name, "Cube");
+    EXPECT_EQ(mesh.groups[0].first_index, 0);
+    EXPECT_EQ(mesh.groups[0].indices_count, 48);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, attributes_2_groups) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/groups.obj"), mesh);
+    EXPECT_EQ(mesh.polygons.size(), 18);
+    ASSERT_EQ(mesh.tex_coords.size(), 4);
+    EXPECT_FLOAT_EQ(mesh.tex_coords[2], 1);
+    EXPECT_FLOAT_EQ(mesh.tex_coords[3], 0);
+    EXPECT_EQ(mesh.normals.size(), 3);
+    // The last face has no texture coordinates and normals
+    std::vector<polygonType> tex_coord_indices = {
+        0, 1, 0, 0, 0, 1, MeshData::kNoIndex, MeshData::kNoIndex,
+        MeshData::kNoIndex};
+    EXPECT_EQ(mesh.tex_coord_indices, tex_coord_indices);
+    ASSERT_EQ(mesh.normal_indices.size(), 9);
+    EXPECT_EQ(mesh.normal_indices[5], 0);
+    EXPECT_EQ(mesh.normal_indices[6], MeshData::kNoIndex);
+    ASSERT_EQ(mesh.groups.size(), 3);
+    EXPECT_EQ(mesh.groups[0].name, "First");
+    EXPECT_EQ(mesh.groups[0].material, "Red");
+    EXPECT_EQ(mesh.groups[0].first_index, 0);
+    EXPECT_EQ(mesh.groups[0].indices_count, 6);
+    EXPECT_EQ(mesh.groups[1].name, "First");
+    EXPECT_EQ(mesh.groups[1].material, "Blue");
+    EXPECT_EQ(mesh.groups[1].first_index, 6);
+    EXPECT_EQ(mesh.groups[1].indices_count, 6);
+    EXPECT_EQ(mesh.groups[2].name, "Second");
+    EXPECT_EQ(mesh.groups[2].material, "Green");
+    EXPECT_EQ(mesh.groups[2].first_index, 12);
+    EXPECT_EQ(mesh.groups[2].indices_count, 6);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, attributes_3_absent) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/valid2.obj"), mesh);
+    EXPECT_EQ(mesh.vertices.size(), 15);
+    EXPECT_EQ(mesh.tex_coords.capacity(), 0);
+    EXPECT_EQ(mesh.normals.capacity(), 0);
+    EXPECT_TRUE(mesh.groups.empty());
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, attributes_4_corners) {
+  FileParser parser;
+  ChunkedObjParser chunked_parser;
+  MeshData mesh, reloaded;
+  const polygonType kNo = MeshData::kNoIndex;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/corners.obj"), mesh);
+    // Negative indices count back from the line, broken ones are dropped
+    std::vector<polygonType> tex_coord_indices = {0, 1, kNo, 2, 2, kNo};
+    std::vector<polygonType> normal_indices = {0, kNo, 0, 0, kNo, 0};
+    EXPECT_EQ(mesh.tex_coord_indices, tex_coord_indices);
+    EXPECT_EQ(mesh.normal_indices, normal_indices);
+
+    chunked_parser.Reload("test/model/test_data/corners.obj", reloaded);
+    EXPECT_EQ(reloaded.tex_coord_indices, tex_coord_indices);
+    EXPECT_EQ(reloaded.normal_indices, normal_indices);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, attributes_5_decimal_indices) {
+  std::string text;
+  for (int i = 0; i < 10; ++i) {
+    text += "v " + std::to_string(i) + " 0 0\nvt 0 0\nvn 0 0 1\n";
+  }
+  // Leading zeros do not switch indices of any kind to octal
+  text += "f 010/010/010 08/08/08 09/09/09\n";
+  std::string path =
+      (std::filesystem::temp_directory_path() / "decimal.obj").string();
+  std::ofstream(path) << text;
+
+  FileParser parser;
+  ChunkedObjParser chunked_parser;
+  MeshData mesh, reloaded;
+
+  try {
+    parser.ParseFile(path, mesh);
+    std::vector<polygonType> indices = {9, 7, 8};
+    ASSERT_EQ(mesh.polygons.size(), 6);
+    EXPECT_EQ(mesh.polygons[0], 9);
+    EXPECT_EQ(mesh.polygons[1], 7);
+    EXPECT_EQ(mesh.polygons[3], 8);
+    EXPECT_EQ(mesh.tex_coord_indices, indices);
+    EXPECT_EQ(mesh.normal_indices, indices);
+
+    chunked_parser.Reload(path, reloaded);
+    EXPECT_EQ(reloaded.polygons, mesh.polygons);
+    EXPECT_EQ(reloaded.tex_coord_indices, indices);
+  } catch (std::exception& exc) {
+    ADD_FAILURE() << "Expected: no error: " << exc.what();
+  }
+  std::remove(path.c_str());
+}
+
+TEST(load_testing, memory_budget_spill) {
+  FileParser parser;
+  MeshData in_memory, spilled;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/valid2.obj"),
+                     in_memory);
+    // Any budget is exceeded, buffers of the counted file stay in memory
+    parser.SetMemoryBudget(1);
+    parser.ParseFile(std::string("test/model/test_data/valid2.obj"), spilled);
+    EXPECT_EQ(spilled.vertices, in_memory.vertices);
+    EXPECT_EQ(spilled.polygons, in_memory.polygons);
+    EXPECT_EQ(spilled.edges_count, in_memory.edges_count);
+
+    // Buffers of the compressed file grow through temporary files
+    MeshData plain, compressed;
+    parser.ParseFile(std::string("test/model/test_data/cube.obj"), plain);
+    parser.ParseFile(std::string("test/model/test_data/cube.obj.gz"),
+                     compressed);
+    EXPECT_EQ(compressed.vertices, plain.vertices);
+    EXPECT_EQ(compressed.polygons, plain.polygons);
+
+    SpillBuffer<polygonType> buffer(1 << 12);
+    for (polygonType i = 0; i < (1 << 12); ++i) {
+      buffer.push_back(i);
+    }
+    EXPECT_EQ(buffer.IsSpilled(), SpillFile::kIsSupported);
+    buffer.MoveTo(spilled.polygons);
+    EXPECT_EQ(spilled.polygons.size(), in_memory.polygons.size() + (1 << 12));
+    EXPECT_EQ(spilled.polygons.back(), (1 << 12) - 1);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, prescan_exact_capacity) {
+  FileParser parser;
+  MeshData mesh;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/groups.obj"), mesh);
+    EXPECT_EQ(mesh.vertices.capacity(), mesh.vertices.size());
+    EXPECT_EQ(mesh.polygons.capacity(), mesh.polygons.size());
+    EXPECT_EQ(mesh.normals.capacity(), mesh.normals.size());
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+static void ExpectEqualMeshes(const MeshData& result,
+                              const MeshData& expected) {
+  EXPECT_EQ(result.vertices, expected.vertices);
+  EXPECT_EQ(result.polygons, expected.polygons);
+  EXPECT_EQ(result.edges_count, expected.edges_count);
+  EXPECT_EQ(result.normals, expected.normals);
+  EXPECT_EQ(result.tex_coord_indices, expected.tex_coord_indices);
+  EXPECT_EQ(result.normal_indices, expected.normal_indices);
+  ASSERT_EQ(result.groups.size(), expected.groups.size());
+  for (size_t i = 0; i < result.groups.size(); ++i) {
+    EXPECT_EQ(result.groups[i].name, expected.groups[i].name);
+    EXPECT_EQ(result.groups[i].material, expected.groups[i].material);
+    EXPECT_EQ(result.groups[i].first_index, expected.groups[i].first_index);
+    EXPECT_EQ(result.groups[i].indices_count,
+              expected.groups[i].indices_count);
+  }
+}
+
+static void WriteChunkedModel(const std::string& filename, int changed_line) {
+  std::ofstream file(filename);
+  const int kVerticesCount = 20000;
+
+  for (int i = 0; i < kVerticesCount; ++i) {
+    if (i % 1000 == 0) {
+      file << "o part_" << i / 1000 << "\n";
+    }
+    file << "v " << i << " " << (i == changed_line ? 7 : i % 13) << " 1\n";
+    if (i % 4 == 3) {
+      file << "usemtl material_" << i % 3 << "\n";
+      file << "f " << i - 2 << " " << i - 1 << " " << i << " -1\n";
+    }
+  }
+}
+
+TEST(load_testing, reload_1_groups) {
+  FileParser parser;
+  ChunkedObjParser chunked_parser;
+  MeshData expected, result, other_format;
+
+  try {
+    parser.ParseFile(std::string("test/model/test_data/groups.obj"), expected);
+    EXPECT_TRUE(
+        chunked_parser.Reload("test/model/test_data/groups.obj", result));
+    ExpectEqualMeshes(result, expected);
+    EXPECT_FALSE(
+        chunked_parser.Reload("test/model/test_data/cube.ply", other_format));
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, reload_2_changed_chunk) {
+  FileParser parser;
+  ChunkedObjParser chunked_parser;
+  MeshData expected, result;
+  std::string filename =
+      (std::filesystem::temp_directory_path() / "reload_test.obj").string();
+
+  try {
+    WriteChunkedModel(filename, -1);
+    chunked_parser.Reload(filename, result);
+    size_t chunks_count = chunked_parser.GetParsedCount();
+    EXPECT_GT(chunks_count, 4);
+    EXPECT_EQ(chunked_parser.GetReusedCount(), 0);
+
+    // Only the chunk with the changed line is parsed again
+    WriteChunkedModel(filename, 10000);
+    chunked_parser.Reload(filename, result);
+    parser.ParseFile(filename, expected);
+    EXPECT_LE(chunked_parser.GetParsedCount(), 2);
+    EXPECT_GE(chunked_parser.GetReusedCount(), chunks_count - 2);
+    EXPECT_FLOAT_EQ(result.vertices[10000 * 3 + 1], 7);
+    ExpectEqualMeshes(result, expected);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(load_testing, cache_1_lru) {
+  FileParser parser;
+  std::string cube("test/model/test_data/cube.obj");
+  std::string banana("obj_files/banana.obj");
+  std::string filename =
+      (std::filesystem::temp_directory_path() / "cache_test.obj").string();
+
+  try {
+    auto cube_mesh = std::make_shared<MeshData>();
+    auto banana_mesh = std::make_shared<MeshData>();
+    parser.ParseFile(cube, *cube_mesh);
+    parser.ParseFile(banana, *banana_mesh);
+    size_t cube_size = MeshCache::GetMeshSize(*cube_mesh);
+    size_t banana_size = MeshCache::GetMeshSize(*banana_mesh);
+
+    // Only one of the models fits the budget
+    MeshCache cache(std::max(cube_size, banana_size) + 1);
+    cache.Insert(cube, MeshCache::GetStamp(cube), cube_mesh);
+    EXPECT_EQ(cache.Find(cube), cube_mesh);
+    cache.Insert(banana, MeshCache::GetStamp(banana), banana_mesh);
+    EXPECT_EQ(cache.Find(banana), banana_mesh);
+    EXPECT_EQ(cache.Find(cube), nullptr);
+    EXPECT_EQ(cache.GetUsedSize(), banana_size);
+
+    // Changed file is parsed again
+    std::filesystem::copy_file(
+        cube, filename, std::filesystem::copy_options::overwrite_existing);
+    cache.Insert(filename, MeshCache::GetStamp(filename), cube_mesh);
+    EXPECT_EQ(cache.Find(filename), cube_mesh);
+    std::ofstream(filename, std::ios::app) << "v 1 2 3\n";
+    EXPECT_EQ(cache.Find(filename), nullptr);
+    EXPECT_EQ(cache.GetCount(), 0);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(load_testing, cache_2_preload) {
+  FileParser parser;
+  MeshCache cache;
+  std::string cube("test/model/test_data/cube.obj");
+  std::string banana("obj_files/banana.obj");
+  std::string invalid("test/model/test_data/invalid_bad_face.obj");
+
+  try {
+    cache.Preload({cube, invalid, banana, "test/model/test_data/none.obj"});
+    cache.WaitPreload();
+    EXPECT_EQ(cache.GetCount(), 2);
+    EXPECT_EQ(cache.Find(invalid), nullptr);
+
+    MeshData expected;
+    parser.ParseFile(banana, expected);
+    std::shared_ptr<const MeshData> result = cache.Find(banana);
+    ASSERT_NE(result, nullptr);
+    ExpectEqualMeshes(*result, expected);
+
+    // Disabled cache drops models
+    cache.SetBudget(0);
+    EXPECT_EQ(cache.Find(cube), nullptr);
+    EXPECT_EQ(cache.GetUsedSize(), 0);
+
+    // File larger than the budget on disk is skipped without parse
+    MeshCache small_cache(MeshCache::GetStamp(banana).size - 1);
+    small_cache.Preload({banana, cube});
+    small_cache.WaitPreload();
+    EXPECT_EQ(small_cache.GetCount(), 1);
+    EXPECT_EQ(small_cache.Find(banana), nullptr);
+    small_cache.SetBudget(MeshCache::GetMeshSize(expected) - 1);
+    EXPECT_FALSE(small_cache.Fits(expected));
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, triangulate_faces) {
+  // Quad, triangle and degenerate face of two vertices
+  std::vector<polygonType> polygons = {0, 1, 1, 2, 2, 3, 3, 0, 4,
+                                       5, 5, 6, 6, 4, 7, 8, 8, 7};
+  std::vector<polygonType> triangles;
+  Model::Triangulate(polygons, triangles);
+  std::vector<polygonType> expected = {0, 1, 2, 0, 2, 3, 4, 5, 6};
+  EXPECT_EQ(triangles, expected);
+
+  Model model;
+  try {
+    model.Load("test/model/test_data/cube.obj");
+    EXPECT_EQ(model.GetTrianglesIndicesCount(), 0);
+
+    // Six quads give twelve triangles
+    model.SetKeepTriangles(true);
+    EXPECT_EQ(model.GetTrianglesIndicesCount(), 36);
+
+    model.Load("test/model/test_data/cube.obj");
+    EXPECT_EQ(model.GetTrianglesIndicesCount(), 36);
+    for (unsigned int i = 0; i < 36; ++i) {
+      EXPECT_LT(model.GetTriangles()[i], model.GetVerticesCount());
+    }
+
+    model.SetKeepTriangles(false);
+    EXPECT_EQ(model.GetTrianglesIndicesCount(), 0);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, surface_normals) {
+  Model model;
+  try {
+    model.SetKeepTriangles(true);
+    model.SetSurfaceNormals(kFlatNormals);
+    model.Load("test/model/test_data/cube.obj");
+    model.RotateX(0.5);
+
+    // Faces of the cube centered at the origin look outward
+    ASSERT_EQ(model.GetSurfaceNormalsCount(), 12);
+    for (unsigned int i = 0; i < 12; ++i) {
+      const vertexType* normal = model.GetSurfaceNormals() + i * 3;
+      const vertexType* vertex =
+          model.GetVertices() + model.GetTriangles()[i * 3] * 3;
+      EXPECT_NEAR(std::hypot(normal[0], normal[1], normal[2]), 1, 1e-5);
+      EXPECT_NEAR(normal[0] * vertex[0] + normal[1] * vertex[1] +
+                      normal[2] * vertex[2],
+                  1, 1e-5);
+    }
+
+    // Three faces meet at right angles at every corner
+    model.SetSurfaceNormals(kSmoothNormals);
+    ASSERT_EQ(model.GetSurfaceNormalsCount(), 8);
+    for (unsigned int i = 0; i < 8; ++i) {
+      const vertexType* normal = model.GetSurfaceNormals() + i * 3;
+      const vertexType* vertex = model.GetVertices() + i * 3;
+      for (int j = 0; j < 3; ++j) {
+        EXPECT_NEAR(normal[j], vertex[j] / std::sqrt(3.0f), 1e-5);
+      }
+    }
+
+    model.SetSurfaceNormals(kNoNormals);
+    EXPECT_EQ(model.GetSurfaceNormalsCount(), 0);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
+
+TEST(load_testing, surface_normals_parallel) {
+  ThreadPool pool(4);
+  ThreadPool single_pool(1);
+  Model parallel, serial;
+  parallel.SetThreadPool(&pool);
+  serial.SetThreadPool(&single_pool);
+
+  // Curved grid with more vertices than the parallel threshold
+  MeshData grid = MakeGrid(300);
+
+  for (SurfaceNormals mode : {kFlatNormals, kSmoothNormals}) {
+    for (Model* model : {&parallel, &serial}) {
+      MeshData mesh = grid;
+      model->SetKeepTriangles(true);
+      model->SetSurfaceNormals(mode);
+      model->SetMesh(mesh);
+      model->RotateY(1);
+    }
+
+    ASSERT_GT(parallel.GetSurfaceNormalsCount(), 0);
+    ASSERT_EQ(parallel.GetSurfaceNormalsCount(),
+              serial.GetSurfaceNormalsCount());
+    std::vector<vertexType> parallel_normals(
+        parallel.GetSurfaceNormals(),
+        parallel.GetSurfaceNormals() + parallel.GetSurfaceNormalsCount() * 3);
+    std::vector<vertexType> serial_normals(
+        serial.GetSurfaceNormals(),
+        serial.GetSurfaceNormals() + serial.GetSurfaceNormalsCount() * 3);
+    EXPECT_EQ(parallel_normals, serial_normals);
+  }
+}
 }  // namespace ModelViewer3D
@@ -0,0 +1,43 @@
+/** @file
+ * @brief Meshes generated for tests
+ */
+#ifndef SRC_TEST_MODEL_MESH_HELPERS_H_
+#define SRC_TEST_MODEL_MESH_HELPERS_H_
+
+#include <cstddef>
+
+#include "model/mesh_data.h"
+
+namespace ModelViewer3D {
+/** @brief Curved grid of quads with more vertices and polygons than one
+ * block
+ */
+inline MeshData MakeGrid(size_t side) {
+  MeshData mesh;
+
+  for (size_t y = 0; y < side; ++y) {
+    for (size_t x = 0; x < side; ++x) {
+      mesh.vertices.push_back(x * 0.1f);
+      mesh.vertices.push_back(y * 0.3f);
+      mesh.vertices.push_back(-1.0f / (x + y + 1));
+    }
+  }
+
+  for (size_t y = 0; y + 1 < side; ++y) {
+    for (size_t x = 0; x + 1 < side; ++x) {
+      polygonType face[4] = {
+          polygonType(y * side + x), polygonType(y * side + x + 1),
+          polygonType((y + 1) * side + x + 1), polygonType((y + 1) * side + x)};
+
+      for (int i = 0; i < 4; ++i) {
+        mesh.polygons.push_back(face[i]);
+        mesh.polygons.push_back(face[(i + 1) % 4]);
+      }
+    }
+  }
+
+  return mesh;
+}
+}  // namespace ModelViewer3D
+
+#endif  // SRC_TEST_MODEL_MESH_HELPERS_H_
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "model/software_rasterizer.h"
+#include "model/thread_pool.h"
+
+namespace ModelViewer3D {
+static const float kIdentity[16] = {1, 0, 0, 0, 0, 1, 0, 0,
+                                    0, 0, 1, 0, 0, 0, 0, 1};
+static const uint32_t kBackground = 0xFFFFFFFF;
+static const uint32_t kRed = 0xFFFF0000;
+static const uint32_t kBlue = 0xFF0000FF;
+
+/** @brief Vertex at the window position of the identity projection */
+static void AddWindowVertex(std::vector<vertexType>& vertices,
+                            const SoftwareRasterizer& rasterizer, float x,
+                            float y, float z) {
+  vertices.push_back(x / rasterizer.GetWidth() * 2 - 1);
+  vertices.push_back(y / rasterizer.GetHeight() * 2 - 1);
+  vertices.push_back(z);
+}
+
+static size_t CountPixels(const SoftwareRasterizer& rasterizer,
+                          uint32_t color) {
+  size_t count = 0;
+  size_t size = size_t(rasterizer.GetWidth()) * rasterizer.GetHeight();
+  for (size_t i = 0; i < size; ++i) {
+    count += rasterizer.GetPixels()[i] == color;
+  }
+  return count;
+}
+
+TEST(rasterizer_testing, line_across_tiles) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(200, 100);
+  rasterizer.Clear(kBackground);
+  rasterizer.SetMatrix(kIdentity);
+
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 10.2f, 50.5f, 0);
+  AddWindowVertex(vertices, rasterizer, 190.2f, 50.5f, 0);
+  std::vector<polygonType> indices = {0, 1};
+  rasterizer.SetGeometry(vertices.data(), 2);
+  rasterizer.DrawLines(indices.data(), indices.size(), kRed, 1);
+
+  // Pixels with centers in [10.2, 190.2), the row from the top is 49
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 180);
+  const uint32_t* row = rasterizer.GetPixels() + 49 * 200;
+  EXPECT_EQ(row[9], kBackground);
+  EXPECT_EQ(row[10], kRed);
+  EXPECT_EQ(row[189], kRed);
+  EXPECT_EQ(row[190], kBackground);
+  EXPECT_FLOAT_EQ(rasterizer.GetDepth(100, 49), 0.5f);
+}
+
+TEST(rasterizer_testing, depth_test) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(100, 100);
+  rasterizer.SetMatrix(kIdentity);
+
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 0, 50.5f, 0.5f);
+  AddWindowVertex(vertices, rasterizer, 100, 50.5f, 0.5f);
+  AddWindowVertex(vertices, rasterizer, 50.5f, 0, -0.5f);
+  AddWindowVertex(vertices, rasterizer, 50.5f, 100, -0.5f);
+  std::vector<polygonType> far_line = {0, 1};
+  std::vector<polygonType> near_line = {2, 3};
+  rasterizer.SetGeometry(vertices.data(), 4);
+
+  // Nearer vertical line wins at the crossing in any order of drawing
+  for (int order = 0; order < 2; ++order) {
+    rasterizer.Clear(kBackground);
+    if (order == 0) {
+      rasterizer.DrawLines(far_line.data(), 2, kRed, 1);
+      rasterizer.DrawLines(near_line.data(), 2, kBlue, 1);
+    } else {
+      rasterizer.DrawLines(near_line.data(), 2, kBlue, 1);
+      rasterizer.DrawLines(far_line.data(), 2, kRed, 1);
+    }
+
+    EXPECT_EQ(rasterizer.GetPixels()[49 * 100 + 50], kBlue);
+    EXPECT_EQ(CountPixels(rasterizer, kBlue), 100);
+    EXPECT_EQ(CountPixels(rasterizer, kRed), 99);
+  }
+}
+
+TEST(rasterizer_testing, parallel_tiles) {
+  ThreadPool pool(4);
+  ThreadPool single_pool(1);
+  SoftwareRasterizer parallel, serial;
+  parallel.SetThreadPool(&pool);
+  serial.SetThreadPool(&single_pool);
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> coordinate(-1.5f, 1.5f);
+  std::vector<vertexType> vertices(3 * 5000);
+  for (vertexType& value : vertices) value = coordinate(generator);
+  std::vector<polygonType> indices;
+  for (polygonType i = 0; i + 1 < 5000; ++i) {
+    indices.push_back(i);
+    indices.push_back(i + 1);
+  }
+
+  for (SoftwareRasterizer* rasterizer : {&parallel, &serial}) {
+    rasterizer->Resize(317, 251);
+    rasterizer->Clear(kBackground);
+    rasterizer->SetMatrix(kIdentity);
+    rasterizer->SetGeometry(vertices.data(), 5000);
+    rasterizer->DrawPoints(kBlue, 4, true);
+    rasterizer->DrawLines(indices.data(), indices.size(), kRed, 3, 0x00FF, 2);
+  }
+
+  std::vector<uint32_t> parallel_pixels(parallel.GetPixels(),
+                                        parallel.GetPixels() + 317 * 251);
+  std::vector<uint32_t> serial_pixels(serial.GetPixels(),
+                                      serial.GetPixels() + 317 * 251);
+  EXPECT_EQ(parallel_pixels, serial_pixels);
+  EXPECT_GT(CountPixels(parallel, kRed), 0);
+  EXPECT_GT(CountPixels(parallel, kBlue), 0);
+}
+
+TEST(rasterizer_testing, dash_pattern) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(64, 8);
+  rasterizer.Clear(kBackground);
+  rasterizer.SetMatrix(kIdentity);
+
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 0, 4.5f, 0);
+  AddWindowVertex(vertices, rasterizer, 64, 4.5f, 0);
+  std::vector<polygonType> indices = {0, 1};
+  rasterizer.SetGeometry(vertices.data(), 2);
+  rasterizer.DrawLines(indices.data(), 2, kRed, 1, 0x000F, 2);
+
+  // Four bits of eight pixels are drawn, then twelve bits are skipped
+  const uint32_t* row = rasterizer.GetPixels() + 3 * 64;
+  for (int x = 0; x < 64; ++x) {
+    EXPECT_EQ(row[x], x % 32 < 8 ? kRed : kBackground) << "x = " << x;
+  }
+}
+
+TEST(rasterizer_testing, points) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(100, 100);
+  rasterizer.SetMatrix(kIdentity);
+
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 50.5f, 50.5f, 0);
+  rasterizer.SetGeometry(vertices.data(), 1);
+
+  rasterizer.Clear(kBackground);
+  rasterizer.DrawPoints(kRed, 3, false);
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 9);
+
+  rasterizer.Clear(kBackground);
+  rasterizer.DrawPoints(kRed, 5, true);
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 21);
+}
+
+TEST(rasterizer_testing, near_plane_clipping) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(100, 100);
+  rasterizer.Clear(kBackground);
+
+  // Matrix of glFrustum(-0.1, 0.1, -0.1, 0.1, 0.1, 100)
+  const float near = 0.1f, far = 100;
+  const float frustum[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0,
+                             -(far + near) / (far - near), -1, 0, 0,
+                             -2 * far * near / (far - near), 0};
+  rasterizer.SetMatrix(frustum);
+
+  // Line goes from behind the camera to the center of view
+  std::vector<vertexType> vertices = {0.05f, 0, 1, 0, 0, -10};
+  std::vector<polygonType> indices = {0, 1};
+  rasterizer.SetGeometry(vertices.data(), 2);
+  rasterizer.DrawLines(indices.data(), 2, kRed, 1);
+
+  // Visible part goes from the center to x = 0.045 of the near plane,
+  // which is 72.5 in window
+  const uint32_t* row = rasterizer.GetPixels() + 49 * 100;
+  EXPECT_EQ(row[50], kRed);
+  EXPECT_EQ(row[71], kRed);
+  EXPECT_EQ(row[72], kBackground);
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 22);
+}
+
+TEST(rasterizer_testing, occluders) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(100, 100);
+  rasterizer.Clear(kBackground);
+  rasterizer.SetMatrix(kIdentity);
+
+  // Face on the left half, edge behind it across the view and edge on it
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 0, 0, 0);
+  AddWindowVertex(vertices, rasterizer, 50, 0, 0);
+  AddWindowVertex(vertices, rasterizer, 50, 100, 0);
+  AddWindowVertex(vertices, rasterizer, 0, 100, 0);
+  AddWindowVertex(vertices, rasterizer, 0, 50.5f, 0.5f);
+  AddWindowVertex(vertices, rasterizer, 100, 50.5f, 0.5f);
+  AddWindowVertex(vertices, rasterizer, 10, 20.5f, 0);
+  AddWindowVertex(vertices, rasterizer, 40, 20.5f, 0);
+  std::vector<polygonType> triangles = {0, 1, 2, 0, 2, 3};
+  std::vector<polygonType> lines = {4, 5, 6, 7};
+  rasterizer.SetGeometry(vertices.data(), 8);
+
+  rasterizer.DrawOccluders(triangles.data(), triangles.size());
+  EXPECT_EQ(CountPixels(rasterizer, kBackground), 100 * 100);
+  EXPECT_NEAR(rasterizer.GetDepth(49, 0), 0.5f, 1e-5f);
+  EXPECT_NEAR(rasterizer.GetDepth(0, 99), 0.5f, 1e-5f);
+  EXPECT_FLOAT_EQ(rasterizer.GetDepth(50, 0), 1.0f);
+
+  rasterizer.DrawLines(lines.data(), lines.size(), kRed, 1);
+  const uint32_t* row = rasterizer.GetPixels() + 49 * 100;
+  EXPECT_EQ(row[49], kBackground);
+  EXPECT_EQ(row[50], kRed);
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 50 + 30);
+}
+
+TEST(rasterizer_testing, surface) {
+  SoftwareRasterizer rasterizer;
+  rasterizer.Resize(100, 100);
+  rasterizer.SetMatrix(kIdentity);
+
+  // Two triangles of the quad over the whole view and an edge on it
+  std::vector<vertexType> vertices;
+  AddWindowVertex(vertices, rasterizer, 0, 0, 0);
+  AddWindowVertex(vertices, rasterizer, 100, 0, 0);
+  AddWindowVertex(vertices, rasterizer, 100, 100, 0);
+  AddWindowVertex(vertices, rasterizer, 0, 100, 0);
+  std::vector<polygonType> triangles = {0, 1, 2, 0, 2, 3};
+  std::vector<polygonType> lines = {0, 2};
+  rasterizer.SetGeometry(vertices.data(), 4);
+
+  // Shared edge is filled once, the light from the back is the same
+  rasterizer.Clear(kBackground);
+  std::vector<vertexType> flat_normals = {0, 0, 1, 0, 0, -1};
+  rasterizer.DrawSurface(triangles.data(), triangles.size(),
+                         flat_normals.data(), false, kRed);
+  EXPECT_EQ(CountPixels(rasterizer, kRed), 100 * 100);
+  rasterizer.DrawLines(lines.data(), lines.size(), kBlue, 1);
+  EXPECT_EQ(CountPixels(rasterizer, kBlue), 100);
+
+  // Light of 0.2 + 0.8 * 0.8 scales the red channel to 214
+  rasterizer.Clear(kBackground);
+  std::vector<vertexType> smooth_normals(4 * 3);
+  for (size_t i = 0; i < 4; ++i) {
+    smooth_normals[i * 3] = 0.6f;
+    smooth_normals[i * 3 + 2] = 0.8f;
+  }
+  rasterizer.DrawSurface(triangles.data(), triangles.size(),
+                         smooth_normals.data(), true, kRed);
+  EXPECT_EQ(CountPixels(rasterizer, 0xFFD60000), 100 * 100);
+}
+}  // namespace ModelViewer3D
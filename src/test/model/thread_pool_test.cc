@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "model/model.h"
+#include "model/thread_pool.h"
+
+namespace ModelViewer3D {
+TEST(thread_pool_testing, parallel_for_threads_1_32) {
+  const size_t kCount = 1000003;
+  std::vector<uint64_t> data(kCount);
+  std::iota(data.begin(), data.end(), 0);
+
+  for (unsigned threads_count = 1; threads_count <= 32; threads_count *= 2) {
+    ThreadPool pool(threads_count);
+    EXPECT_EQ(pool.GetThreadsCount(), threads_count);
+
+    std::vector<uint64_t> result(kCount, 0);
+    pool.ParallelFor(kCount, 4096, [&data, &result](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        result[i] = data[i] * 2;
+      }
+    });
+
+    uint64_t sum = std::accumulate(result.begin(), result.end(), uint64_t(0));
+    EXPECT_EQ(sum, uint64_t(kCount - 1) * kCount);
+  }
+}
+
+TEST(thread_pool_testing, parallel_for_repeated) {
+  ThreadPool pool(4);
+  std::vector<int> data(100000, 0);
+
+  for (int pass = 0; pass < 100; ++pass) {
+    pool.ParallelFor(data.size(), 1000, [&data](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        ++data[i];
+      }
+    });
+  }
+
+  for (int value : data) {
+    ASSERT_EQ(value, 100);
+  }
+}
+
+TEST(thread_pool_testing, parallel_for_small_and_empty) {
+  ThreadPool pool(8);
+  size_t calls = 0;
+  pool.ParallelFor(10, 4096, [&calls](size_t begin, size_t end) {
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 10);
+    ++calls;
+  });
+  pool.ParallelFor(0, 4096, [&calls](size_t, size_t) { ++calls; });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(thread_pool_testing, model_bounds) {
+  ThreadPool pool(3);
+  Model model;
+  model.SetThreadPool(&pool);
+  model.Load(std::string("test/model/test_data/cube.obj"));
+  model.Translate(0.5, 1);
+
+  vertexType min[3], max[3];
+  model.GetBounds(min, max);
+  EXPECT_FLOAT_EQ(min[0], -1);
+  EXPECT_FLOAT_EQ(min[1], -0.5);
+  EXPECT_FLOAT_EQ(min[2], -1);
+  EXPECT_FLOAT_EQ(max[0], 1);
+  EXPECT_FLOAT_EQ(max[1], 1.5);
+  EXPECT_FLOAT_EQ(max[2], 1);
+}
+}  // namespace ModelViewer3D
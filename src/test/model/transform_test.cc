@@ -105,4 +105,99 @@ TEST(load_testing, transform_3_rotate_z) {
   EXPECT_FLOAT_EQ(vertices[1], 2.0);
   EXPECT_FLOAT_EQ(vertices[2], 3.0);
 }
+TEST(load_testing, transform_4_fused) {
+  Controller& controller = Controller::Instance();
+  controller.TransformModel(AffineTransform::Translation(1, -2, 0.5) *
+                            AffineTransform::Scale(2));
+  EXPECT_FLOAT_EQ(vertices[0], 3.0);
+  EXPECT_FLOAT_EQ(vertices[1], 2.0);
+  EXPECT_FLOAT_EQ(vertices[2], 6.5);
+
+  controller.TranslateModelPosition(-1, 2, -0.5);
+  controller.SetModelScale(0.5);
+  EXPECT_FLOAT_EQ(vertices[0], 1.0);
+  EXPECT_FLOAT_EQ(vertices[1], 2.0);
+  EXPECT_FLOAT_EQ(vertices[2], 3.0);
+}
+
+TEST(load_testing, transform_4_fused_rotation) {
+  Controller& controller = Controller::Instance();
+  controller.TransformModel(AffineTransform::RotationX(0.3) *
+                            AffineTransform::RotationY(0.7));
+  float fused[3] = {vertices[0], vertices[1], vertices[2]};
+
+  controller.TransformModel(AffineTransform::RotationY(-0.7) *
+                            AffineTransform::RotationX(-0.3));
+  EXPECT_LE(fabsf(vertices[0] - 1.0), 1e-5);
+  EXPECT_LE(fabsf(vertices[1] - 2.0), 1e-5);
+  EXPECT_LE(fabsf(vertices[2] - 3.0), 1e-5);
+
+  controller.RotateModel(0.7, kY);
+  controller.RotateModel(0.3, kX);
+  EXPECT_LE(fabsf(vertices[0] - fused[0]), 1e-5);
+  EXPECT_LE(fabsf(vertices[1] - fused[1]), 1e-5);
+  EXPECT_LE(fabsf(vertices[2] - fused[2]), 1e-5);
+}
+TEST(load_testing, transform_5_stable_drift) {
+  Model in_place, stable;
+  stable.SetStableTransform(true);
+  in_place.Load(std::string("test/model/test_data/transform.obj"));
+  stable.Load(std::string("test/model/test_data/transform.obj"));
+
+  for (int i = 0; i < 10000; ++i) {
+    in_place.RotateY(0.01);
+    in_place.RotateX(0.013);
+    stable.RotateY(0.01);
+    stable.RotateX(0.013);
+  }
+  for (int i = 0; i < 10000; ++i) {
+    in_place.RotateX(-0.013);
+    in_place.RotateY(-0.01);
+    stable.RotateX(-0.013);
+    stable.RotateY(-0.01);
+  }
+
+  vertexType* drifted = in_place.GetVertices();
+  vertexType* restored = stable.GetVertices();
+  float drift = fabsf(drifted[0] - 1) + fabsf(drifted[1] - 2) +
+                fabsf(drifted[2] - 3);
+  EXPECT_GT(drift, 1e-4);
+  EXPECT_LE(fabsf(restored[0] - 1.0), 1e-5);
+  EXPECT_LE(fabsf(restored[1] - 2.0), 1e-5);
+  EXPECT_LE(fabsf(restored[2] - 3.0), 1e-5);
+}
+
+TEST(load_testing, transform_5_stable_toggle) {
+  Model model;
+  model.Load(std::string("test/model/test_data/transform.obj"));
+  model.Translate(1, kX);
+  model.SetStableTransform(true);
+  model.Scale(2);
+  EXPECT_FLOAT_EQ(model.GetVertices()[0], 4.0);
+  model.SetStableTransform(false);
+  model.Scale(0.5);
+  EXPECT_FLOAT_EQ(model.GetVertices()[0], 2.0);
+  EXPECT_FLOAT_EQ(model.GetVertices()[1], 2.0);
+  EXPECT_FLOAT_EQ(model.GetVertices()[2], 3.0);
+}
+
+TEST(load_testing, transform_6_reload) {
+  Model model;
+  MeshData mesh;
+  try {
+    model.Load(std::string("test/model/test_data/transform.obj"));
+    model.Translate(1, kX);
+    model.SetStableTransform(true);
+    model.Scale(2);
+
+    // The new version of file gets the transforms of the previous one
+    model.Parse(std::string("test/model/test_data/transform.obj"), mesh);
+    model.ReloadMesh(mesh);
+    EXPECT_FLOAT_EQ(model.GetVertices()[0], 4.0);
+    EXPECT_FLOAT_EQ(model.GetVertices()[1], 4.0);
+    EXPECT_FLOAT_EQ(model.GetVertices()[2], 6.0);
+  } catch (std::exception& exc) {
+    FAIL() << std::string("Expected: no error: ") + exc.what();
+  }
+}
 }  // namespace ModelViewer3D
@@ -0,0 +1,89 @@
+/** @file
+ * @brief Definition of class Frame reader
+ */
+#include "viewer/frame_reader/frame_reader.h"
+
+#include <cstring>
+
+namespace ModelViewer3D {
+void FrameReader::Initialize(int buffers_count) {
+  initializeOpenGLFunctions();
+
+  this->pending_.clear();
+  this->ready_.clear();
+  this->buffers_.clear();
+  this->next_buffer_ = 0;
+
+  for (int i = 0; i < buffers_count; ++i) {
+    QOpenGLBuffer buffer(QOpenGLBuffer::PixelPackBuffer);
+    buffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+    buffer.create();
+    this->buffers_.push_back(buffer);
+  }
+}
+
+void FrameReader::Read(int width, int height, Callback callback) {
+  if (this->buffers_.empty() || width <= 0 || height <= 0) {
+    // Receiver still gets the null image by the next collect
+    this->ready_.push_back(Frame{QImage(), std::move(callback)});
+    return;
+  }
+
+  if (this->pending_.size() == this->buffers_.size()) {
+    this->ready_.push_back(this->CollectFirst());
+  }
+
+  QOpenGLBuffer& buffer = this->buffers_[this->next_buffer_];
+  buffer.bind();
+  // New storage lets GL not wait for the previous use of the buffer
+  buffer.allocate(width * height * 4);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  buffer.release();
+
+  this->pending_.push_back(
+      Pending{this->next_buffer_, width, height, std::move(callback)});
+  this->next_buffer_ = (this->next_buffer_ + 1) % this->buffers_.size();
+}
+
+std::vector<FrameReader::Frame> FrameReader::Collect() {
+  std::vector<Frame> frames = std::move(this->ready_);
+  this->ready_.clear();
+
+  while (!this->pending_.empty()) {
+    frames.push_back(this->CollectFirst());
+  }
+
+  return frames;
+}
+
+FrameReader::Frame FrameReader::CollectFirst() {
+  Pending pending = std::move(this->pending_.front());
+  this->pending_.pop_front();
+
+  Frame frame;
+  frame.callback = std::move(pending.callback);
+
+  QOpenGLBuffer& buffer = this->buffers_[pending.buffer];
+  buffer.bind();
+  const uchar* pixels =
+      static_cast<const uchar*>(buffer.map(QOpenGLBuffer::ReadOnly));
+
+  if (pixels) {
+    // Rows of GL go from the bottom, the copy flips them instead of a
+    // separate mirroring of the image
+    frame.image = QImage(pending.width, pending.height,
+                         QImage::Format_RGBA8888);
+    const size_t row_size = pending.width * 4;
+    for (int y = 0; y < pending.height; ++y) {
+      std::memcpy(frame.image.scanLine(pending.height - 1 - y),
+                  pixels + y * row_size, row_size);
+    }
+    buffer.unmap();
+  }
+
+  buffer.release();
+
+  return frame;
+}
+}  // namespace ModelViewer3D
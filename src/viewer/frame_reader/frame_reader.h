@@ -0,0 +1,83 @@
+/** @file
+ * @brief Declaration of class Frame reader
+ */
+#ifndef SRC_VIEWER_FRAME_READER_FRAME_READER_H_
+#define SRC_VIEWER_FRAME_READER_FRAME_READER_H_
+
+#include <QImage>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace ModelViewer3D {
+/** @brief Asynchronous readback of the framebuffer
+ * Pixels are copied to a ring of pixel buffer objects by GL without waiting,
+ * buffers are mapped later when the copy is done, so capture does not stall
+ * rendering
+ */
+class FrameReader : protected QOpenGLFunctions {
+ public:
+  using Callback = std::function<void(const QImage&)>;
+
+  /** @brief Frame read to the image and the receiver of it */
+  struct Frame {
+    QImage image;
+    Callback callback;
+  };
+
+  FrameReader() = default;
+
+  FrameReader(const FrameReader&) = delete;
+  FrameReader& operator=(const FrameReader&) = delete;
+
+  /** @brief Create buffers of the ring, the context must be current
+   * Reads pending in the previous context are dropped
+   * @param buffers_count Count of reads in flight
+   */
+  void Initialize(int buffers_count = kBuffersCount);
+
+  /** @brief Start reading of the bound framebuffer, the context must be
+   * current. If all buffers are in flight, the oldest one is mapped first
+   * @param width Width of framebuffer in pixels
+   * @param height Height of framebuffer in pixels
+   * @param callback Receiver of the image, the image is null if the frame
+   * could not be read
+   */
+  void Read(int width, int height, Callback callback);
+
+  /** @brief Map buffers of started reads, the context must be current
+   * Callbacks are not called here, so they can open dialogs or release the
+   * context
+   * @return Frames in the order of reads, failed reads have null images
+   */
+  std::vector<Frame> Collect();
+
+  /** @brief Check that some reads are not collected yet */
+  bool HasPending() const {
+    return !this->pending_.empty() || !this->ready_.empty();
+  }
+
+ private:
+  /** @brief Read in flight */
+  struct Pending {
+    size_t buffer = 0;
+    int width = 0;
+    int height = 0;
+    Callback callback;
+  };
+
+  /** @brief SubMethod for map the buffer of the oldest read */
+  Frame CollectFirst();
+
+  static const int kBuffersCount = 3;
+  std::vector<QOpenGLBuffer> buffers_;
+  std::deque<Pending> pending_;
+  // Frames mapped early because the ring was full
+  std::vector<Frame> ready_;
+  size_t next_buffer_ = 0;
+};
+}  // namespace ModelViewer3D
+
+#endif  // SRC_VIEWER_FRAME_READER_FRAME_READER_H_
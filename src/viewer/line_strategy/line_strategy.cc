@@ -3,6 +3,9 @@
  */
 #include "viewer/line_strategy/line_strategy.h"
 
+#include "common/color_utils.h"
+#include "model/software_rasterizer.h"
+#include "viewer/shader_renderer/shader_renderer.h"
 #include "viewer/viewer.h"
 
 namespace ModelViewer3D {
@@ -22,15 +25,41 @@ void LineStrategy::LineRender(Viewer& viewer) {
 
 void SolidLine::Use(Viewer& viewer) { LineRender(viewer); }
 
+void SolidLine::Use(Viewer& viewer, ShaderRenderer& renderer) {
+  ElementSettings line_settings = viewer.get_line_settings();
+  renderer.DrawLines(line_settings.color, line_settings.size);
+}
+
+void SolidLine::Use(Viewer& viewer, SoftwareRasterizer& rasterizer) {
+  ElementSettings line_settings = viewer.get_line_settings();
+  ColorRGB color = line_settings.color;
+  rasterizer.DrawLines(viewer.get_faces_array(), viewer.get_faces_size(),
+                       rgbToQRgb(color.r, color.g, color.b),
+                       static_cast<int>(line_settings.size));
+}
+
 void DashedLine::Use(Viewer& viewer) {
   glEnable(GL_LINE_STIPPLE);
-  glLineStipple(
-      2,
-      0x000F);  // TODO: проверить у Сереги и если нужно поиграться с pattern'ом
+  glLineStipple(kDashFactor, kDashPattern);
   LineRender(viewer);
   glDisable(GL_LINE_STIPPLE);
 }
 
+void DashedLine::Use(Viewer& viewer, ShaderRenderer& renderer) {
+  ElementSettings line_settings = viewer.get_line_settings();
+  renderer.DrawLines(line_settings.color, line_settings.size, kDashPattern,
+                     kDashFactor);
+}
+
+void DashedLine::Use(Viewer& viewer, SoftwareRasterizer& rasterizer) {
+  ElementSettings line_settings = viewer.get_line_settings();
+  ColorRGB color = line_settings.color;
+  rasterizer.DrawLines(viewer.get_faces_array(), viewer.get_faces_size(),
+                       rgbToQRgb(color.r, color.g, color.b),
+                       static_cast<int>(line_settings.size), kDashPattern,
+                       kDashFactor);
+}
+
 LineType SolidLine::Type() { return kSolidLine; }
 
 LineType DashedLine::Type() { return kDashedLine; }
@@ -4,9 +4,14 @@
 #ifndef SRC_VIEWER_LINE_STRATEGY_LINE_STRATEGY_H_
 #define SRC_VIEWER_LINE_STRATEGY_LINE_STRATEGY_H_
 
+#include <cstdint>
+
 class Viewer;
 
 namespace ModelViewer3D {
+class ShaderRenderer;
+class SoftwareRasterizer;
+
 enum LineType { kNoneLine, kSolidLine, kDashedLine };
 class LineStrategy {
  public:
@@ -17,6 +22,16 @@ class LineStrategy {
    * @param viewer class parent
    */
   virtual void Use(Viewer& viewer) = 0;
+  /** @brief Draws lines of the selected type by shader programs
+   * @param viewer class parent
+   * @param renderer renderer of the core profile
+   */
+  virtual void Use(Viewer& viewer, ShaderRenderer& renderer) = 0;
+  /** @brief Draws lines of the selected type on the CPU
+   * @param viewer class parent
+   * @param rasterizer rasterizer of the software backend
+   */
+  virtual void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) = 0;
   /** @brief Gets the type of strategy used
    */
   virtual LineType Type() = 0;
@@ -28,13 +43,22 @@ class LineStrategy {
 class SolidLine : public LineStrategy {
  public:
   void Use(Viewer& viewer) override;
+  void Use(Viewer& viewer, ShaderRenderer& renderer) override;
+  void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) override;
   LineType Type() override;
 };
 
 class DashedLine : public LineStrategy {
  public:
   void Use(Viewer& viewer) override;
+  void Use(Viewer& viewer, ShaderRenderer& renderer) override;
+  void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) override;
   LineType Type() override;
+
+ private:
+  // Same dashes as the stipple of the fixed function path
+  static constexpr int kDashFactor = 2;
+  static constexpr uint16_t kDashPattern = 0x000F;
 };
 
 }  // namespace ModelViewer3D
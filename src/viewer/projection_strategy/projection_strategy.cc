@@ -5,8 +5,8 @@
 
 #include <algorithm>
 #include <cmath>
-#include <limits>
 
+#include "controller/controller.h"
 #include "viewer/viewer.h"
 
 #define DEBUG 0
@@ -44,23 +44,21 @@ void CentralProjection::Use() {
   glFrustum(left_, right_, bottom_, top_, near_, far_);
 }
 
+QMatrix4x4 CentralProjection::Matrix() {
+  QMatrix4x4 matrix;
+  matrix.frustum(left_, right_, bottom_, top_, near_, far_);
+  return matrix;
+}
+
 void ParallelProjection::Resize(Viewer& viewer) {
   if (!viewer.get_aspect_ratio()) return;
 
-  const vertexType* vertices = viewer.get_vertices_array();
-  const unsigned int vertices_count = viewer.get_vertices_size();
-  vertexType camera_min_x = std::numeric_limits<double>::infinity();
-  vertexType camera_min_y = std::numeric_limits<double>::infinity();
-  vertexType camera_max_x = -std::numeric_limits<double>::infinity();
-  vertexType camera_max_y = -std::numeric_limits<double>::infinity();
-
-  for (unsigned int i = 0; i < vertices_count; i += 3) {
-    camera_min_x = std::min(vertices[i], camera_min_x);
-    camera_min_y = std::min(vertices[i + 1], camera_min_y);
-
-    camera_max_x = std::max(vertices[i], camera_max_x);
-    camera_max_y = std::max(vertices[i + 1], camera_max_y);
-  }
+  vertexType min[3], max[3];
+  Controller::Instance().GetModelBounds(min, max);
+  vertexType camera_min_x = min[0];
+  vertexType camera_min_y = min[1];
+  vertexType camera_max_x = max[0];
+  vertexType camera_max_y = max[1];
 
   vertexType max_x = std::max(std::fabs(camera_min_x), std::fabs(camera_max_x));
   vertexType max_y = std::max(std::fabs(camera_min_y), std::fabs(camera_max_y));
@@ -79,6 +77,12 @@ void ParallelProjection::Use() {
   glOrtho(left_, right_, bottom_, top_, near_, far_);
 }
 
+QMatrix4x4 ParallelProjection::Matrix() {
+  QMatrix4x4 matrix;
+  matrix.ortho(left_, right_, bottom_, top_, near_, far_);
+  return matrix;
+}
+
 ProjectionType CentralProjection::Type() { return kCentralProjection; }
 
 ProjectionType ParallelProjection::Type() { return kParallelProjection; }
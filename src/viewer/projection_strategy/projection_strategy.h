@@ -4,6 +4,8 @@
 #ifndef SRC_VIEWER_PROJECTION_STRATEGY_PROJECTION_STRATEGY_H_
 #define SRC_VIEWER_PROJECTION_STRATEGY_PROJECTION_STRATEGY_H_
 
+#include <QMatrix4x4>
+
 class Viewer;
 
 namespace ModelViewer3D {
@@ -17,6 +19,9 @@ class ProjectionStrategy {
    * @param viewer class parent
    */
   virtual void Use() = 0;
+  /** @brief Gets the matrix of the selected projection type
+   */
+  virtual QMatrix4x4 Matrix() = 0;
   /** @brief Gets the type of strategy used
    */
   virtual ProjectionType Type() = 0;
@@ -36,6 +41,7 @@ class ProjectionStrategy {
 class CentralProjection : public ProjectionStrategy {
  public:
   void Use() override;
+  QMatrix4x4 Matrix() override;
   ProjectionType Type() override;
   void Resize(Viewer& viewer) override;
 };
@@ -43,6 +49,7 @@ class CentralProjection : public ProjectionStrategy {
 class ParallelProjection : public ProjectionStrategy {
  public:
   void Use() override;
+  QMatrix4x4 Matrix() override;
   ProjectionType Type() override;
   void Resize(Viewer& viewer) override;
 };
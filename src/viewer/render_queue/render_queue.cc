@@ -0,0 +1,68 @@
+/** @file
+ * @brief Definition of class Render queue
+ */
+#include "viewer/render_queue/render_queue.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace ModelViewer3D {
+/** @brief Get the fields of the state in the order of sort, program is
+ * changed most rarely
+ */
+static auto StateKey(const DrawState& state) {
+  return std::tie(state.pass, state.element_mode, state.is_round,
+                  state.pattern, state.factor, state.size, state.color[0],
+                  state.color[1], state.color[2]);
+}
+
+bool DrawState::operator<(const DrawState& other) const {
+  return StateKey(*this) < StateKey(other);
+}
+
+bool DrawState::operator==(const DrawState& other) const {
+  return StateKey(*this) == StateKey(other);
+}
+
+bool DrawBatch::operator==(const DrawBatch& other) const {
+  return this->state == other.state && this->firsts == other.firsts &&
+         this->counts == other.counts;
+}
+
+void RenderQueue::Submit(const DrawItem& item) {
+  if (item.count != 0) {
+    this->items_.push_back(item);
+  }
+}
+
+const std::vector<DrawBatch>& RenderQueue::Build() {
+  // Items of equal state keep the order of submission
+  std::stable_sort(this->items_.begin(), this->items_.end(),
+                   [](const DrawItem& lhs, const DrawItem& rhs) {
+                     return lhs.state < rhs.state;
+                   });
+
+  this->batches_.clear();
+  for (const DrawItem& item : this->items_) {
+    if (this->batches_.empty() ||
+        !(this->batches_.back().state == item.state)) {
+      this->batches_.push_back(DrawBatch{item.state, {}, {}});
+    }
+
+    DrawBatch& batch = this->batches_.back();
+    bool is_adjacent = !batch.firsts.empty() &&
+                       batch.firsts.back() + batch.counts.back() == item.first;
+
+    if (is_adjacent) {
+      batch.counts.back() += item.count;
+    } else {
+      batch.firsts.push_back(item.first);
+      batch.counts.push_back(item.count);
+    }
+  }
+
+  this->items_.clear();
+
+  return this->batches_;
+}
+}  // namespace ModelViewer3D
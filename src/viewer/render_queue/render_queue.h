@@ -0,0 +1,71 @@
+/** @file
+ * @brief Declaration of class Render queue
+ */
+#ifndef SRC_VIEWER_RENDER_QUEUE_RENDER_QUEUE_H_
+#define SRC_VIEWER_RENDER_QUEUE_RENDER_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ModelViewer3D {
+// Passes are submitted in the order of values, points before lines
+enum DrawPass { kPointPass, kLinePass };
+
+/** @brief Program and uniforms shared by draw items of one batch */
+struct DrawState {
+  DrawPass pass = kLinePass;
+  int element_mode = 0;
+  float color[3] = {0, 0, 0};
+  float size = 1;
+  uint16_t pattern = 0xFFFF;
+  int factor = 1;
+  bool is_round = false;
+
+  bool operator<(const DrawState& other) const;
+  bool operator==(const DrawState& other) const;
+};
+
+/** @brief Range of elements drawn with the state, indices for lines and
+ * vertices for points
+ */
+struct DrawItem {
+  DrawState state;
+  unsigned int first = 0;
+  unsigned int count = 0;
+};
+
+/** @brief Items of one state merged into ranges of a single multi-draw */
+struct DrawBatch {
+  DrawState state;
+  std::vector<unsigned int> firsts;
+  std::vector<int> counts;
+
+  bool operator==(const DrawBatch& other) const;
+};
+
+/** @brief Queue of draw items of the frame
+ * Items are sorted by state, so state is set once per batch, and adjacent
+ * ranges are joined, so the count of submissions does not grow with the
+ * count of objects
+ */
+class RenderQueue {
+ public:
+  /** @brief Add the item to the frame, empty items are skipped */
+  void Submit(const DrawItem& item);
+
+  /** @brief Sort and merge items into batches and clear the queue
+   * @return Batches in the order of submission to GL
+   */
+  const std::vector<DrawBatch>& Build();
+
+  /** @brief Get the count of items submitted since the last build */
+  size_t GetItemsCount() const { return this->items_.size(); }
+
+ private:
+  std::vector<DrawItem> items_;
+  std::vector<DrawBatch> batches_;
+};
+}  // namespace ModelViewer3D
+
+#endif  // SRC_VIEWER_RENDER_QUEUE_RENDER_QUEUE_H_
@@ -0,0 +1,771 @@
+/** @file
+ * @brief Definition of class Shader renderer
+ */
+#include "viewer/shader_renderer/shader_renderer.h"
+
+#include <QOpenGLContext>
+#include <algorithm>
+
+#include "viewer/viewer.h"
+
+#define DEBUG 0
+
+namespace ModelViewer3D {
+// Position in window pixels is interpolated without perspective, the start
+// of line is taken from the provoking vertex, which is set to the first one
+static const char* kLineVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 matrix;
+uniform vec2 viewport;
+noperspective out vec2 screen_position;
+flat out vec2 line_start;
+
+void main() {
+  gl_Position = matrix * vec4(position, 1.0);
+  screen_position = (gl_Position.xy / gl_Position.w * 0.5 + 0.5) * viewport;
+  line_start = screen_position;
+}
+)";
+
+static const char* kLineFragmentShader = R"(
+#version 330 core
+uniform vec3 color;
+uniform int pattern;
+uniform float factor;
+noperspective in vec2 screen_position;
+flat in vec2 line_start;
+out vec4 fragment_color;
+
+void main() {
+  int bit = int(distance(screen_position, line_start) / factor) & 15;
+  if (((pattern >> bit) & 1) == 0) {
+    discard;
+  }
+  fragment_color = vec4(color, 1.0);
+}
+)";
+
+static const char* kPointVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 matrix;
+uniform float point_size;
+
+void main() {
+  gl_Position = matrix * vec4(position, 1.0);
+  gl_PointSize = point_size;
+}
+)";
+
+static const char* kPointFragmentShader = R"(
+#version 330 core
+uniform vec3 color;
+uniform bool is_round;
+out vec4 fragment_color;
+
+void main() {
+  vec2 offset = gl_PointCoord - vec2(0.5);
+  if (is_round && dot(offset, offset) > 0.25) {
+    discard;
+  }
+  fragment_color = vec4(color, 1.0);
+}
+)";
+
+// Edge is a quad of four vertices in a strip, both ends are projected and
+// the quad is widened across the edge in window pixels
+static const char* kLineQuadVertexShader = R"(
+#version 330 core
+layout(location = 1) in uvec2 edge;
+uniform samplerBuffer positions;
+uniform mat4 matrix;
+uniform vec2 viewport;
+uniform float width;
+noperspective out vec2 screen_position;
+flat out vec2 line_start;
+
+vec4 FetchPosition(uint index) {
+  int offset = int(index) * 3;
+  return vec4(texelFetch(positions, offset).r,
+              texelFetch(positions, offset + 1).r,
+              texelFetch(positions, offset + 2).r, 1.0);
+}
+
+void main() {
+  vec4 ends[2] = vec4[2](matrix * FetchPosition(edge.x),
+                         matrix * FetchPosition(edge.y));
+  vec2 start = (ends[0].xy / ends[0].w * 0.5 + 0.5) * viewport;
+  vec2 end = (ends[1].xy / ends[1].w * 0.5 + 0.5) * viewport;
+  vec2 direction = end - start;
+  direction = length(direction) > 0.0 ? normalize(direction) : vec2(1, 0);
+
+  int end_index = gl_VertexID >> 1;
+  float side = (gl_VertexID & 1) == 0 ? -0.5 : 0.5;
+  vec2 offset = vec2(-direction.y, direction.x) * side * width;
+
+  gl_Position = ends[end_index];
+  gl_Position.xy += offset / viewport * 2.0 * gl_Position.w;
+  // Distance along the edge is the same across its width
+  screen_position = end_index == 0 ? start : end;
+  line_start = start;
+}
+)";
+
+static const char* kPointQuadVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 matrix;
+uniform vec2 viewport;
+uniform float point_size;
+out vec2 point_coord;
+
+void main() {
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  gl_Position = matrix * vec4(position, 1.0);
+  gl_Position.xy += (corner - 0.5) * point_size / viewport * 2.0 *
+                    gl_Position.w;
+  point_coord = corner;
+}
+)";
+
+static const char* kPointQuadFragmentShader = R"(
+#version 330 core
+uniform vec3 color;
+uniform bool is_round;
+in vec2 point_coord;
+out vec4 fragment_color;
+
+void main() {
+  vec2 offset = point_coord - vec2(0.5);
+  if (is_round && dot(offset, offset) > 0.25) {
+    discard;
+  }
+  fragment_color = vec4(color, 1.0);
+}
+)";
+
+// Triangle covering the viewport, made from the vertex index
+static const char* kCompositeVertexShader = R"(
+#version 330 core
+
+void main() {
+  vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Equal depth is won by points, as by the depth test when points are drawn
+// before lines
+static const char* kCompositeFragmentShader = R"(
+#version 330 core
+uniform sampler2D point_color;
+uniform sampler2D point_depth;
+uniform sampler2D line_color;
+uniform sampler2D line_depth;
+out vec4 fragment_color;
+
+void main() {
+  ivec2 texel = ivec2(gl_FragCoord.xy);
+  float point_z = texelFetch(point_depth, texel, 0).r;
+  float line_z = texelFetch(line_depth, texel, 0).r;
+  vec4 color = point_z <= line_z ? texelFetch(point_color, texel, 0)
+                                 : texelFetch(line_color, texel, 0);
+  if (color.a == 0.0) {
+    discard;
+  }
+  fragment_color = vec4(color.rgb, 1.0);
+  gl_FragDepth = min(point_z, line_z);
+}
+)";
+
+// Faces only fill the depth buffer, color writes are masked
+static const char* kDepthVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 matrix;
+
+void main() {
+  gl_Position = matrix * vec4(position, 1.0);
+}
+)";
+
+static const char* kDepthFragmentShader = R"(
+#version 330 core
+
+void main() {}
+)";
+
+// Two sided light goes along the Z axis of model coordinates towards the
+// viewer, terms are the same as of the software rasterizer. Flat normals
+// are fetched by the triangle
+static const char* kSurfaceVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 2) in vec3 normal;
+uniform mat4 matrix;
+out vec3 vertex_normal;
+
+void main() {
+  gl_Position = matrix * vec4(position, 1.0);
+  vertex_normal = normal;
+}
+)";
+
+static const char* kSurfaceFragmentShader = R"(
+#version 330 core
+uniform vec3 color;
+uniform bool is_smooth;
+uniform samplerBuffer face_normals;
+in vec3 vertex_normal;
+out vec4 fragment_color;
+
+void main() {
+  vec3 normal = vertex_normal;
+  if (!is_smooth) {
+    int offset = gl_PrimitiveID * 3;
+    normal = vec3(texelFetch(face_normals, offset).r,
+                  texelFetch(face_normals, offset + 1).r,
+                  texelFetch(face_normals, offset + 2).r);
+  }
+  float cosine = length(normal) > 0.0 ? abs(normalize(normal).z) : 0.0;
+  fragment_color = vec4(color * (0.2 + 0.8 * cosine), 1.0);
+}
+)";
+
+ShaderRenderer::ShaderRenderer()
+    : vertex_buffer_(QOpenGLBuffer::VertexBuffer),
+      index_buffer_(QOpenGLBuffer::IndexBuffer),
+      triangle_buffer_(QOpenGLBuffer::IndexBuffer),
+      normal_buffer_(QOpenGLBuffer::VertexBuffer) {}
+
+ShaderRenderer::~ShaderRenderer() {
+  if (position_texture_) {
+    glDeleteTextures(1, &position_texture_);
+  }
+  if (normal_texture_) {
+    glDeleteTextures(1, &normal_texture_);
+  }
+  this->DeleteLayers();
+}
+
+bool ShaderRenderer::BuildProgram(QOpenGLShaderProgram& program,
+                                  const char* vertex_source,
+                                  const char* fragment_source) {
+  bool is_linked =
+      program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertex_source) &&
+      program.addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                      fragment_source) &&
+      program.link();
+
+#if DEBUG == 1
+  if (!is_linked) {
+    qDebug() << program.log();
+  }
+#endif  // DEBUG == 1
+
+  return is_linked;
+}
+
+bool ShaderRenderer::Initialize() {
+  QOpenGLContext* context = QOpenGLContext::currentContext();
+  if (!context || context->format().version() < qMakePair(3, 3) ||
+      !initializeOpenGLFunctions()) {
+    return false;
+  }
+
+  // Quads share the fragment shader of lines, dashes are the same
+  bool is_linked =
+      BuildProgram(line_program_, kLineVertexShader, kLineFragmentShader) &&
+      BuildProgram(point_program_, kPointVertexShader,
+                   kPointFragmentShader) &&
+      BuildProgram(line_quad_program_, kLineQuadVertexShader,
+                   kLineFragmentShader) &&
+      BuildProgram(point_quad_program_, kPointQuadVertexShader,
+                   kPointQuadFragmentShader) &&
+      BuildProgram(composite_program_, kCompositeVertexShader,
+                   kCompositeFragmentShader) &&
+      BuildProgram(depth_program_, kDepthVertexShader, kDepthFragmentShader) &&
+      BuildProgram(surface_program_, kSurfaceVertexShader,
+                   kSurfaceFragmentShader);
+
+  if (!is_linked) {
+    return false;
+  }
+
+  vertex_array_.create();
+  vertex_buffer_.create();
+  index_buffer_.create();
+  // Vertices are changed by every transform of the model
+  vertex_buffer_.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
+  vertex_array_.bind();
+  vertex_buffer_.bind();
+  index_buffer_.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  vertex_array_.release();
+
+  // Pair of indices of the edge per instance, read from the index buffer
+  line_quad_array_.create();
+  line_quad_array_.bind();
+  glBindBuffer(GL_ARRAY_BUFFER, index_buffer_.bufferId());
+  glEnableVertexAttribArray(1);
+  glVertexAttribIPointer(1, 2, GL_UNSIGNED_INT, 0, nullptr);
+  glVertexAttribDivisor(1, 1);
+  line_quad_array_.release();
+
+  // Vertex per instance
+  point_quad_array_.create();
+  point_quad_array_.bind();
+  vertex_buffer_.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glVertexAttribDivisor(0, 1);
+  point_quad_array_.release();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Normals per vertex are enabled only for smooth faces
+  triangle_array_.create();
+  triangle_buffer_.create();
+  normal_buffer_.create();
+  normal_buffer_.setUsagePattern(QOpenGLBuffer::StreamDraw);
+  triangle_array_.bind();
+  vertex_buffer_.bind();
+  triangle_buffer_.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  normal_buffer_.bind();
+  glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  triangle_array_.release();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glGenTextures(1, &position_texture_);
+  glBindTexture(GL_TEXTURE_BUFFER, position_texture_);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, vertex_buffer_.bufferId());
+  glGenTextures(1, &normal_texture_);
+  glBindTexture(GL_TEXTURE_BUFFER, normal_texture_);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, normal_buffer_.bufferId());
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  composite_array_.create();
+
+  // Wide lines are limited by the implementation in core profile
+  glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, line_width_range_);
+  glEnable(GL_PROGRAM_POINT_SIZE);
+
+  return true;
+}
+
+void ShaderRenderer::SetGeometry(const vertexType* vertices,
+                                 unsigned int vertices_count,
+                                 const polygonType* indices,
+                                 unsigned int indices_count,
+                                 bool is_vertices_changed,
+                                 bool is_indices_changed) {
+  vertex_array_.bind();
+
+  if (is_vertices_changed || vertices != vertices_ ||
+      vertices_count != vertices_count_) {
+    vertex_buffer_.bind();
+    // New storage lets the driver not wait for the previous frame
+    vertex_buffer_.allocate(
+        vertices, vertices ? vertices_count * 3 * sizeof(vertexType) : 0);
+    vertices_ = vertices;
+    vertices_count_ = vertices ? vertices_count : 0;
+    is_geometry_changed_ = true;
+  }
+
+  if (is_indices_changed || indices != indices_ ||
+      indices_count != indices_count_) {
+    index_buffer_.bind();
+    index_buffer_.allocate(indices,
+                           indices ? indices_count * sizeof(polygonType) : 0);
+    indices_ = indices;
+    indices_count_ = indices ? indices_count : 0;
+    is_geometry_changed_ = true;
+  }
+
+  vertex_array_.release();
+}
+
+void ShaderRenderer::SetTriangles(const polygonType* indices,
+                                  unsigned int indices_count,
+                                  bool is_changed) {
+  if (!is_changed && indices == triangles_ &&
+      indices_count == triangles_count_) {
+    return;
+  }
+
+  triangle_array_.bind();
+  triangle_buffer_.bind();
+  triangle_buffer_.allocate(indices,
+                            indices ? indices_count * sizeof(polygonType) : 0);
+  triangle_array_.release();
+  triangles_ = indices;
+  triangles_count_ = indices ? indices_count : 0;
+  is_geometry_changed_ = true;
+}
+
+void ShaderRenderer::SetHiddenLines(bool is_enabled) {
+  if (is_enabled != is_hidden_lines_) {
+    // Layers are drawn with or without occluders
+    is_geometry_changed_ = true;
+  }
+  is_hidden_lines_ = is_enabled;
+}
+
+void ShaderRenderer::SetSurfaceNormals(const vertexType* normals,
+                                       unsigned int normals_count,
+                                       bool is_changed) {
+  normals_count = normals ? normals_count : 0;
+  if (!is_changed && normals == normals_ && normals_count == normals_count_) {
+    return;
+  }
+
+  // Storage is freed when faces are disabled
+  normal_buffer_.bind();
+  normal_buffer_.allocate(normals, normals_count * 3 * sizeof(vertexType));
+  normal_buffer_.release();
+  normals_ = normals;
+  normals_count_ = normals_count;
+  if (surface_mode_ != kNoNormals) {
+    is_geometry_changed_ = true;
+  }
+}
+
+void ShaderRenderer::SetSurface(SurfaceNormals mode, const ColorRGB& color) {
+  const float surface_color[3] = {color.r, color.g, color.b};
+  if (mode != surface_mode_ ||
+      (mode != kNoNormals &&
+       !std::equal(surface_color, surface_color + 3, surface_color_))) {
+    // Layers are drawn with faces of other kind or color
+    is_geometry_changed_ = true;
+  }
+  surface_mode_ = mode;
+  std::copy(surface_color, surface_color + 3, surface_color_);
+}
+
+void ShaderRenderer::SetViewport(int width, int height) {
+  viewport_ = QVector2D(width, height);
+}
+
+void ShaderRenderer::DrawLines(const ColorRGB& color, float width,
+                               uint16_t pattern, int factor,
+                               unsigned int first, unsigned int count) {
+  DrawItem item;
+  item.state.pass = kLinePass;
+  item.state.element_mode = element_mode_;
+  item.state.color[0] = color.r;
+  item.state.color[1] = color.g;
+  item.state.color[2] = color.b;
+  item.state.size = std::max(width, 1.0f);
+  item.state.pattern = pattern;
+  item.state.factor = factor;
+  item.first = std::min(first, indices_count_);
+  item.count = std::min(count, indices_count_ - item.first);
+  queue_.Submit(item);
+}
+
+void ShaderRenderer::DrawPoints(const ColorRGB& color, float size,
+                                bool is_round, unsigned int first,
+                                unsigned int count) {
+  DrawItem item;
+  item.state.pass = kPointPass;
+  item.state.element_mode = element_mode_;
+  item.state.color[0] = color.r;
+  item.state.color[1] = color.g;
+  item.state.color[2] = color.b;
+  item.state.size = std::max(size, 1.0f);
+  item.state.is_round = is_round;
+  item.first = std::min(first, vertices_count_);
+  item.count = std::min(count, vertices_count_ - item.first);
+  queue_.Submit(item);
+}
+
+void ShaderRenderer::Flush() {
+  const std::vector<DrawBatch>& batches = queue_.Build();
+
+  if (!is_layer_cache_enabled_ || !this->PrepareLayers()) {
+    this->DrawFaces();
+    for (const DrawBatch& batch : batches) {
+      this->SubmitBatch(batch);
+    }
+    // Flag is kept for the layers, which are not regenerated by this frame
+    return;
+  }
+
+  bool is_scene_changed = is_geometry_changed_ || matrix_ != layers_matrix_;
+  GLint target = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+
+  // Batches are sorted by pass, the range of each pass is continuous
+  auto pass_end = batches.begin();
+  for (int pass = 0; pass < kLayersCount; ++pass) {
+    auto pass_begin = pass_end;
+    pass_end = std::find_if(pass_begin, batches.end(),
+                            [pass](const DrawBatch& batch) {
+                              return batch.state.pass != pass;
+                            });
+
+    Layer& layer = layers_[pass];
+    if (layer.is_valid && !is_scene_changed &&
+        std::equal(pass_begin, pass_end, layer.batches.begin(),
+                   layer.batches.end())) {
+      continue;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    this->DrawFaces();
+    for (auto batch = pass_begin; batch != pass_end; ++batch) {
+      this->SubmitBatch(*batch);
+    }
+
+    layer.batches.assign(pass_begin, pass_end);
+    layer.is_valid = true;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, target);
+  layers_matrix_ = matrix_;
+  // All layers are regenerated or equal to the current geometry
+  is_geometry_changed_ = false;
+
+  this->CompositeLayers();
+}
+
+void ShaderRenderer::SubmitBatch(const DrawBatch& batch) {
+  const DrawState& state = batch.state;
+  bool is_quad = state.element_mode == kQuadElements;
+  bool is_line = state.pass == kLinePass;
+  QOpenGLShaderProgram& program =
+      is_line ? (is_quad ? line_quad_program_ : line_program_)
+              : (is_quad ? point_quad_program_ : point_program_);
+
+  program.bind();
+  program.setUniformValue("matrix", matrix_);
+  program.setUniformValue("viewport", viewport_);
+  program.setUniformValue("color", state.color[0], state.color[1],
+                          state.color[2]);
+
+  if (is_line) {
+    program.setUniformValue("pattern", static_cast<int>(state.pattern));
+    program.setUniformValue("factor", static_cast<float>(state.factor));
+    this->DrawLineBatch(batch, program);
+  } else {
+    program.setUniformValue("point_size", state.size);
+    program.setUniformValue("is_round", state.is_round);
+    this->DrawPointBatch(batch);
+  }
+
+  program.release();
+}
+
+void ShaderRenderer::DrawFaces() {
+  bool is_surface = surface_mode_ != kNoNormals && normals_count_;
+  if ((!is_hidden_lines_ && !is_surface) || !triangles_count_ ||
+      !vertices_count_) {
+    return;
+  }
+
+  // Faces are pushed away, so their own edges pass the depth test
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1, 1);
+  triangle_array_.bind();
+
+  if (is_surface) {
+    bool is_smooth = surface_mode_ == kSmoothNormals;
+    if (is_smooth) {
+      glEnableVertexAttribArray(2);
+    } else {
+      glDisableVertexAttribArray(2);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, normal_texture_);
+
+    surface_program_.bind();
+    surface_program_.setUniformValue("matrix", matrix_);
+    surface_program_.setUniformValue("color", surface_color_[0],
+                                     surface_color_[1], surface_color_[2]);
+    surface_program_.setUniformValue("is_smooth", is_smooth);
+    surface_program_.setUniformValue("face_normals", 0);
+    glDrawElements(GL_TRIANGLES, triangles_count_, GL_UNSIGNED_INT, nullptr);
+    surface_program_.release();
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  } else {
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    depth_program_.bind();
+    depth_program_.setUniformValue("matrix", matrix_);
+    glDrawElements(GL_TRIANGLES, triangles_count_, GL_UNSIGNED_INT, nullptr);
+    depth_program_.release();
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  }
+
+  triangle_array_.release();
+  glDisable(GL_POLYGON_OFFSET_FILL);
+}
+
+bool ShaderRenderer::PrepareLayers() {
+  int width = static_cast<int>(viewport_.x());
+  int height = static_cast<int>(viewport_.y());
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+
+  if (width == layers_width_ && height == layers_height_) {
+    return layers_[0].framebuffer != 0;
+  }
+
+  this->DeleteLayers();
+  layers_width_ = width;
+  layers_height_ = height;
+
+  GLint target = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+  bool is_complete = true;
+
+  for (Layer& layer : layers_) {
+    glGenTextures(1, &layer.color_texture);
+    glBindTexture(GL_TEXTURE_2D, layer.color_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &layer.depth_texture);
+    glBindTexture(GL_TEXTURE_2D, layer.depth_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0,
+                 GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &layer.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, layer.color_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                           layer.depth_texture, 0);
+    is_complete = is_complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) ==
+                                     GL_FRAMEBUFFER_COMPLETE;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, target);
+
+  // Size is kept, so allocation is not repeated every frame
+  if (!is_complete) {
+    this->DeleteLayers();
+  }
+
+  return is_complete;
+}
+
+void ShaderRenderer::DeleteLayers() {
+  for (Layer& layer : layers_) {
+    if (layer.framebuffer) glDeleteFramebuffers(1, &layer.framebuffer);
+    if (layer.color_texture) glDeleteTextures(1, &layer.color_texture);
+    if (layer.depth_texture) glDeleteTextures(1, &layer.depth_texture);
+    layer = Layer();
+  }
+}
+
+void ShaderRenderer::CompositeLayers() {
+  const Layer& points = layers_[kPointPass];
+  const Layer& lines = layers_[kLinePass];
+  const GLuint textures[4] = {points.color_texture, points.depth_texture,
+                              lines.color_texture, lines.depth_texture};
+
+  for (int i = 0; i < 4; ++i) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    glBindTexture(GL_TEXTURE_2D, textures[i]);
+  }
+
+  composite_program_.bind();
+  composite_program_.setUniformValue("point_color", 0);
+  composite_program_.setUniformValue("point_depth", 1);
+  composite_program_.setUniformValue("line_color", 2);
+  composite_program_.setUniformValue("line_depth", 3);
+
+  composite_array_.bind();
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  composite_array_.release();
+  composite_program_.release();
+
+  for (int i = 3; i >= 0; --i) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+}
+
+void ShaderRenderer::DrawLineBatch(const DrawBatch& batch,
+                                   QOpenGLShaderProgram& program) {
+  if (batch.state.element_mode == kQuadElements) {
+    program.setUniformValue("width", batch.state.size);
+    program.setUniformValue("positions", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, position_texture_);
+    line_quad_array_.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, index_buffer_.bufferId());
+
+    // Instanced draws have no base instance in 3.3, the range is selected
+    // by the offset of the edge attribute
+    for (size_t i = 0; i < batch.firsts.size(); ++i) {
+      glVertexAttribIPointer(
+          1, 2, GL_UNSIGNED_INT, 0,
+          reinterpret_cast<const void*>(batch.firsts[i] *
+                                        sizeof(polygonType)));
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.counts[i] / 2);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    line_quad_array_.release();
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  } else {
+    glLineWidth(std::clamp(batch.state.size, line_width_range_[0],
+                           line_width_range_[1]));
+
+    offsets_.clear();
+    for (unsigned int first : batch.firsts) {
+      offsets_.push_back(
+          reinterpret_cast<const void*>(first * sizeof(polygonType)));
+    }
+
+    // Dashes are measured from the first vertex of segment as in the
+    // legacy backend, the default convention gives the last one
+    glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
+    vertex_array_.bind();
+    glMultiDrawElements(GL_LINES, batch.counts.data(), GL_UNSIGNED_INT,
+                        offsets_.data(), batch.counts.size());
+    vertex_array_.release();
+    glProvokingVertex(GL_LAST_VERTEX_CONVENTION);
+  }
+}
+
+void ShaderRenderer::DrawPointBatch(const DrawBatch& batch) {
+  if (batch.state.element_mode == kQuadElements) {
+    point_quad_array_.bind();
+    vertex_buffer_.bind();
+
+    for (size_t i = 0; i < batch.firsts.size(); ++i) {
+      glVertexAttribPointer(
+          0, 3, GL_FLOAT, GL_FALSE, 0,
+          reinterpret_cast<const void*>(batch.firsts[i] * 3 *
+                                        sizeof(vertexType)));
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.counts[i]);
+    }
+
+    point_quad_array_.release();
+
+  } else {
+    firsts_.assign(batch.firsts.begin(), batch.firsts.end());
+
+    vertex_array_.bind();
+    glMultiDrawArrays(GL_POINTS, firsts_.data(), batch.counts.data(),
+                      batch.counts.size());
+    vertex_array_.release();
+  }
+}
+}  // namespace ModelViewer3D
@@ -0,0 +1,238 @@
+/** @file
+ * @brief Declaration of class Shader renderer
+ */
+#ifndef SRC_VIEWER_SHADER_RENDERER_SHADER_RENDERER_H_
+#define SRC_VIEWER_SHADER_RENDERER_SHADER_RENDERER_H_
+
+#include <QMatrix4x4>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QVector2D>
+#include <cstdint>
+#include <vector>
+
+#include "model/model_types.h"
+#include "viewer/render_queue/render_queue.h"
+
+struct ColorRGB;
+
+namespace ModelViewer3D {
+// Software backend rasterizes on the CPU and needs no GL for images
+enum RenderBackend { kLegacyBackend, kShaderBackend, kSoftwareBackend };
+enum ElementMode { kPrimitiveElements, kQuadElements };
+
+/** @brief Render of the model by GLSL 3.3 core programs
+ * Geometry is kept in buffer objects, the projection is passed as a matrix,
+ * dash patterns and round points are made in fragment shaders. Edges and
+ * vertices are drawn as lines and points or as instanced quads
+ */
+class ShaderRenderer : protected QOpenGLFunctions_3_3_Core {
+ public:
+  ShaderRenderer();
+
+  ShaderRenderer(const ShaderRenderer&) = delete;
+  ShaderRenderer& operator=(const ShaderRenderer&) = delete;
+
+  /** @brief Delete textures and layers, the context must be current */
+  ~ShaderRenderer();
+
+  /** @brief Compile programs and create buffers, the context of at least
+   * 3.3 version must be current
+   * @return false if the context or programs are not supported
+   */
+  bool Initialize();
+
+  /** @brief Upload the model to buffers, arrays are uploaded only when
+   * they are changed
+   * @param vertices Sequentially laid out coordinates
+   * @param vertices_count Count of vertices
+   * @param indices Consecutive pairs of indices of edges
+   * @param indices_count Count of indices
+   * @param is_vertices_changed Coordinates were changed in place
+   * @param is_indices_changed Indices were changed in place
+   */
+  void SetGeometry(const vertexType* vertices, unsigned int vertices_count,
+                   const polygonType* indices, unsigned int indices_count,
+                   bool is_vertices_changed = true,
+                   bool is_indices_changed = false);
+
+  /** @brief Upload triangles of faces, they are uploaded only when changed
+   * @param indices Consecutive triples of indices of triangles
+   * @param indices_count Count of indices
+   * @param is_changed Indices were changed in place
+   */
+  void SetTriangles(const polygonType* indices, unsigned int indices_count,
+                    bool is_changed = false);
+
+  /** @brief Draw triangles to the depth buffer before edges and vertices,
+   * so only visible ones are drawn. The depth of faces is pushed away by
+   * polygon offset, so edges on them pass the depth test
+   * @param is_enabled Hide edges and vertices behind faces
+   */
+  void SetHiddenLines(bool is_enabled);
+
+  /** @brief Upload normals of the surface, they are uploaded only when
+   * changed
+   * @param normals Sequentially laid out coordinates of unit normals
+   * @param normals_count Count of normals
+   * @param is_changed Normals were changed in place
+   */
+  void SetSurfaceNormals(const vertexType* normals, unsigned int normals_count,
+                         bool is_changed = false);
+
+  /** @brief Fill triangles lit by the light from the viewer instead of the
+   * depth only pass of hidden lines
+   * @param mode Normals per triangle or per vertex, kNoNormals disables
+   * faces
+   * @param color Color of faces lit by the full light
+   */
+  void SetSurface(SurfaceNormals mode, const ColorRGB& color);
+
+  /** @brief Set the transform from model coordinates to clip space */
+  void SetMatrix(const QMatrix4x4& matrix) { this->matrix_ = matrix; }
+
+  /** @brief Set the size of framebuffer in pixels */
+  void SetViewport(int width, int height);
+
+  /** @brief Set the way of drawing edges and vertices
+   * Quads have any width and size at the same cost, lines and points are
+   * limited by the implementation and slow when smoothed in software
+   * @param mode Lines and points or camera facing quads
+   */
+  void SetElementMode(ElementMode mode) { this->element_mode_ = mode; }
+  ElementMode GetElementMode() const { return this->element_mode_; }
+
+  /** @brief Queue edges of the model for drawing
+   * @param color Color of lines
+   * @param width Width of lines in pixels
+   * @param pattern Bits of the dash pattern, one bit per factor pixels
+   * @param factor Count of pixels per bit of pattern
+   * @param first First index of the range of edges
+   * @param count Count of indices of the range, all by default
+   */
+  void DrawLines(const ColorRGB& color, float width, uint16_t pattern = 0xFFFF,
+                 int factor = 1, unsigned int first = 0,
+                 unsigned int count = UINT32_MAX);
+
+  /** @brief Queue vertices of the model for drawing
+   * @param color Color of points
+   * @param size Size of points in pixels
+   * @param is_round Draw circles instead of squares
+   * @param first First vertex of the range
+   * @param count Count of vertices of the range, all by default
+   */
+  void DrawPoints(const ColorRGB& color, float size, bool is_round,
+                  unsigned int first = 0, unsigned int count = UINT32_MAX);
+
+  /** @brief Keep the line and point passes in cached layers
+   * Each pass is rendered to own texture and redrawn only when its items,
+   * the matrix or the geometry are changed, layers are composited by depth
+   * every frame. Costs two color and two depth textures of viewport size
+   * @param is_enabled Use layers or draw directly to the framebuffer
+   */
+  void SetLayerCache(bool is_enabled) {
+    this->is_layer_cache_enabled_ = is_enabled;
+  }
+  bool IsLayerCacheEnabled() const { return this->is_layer_cache_enabled_; }
+
+  /** @brief Submit the queued items, one multi-draw per state */
+  void Flush();
+
+ private:
+  /** @brief SubMethod for compile and link the program */
+  static bool BuildProgram(QOpenGLShaderProgram& program,
+                           const char* vertex_source,
+                           const char* fragment_source);
+
+  /** @brief SubMethod for bind the program and draw the batch */
+  void SubmitBatch(const DrawBatch& batch);
+
+  /** @brief Draw lit triangles of the surface, or fill only their depth
+   * if hidden lines are enabled
+   */
+  void DrawFaces();
+
+  /** @brief Allocate layers of the viewport size
+   * @return false if framebuffers are not complete
+   */
+  bool PrepareLayers();
+
+  /** @brief Delete textures and framebuffers of layers */
+  void DeleteLayers();
+
+  /** @brief Draw layers to the bound framebuffer, the nearest fragment of
+   * layers wins
+   */
+  void CompositeLayers();
+
+  /** @brief SubMethod for draw ranges of edges, the program is bound */
+  void DrawLineBatch(const DrawBatch& batch, QOpenGLShaderProgram& program);
+
+  /** @brief SubMethod for draw ranges of vertices, the program is bound */
+  void DrawPointBatch(const DrawBatch& batch);
+
+  QOpenGLShaderProgram line_program_;
+  QOpenGLShaderProgram point_program_;
+  QOpenGLShaderProgram line_quad_program_;
+  QOpenGLShaderProgram point_quad_program_;
+  QOpenGLShaderProgram composite_program_;
+  QOpenGLShaderProgram depth_program_;
+  QOpenGLShaderProgram surface_program_;
+  QOpenGLVertexArrayObject vertex_array_;
+  // Edges and vertices are attributes of instances
+  QOpenGLVertexArrayObject line_quad_array_;
+  QOpenGLVertexArrayObject point_quad_array_;
+  // Vertices indexed by triangles of faces
+  QOpenGLVertexArrayObject triangle_array_;
+  // Full screen triangle has no attributes
+  QOpenGLVertexArrayObject composite_array_;
+  // Vertices fetched by indices of the edge instance
+  GLuint position_texture_ = 0;
+  // Normals of triangles fetched by the primitive of flat faces
+  GLuint normal_texture_ = 0;
+  ElementMode element_mode_ = kPrimitiveElements;
+  /** @brief Render target of one pass kept between frames */
+  struct Layer {
+    GLuint framebuffer = 0;
+    GLuint color_texture = 0;
+    GLuint depth_texture = 0;
+    // Batches of the pass drawn into the layer
+    std::vector<DrawBatch> batches;
+    bool is_valid = false;
+  };
+  // Indexed by DrawPass
+  static const int kLayersCount = 2;
+  Layer layers_[kLayersCount];
+  int layers_width_ = 0;
+  int layers_height_ = 0;
+  QMatrix4x4 layers_matrix_;
+  bool is_layer_cache_enabled_ = true;
+  bool is_geometry_changed_ = true;
+  RenderQueue queue_;
+  // Arguments of multi-draws in types of GL
+  std::vector<const void*> offsets_;
+  std::vector<GLint> firsts_;
+  QOpenGLBuffer vertex_buffer_;
+  QOpenGLBuffer index_buffer_;
+  QOpenGLBuffer triangle_buffer_;
+  QOpenGLBuffer normal_buffer_;
+  QMatrix4x4 matrix_;
+  QVector2D viewport_;
+  const vertexType* vertices_ = nullptr;
+  const polygonType* indices_ = nullptr;
+  unsigned int indices_count_ = 0;
+  unsigned int vertices_count_ = 0;
+  const polygonType* triangles_ = nullptr;
+  unsigned int triangles_count_ = 0;
+  bool is_hidden_lines_ = false;
+  const vertexType* normals_ = nullptr;
+  unsigned int normals_count_ = 0;
+  SurfaceNormals surface_mode_ = kNoNormals;
+  float surface_color_[3] = {0, 0, 0};
+  float line_width_range_[2] = {1, 1};
+};
+}  // namespace ModelViewer3D
+
+#endif  // SRC_VIEWER_SHADER_RENDERER_SHADER_RENDERER_H_
@@ -0,0 +1,266 @@
+/** @file
+ * @brief Definition of class Tiled renderer
+ */
+#include "viewer/tiled_renderer/tiled_renderer.h"
+
+#include <QFile>
+#include <QFuture>
+#include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cstdint>
+
+namespace ModelViewer3D {
+static const int kBmpHeaderSize = 54;
+
+/** @brief Store the value in little-endian order */
+static void PutLittleEndian(char* out, uint32_t value, int size) {
+  for (int i = 0; i < size; ++i) {
+    out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+/** @brief Write headers of the bottom-up 24-bit BMP */
+static bool WriteBmpHeader(QFile& file, int width, int height,
+                           uint32_t image_size) {
+  char header[kBmpHeaderSize] = {'B', 'M'};
+  PutLittleEndian(header + 2, kBmpHeaderSize + image_size, 4);
+  PutLittleEndian(header + 10, kBmpHeaderSize, 4);
+  // Info header
+  PutLittleEndian(header + 14, 40, 4);
+  PutLittleEndian(header + 18, width, 4);
+  PutLittleEndian(header + 22, height, 4);
+  PutLittleEndian(header + 26, 1, 2);
+  PutLittleEndian(header + 28, 24, 2);
+  PutLittleEndian(header + 34, image_size, 4);
+  // 72 dpi
+  PutLittleEndian(header + 38, 2835, 4);
+  PutLittleEndian(header + 42, 2835, 4);
+
+  return file.write(header, kBmpHeaderSize) == kBmpHeaderSize;
+}
+
+/** @brief Get the size of the row of BMP, zero if the image is too large */
+static uint64_t BmpRowSize(int width, int height) {
+  // Rows of BMP are aligned to 4 bytes, as rows packed by GL by default
+  const uint64_t row_size = (static_cast<uint64_t>(width) * 3 + 3) & ~3ull;
+  if (kBmpHeaderSize + row_size * height > UINT32_MAX) {
+    return 0;
+  }
+
+  return row_size;
+}
+
+bool TiledRenderer::Render(const QString& path, int width, int height,
+                           const DrawFunction& draw) {
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+
+  initializeOpenGLFunctions();
+
+  const uint64_t row_size = BmpRowSize(width, height);
+  const uint64_t image_size = row_size * height;
+  if (!row_size) {
+    return false;
+  }
+
+  const int tile_size = this->TileSize();
+  QOpenGLFramebufferObject framebuffer(std::min(tile_size, width),
+                                       std::min(tile_size, height),
+                                       QOpenGLFramebufferObject::Depth);
+  QFile file(path);
+
+  if (!framebuffer.isValid() || !file.open(QIODevice::WriteOnly) ||
+      !WriteBmpHeader(file, width, height, image_size)) {
+    return false;
+  }
+
+  GLint target = 0;
+  GLint viewport[4] = {0, 0, 0, 0};
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+  glGetIntegerv(GL_VIEWPORT, viewport);
+
+  // Pixels of the tile are read to its place in the strip
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glPixelStorei(GL_PACK_ROW_LENGTH, width);
+
+  // One strip is written from the mapped buffer while GL renders the other
+  QOpenGLBuffer strips[2] = {QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer),
+                             QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer)};
+  QFuture<bool> writes[2];
+  bool is_mapped[2] = {false, false};
+  bool is_written = true;
+
+  for (QOpenGLBuffer& strip : strips) {
+    strip.setUsagePattern(QOpenGLBuffer::StreamRead);
+    strip.create();
+    strip.bind();
+    strip.allocate(static_cast<int>(row_size * framebuffer.height()));
+    strip.release();
+  }
+
+  // Strip is written after the read of the next one is queued
+  auto write_strip = [&](int index, int strip_height) {
+    strips[index].bind();
+    const char* pixels =
+        static_cast<const char*>(strips[index].map(QOpenGLBuffer::ReadOnly));
+    strips[index].release();
+
+    if (!pixels) {
+      is_written = false;
+      return;
+    }
+
+    is_mapped[index] = true;
+    const qint64 size = row_size * strip_height;
+    writes[index] = QtConcurrent::run([&file, pixels, size]() {
+      return file.write(pixels, size) == size;
+    });
+  };
+
+  auto finish_strip = [&](int index) {
+    if (!is_mapped[index]) return;
+    is_written = writes[index].result() && is_written;
+    strips[index].bind();
+    strips[index].unmap();
+    strips[index].release();
+    is_mapped[index] = false;
+  };
+
+  // BMP rows go from the bottom, as rows of GL
+  int previous_height = 0;
+  for (int y = 0, index = 0; y < height && is_written;
+       y += tile_size, index ^= 1) {
+    const int strip_height = std::min(tile_size, height - y);
+    finish_strip(index);
+
+    for (int x = 0; x < width; x += tile_size) {
+      const int tile_width = std::min(tile_size, width - x);
+      framebuffer.bind();
+      glViewport(0, 0, tile_width, strip_height);
+      draw(TileMatrix(x, y, tile_width, strip_height, width, height),
+           tile_width, strip_height);
+
+      strips[index].bind();
+      glPixelStorei(GL_PACK_SKIP_PIXELS, x);
+      glReadPixels(0, 0, tile_width, strip_height, GL_BGR, GL_UNSIGNED_BYTE,
+                   nullptr);
+      strips[index].release();
+    }
+
+    // Writes keep the order, the previous one is finished above
+    if (previous_height) write_strip(index ^ 1, previous_height);
+    previous_height = strip_height;
+
+    if (y + tile_size >= height) {
+      finish_strip(index ^ 1);
+      write_strip(index, strip_height);
+      finish_strip(index);
+    }
+  }
+
+  finish_strip(0);
+  finish_strip(1);
+
+  glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+  glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, target);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  return is_written;
+}
+
+bool TiledRenderer::RenderImages(const QString& path, int width, int height,
+                                 const ImageFunction& draw) {
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+
+  const uint64_t row_size = BmpRowSize(width, height);
+  QFile file(path);
+
+  if (!row_size || !file.open(QIODevice::WriteOnly) ||
+      !WriteBmpHeader(file, width, height, row_size * height)) {
+    return false;
+  }
+
+  // One strip is written by the worker while the next one is drawn
+  QByteArray strips[2];
+  QFuture<bool> writes[2];
+  bool is_pending[2] = {false, false};
+  bool is_written = true;
+
+  auto finish_write = [&](int index) {
+    if (!is_pending[index]) return;
+    is_written = writes[index].result() && is_written;
+    is_pending[index] = false;
+  };
+
+  // BMP rows go from the bottom, rows of the image go from the top
+  for (int y = 0, index = 0; y < height && is_written;
+       y += kImageStripHeight, index ^= 1) {
+    const int strip_height = std::min(kImageStripHeight, height - y);
+    const QImage image =
+        draw(TileMatrix(0, y, width, strip_height, width, height), width,
+             strip_height);
+    if (image.width() != width || image.height() != strip_height ||
+        image.format() != QImage::Format_RGB32) {
+      is_written = false;
+      break;
+    }
+
+    QByteArray& strip = strips[index];
+    strip.fill(0, static_cast<int>(row_size * strip_height));
+    for (int row = 0; row < strip_height; ++row) {
+      const QRgb* pixel = reinterpret_cast<const QRgb*>(
+          image.constScanLine(strip_height - 1 - row));
+      char* out = strip.data() + row_size * row;
+
+      for (int x = 0; x < width; ++x, out += 3) {
+        out[0] = static_cast<char>(qBlue(pixel[x]));
+        out[1] = static_cast<char>(qGreen(pixel[x]));
+        out[2] = static_cast<char>(qRed(pixel[x]));
+      }
+    }
+
+    // Writes keep the order, the file is written by one of them at a time
+    finish_write(index ^ 1);
+    const char* pixels = strip.constData();
+    const qint64 size = strip.size();
+    writes[index] = QtConcurrent::run([&file, pixels, size]() {
+      return file.write(pixels, size) == size;
+    });
+    is_pending[index] = true;
+  }
+
+  finish_write(0);
+  finish_write(1);
+
+  return is_written;
+}
+
+QMatrix4x4 TiledRenderer::TileMatrix(int x, int y, int tile_width,
+                                     int tile_height, int width,
+                                     int height) {
+  QMatrix4x4 matrix;
+  matrix.scale(static_cast<float>(width) / tile_width,
+               static_cast<float>(height) / tile_height, 1);
+  // Center of the tile in normalized coordinates is moved to the origin
+  matrix.translate(1 - (2.0f * x + tile_width) / width,
+                   1 - (2.0f * y + tile_height) / height, 0);
+  return matrix;
+}
+
+int TiledRenderer::TileSize() {
+  GLint viewport_dims[2] = {kMaxTileSize, kMaxTileSize};
+  GLint renderbuffer_size = kMaxTileSize;
+  glGetIntegerv(GL_MAX_VIEWPORT_DIMS, viewport_dims);
+  glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &renderbuffer_size);
+
+  return std::min({kMaxTileSize, static_cast<int>(viewport_dims[0]),
+                   static_cast<int>(viewport_dims[1]),
+                   static_cast<int>(renderbuffer_size)});
+}
+}  // namespace ModelViewer3D
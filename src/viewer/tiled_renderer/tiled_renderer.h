@@ -0,0 +1,85 @@
+/** @file
+ * @brief Declaration of class Tiled renderer
+ */
+#ifndef SRC_VIEWER_TILED_RENDERER_TILED_RENDERER_H_
+#define SRC_VIEWER_TILED_RENDERER_TILED_RENDERER_H_
+
+#include <QImage>
+#include <QMatrix4x4>
+#include <QOpenGLFunctions>
+#include <QString>
+#include <functional>
+
+namespace ModelViewer3D {
+/** @brief Offscreen render of images larger than the framebuffer limits
+ * The view is split into tiles of the frustum, each tile is rendered to an
+ * own framebuffer object and read to a pixel buffer of its strip. Strips are
+ * written to a bottom-up BMP file by a worker while the next strip is
+ * rendered, so the whole image is never kept in memory. Views rendered on
+ * the CPU are written by strips of the same way
+ */
+class TiledRenderer : protected QOpenGLFunctions {
+ public:
+  /** @brief Draw of the view to the bound framebuffer
+   * @param tile Transform of clip space selecting the tile of the view
+   * @param width Width of the tile in pixels
+   * @param height Height of the tile in pixels
+   */
+  using DrawFunction =
+      std::function<void(const QMatrix4x4& tile, int width, int height)>;
+
+  /** @brief Render the view by tiles to the file, the context must be
+   * current. The bound framebuffer and viewport are restored after
+   * @param path Path of the BMP file
+   * @param width Width of the image in pixels
+   * @param height Height of the image in pixels
+   * @param draw Draw of the view
+   * @return false if the file could not be written or the framebuffer
+   * could not be created
+   */
+  bool Render(const QString& path, int width, int height,
+              const DrawFunction& draw);
+
+  /** @brief Draw of the view to the image in memory
+   * @param tile Transform of clip space selecting the strip of the view
+   * @param width Width of the strip in pixels
+   * @param height Height of the strip in pixels
+   * @return Image of the strip, which is valid until the next draw
+   */
+  using ImageFunction =
+      std::function<QImage(const QMatrix4x4& tile, int width, int height)>;
+
+  /** @brief Render the view by strips to the file, no context is needed
+   * @param path Path of the BMP file
+   * @param width Width of the image in pixels
+   * @param height Height of the image in pixels
+   * @param draw Draw of the view
+   * @return false if the file could not be written
+   */
+  bool RenderImages(const QString& path, int width, int height,
+                    const ImageFunction& draw);
+
+  /** @brief Get the transform of clip space, which stretches the part of
+   * the view to the whole viewport
+   * @param x Left pixel of the tile in the image
+   * @param y Bottom pixel of the tile in the image
+   * @param tile_width Width of the tile in pixels
+   * @param tile_height Height of the tile in pixels
+   * @param width Width of the image in pixels
+   * @param height Height of the image in pixels
+   */
+  static QMatrix4x4 TileMatrix(int x, int y, int tile_width, int tile_height,
+                               int width, int height);
+
+  // Larger tiles need larger strips in memory of GL
+  static const int kMaxTileSize = 1024;
+  // Strips drawn in memory are of the full width, so they are lower
+  static const int kImageStripHeight = 256;
+
+ private:
+  /** @brief Get the tile size supported by the implementation */
+  int TileSize();
+};
+}  // namespace ModelViewer3D
+
+#endif  // SRC_VIEWER_TILED_RENDERER_TILED_RENDERER_H_
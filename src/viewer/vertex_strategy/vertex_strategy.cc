@@ -3,6 +3,9 @@
  */
 #include "viewer/vertex_strategy/vertex_strategy.h"
 
+#include "common/color_utils.h"
+#include "model/software_rasterizer.h"
+#include "viewer/shader_renderer/shader_renderer.h"
 #include "viewer/viewer.h"
 
 namespace ModelViewer3D {
@@ -19,12 +22,36 @@ void VertexStrategy::VertexRender(Viewer& viewer) {
 
 void SquareVertex::Use(Viewer& viewer) { VertexRender(viewer); }
 
+void SquareVertex::Use(Viewer& viewer, ShaderRenderer& renderer) {
+  ElementSettings vertex_settings = viewer.get_vertex_settings();
+  renderer.DrawPoints(vertex_settings.color, vertex_settings.size, false);
+}
+
+void SquareVertex::Use(Viewer& viewer, SoftwareRasterizer& rasterizer) {
+  ElementSettings vertex_settings = viewer.get_vertex_settings();
+  ColorRGB color = vertex_settings.color;
+  rasterizer.DrawPoints(rgbToQRgb(color.r, color.g, color.b),
+                        static_cast<int>(vertex_settings.size), false);
+}
+
 void RoundVertex::Use(Viewer& viewer) {
   glEnable(GL_POINT_SMOOTH);
   VertexRender(viewer);
   glDisable(GL_POINT_SMOOTH);
 }
 
+void RoundVertex::Use(Viewer& viewer, ShaderRenderer& renderer) {
+  ElementSettings vertex_settings = viewer.get_vertex_settings();
+  renderer.DrawPoints(vertex_settings.color, vertex_settings.size, true);
+}
+
+void RoundVertex::Use(Viewer& viewer, SoftwareRasterizer& rasterizer) {
+  ElementSettings vertex_settings = viewer.get_vertex_settings();
+  ColorRGB color = vertex_settings.color;
+  rasterizer.DrawPoints(rgbToQRgb(color.r, color.g, color.b),
+                        static_cast<int>(vertex_settings.size), true);
+}
+
 VertexType SquareVertex::Type() { return kSquareVertex; }
 
 VertexType RoundVertex::Type() { return kRoundVertex; }
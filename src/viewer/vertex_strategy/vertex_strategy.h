@@ -7,6 +7,9 @@
 class Viewer;
 
 namespace ModelViewer3D {
+class ShaderRenderer;
+class SoftwareRasterizer;
+
 enum VertexType { kNoneVertex, kSquareVertex, kRoundVertex };
 class VertexStrategy {
  public:
@@ -17,6 +20,16 @@ class VertexStrategy {
    * @param viewer class parent
    */
   virtual void Use(Viewer& viewer) = 0;
+  /** @brief Draws vertices of the selected type by shader programs
+   * @param viewer class parent
+   * @param renderer renderer of the core profile
+   */
+  virtual void Use(Viewer& viewer, ShaderRenderer& renderer) = 0;
+  /** @brief Draws vertices of the selected type on the CPU
+   * @param viewer class parent
+   * @param rasterizer rasterizer of the software backend
+   */
+  virtual void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) = 0;
   /** @brief Gets the type of strategy used
    */
   virtual VertexType Type() = 0;
@@ -28,12 +41,16 @@ class VertexStrategy {
 class SquareVertex : public VertexStrategy {
  public:
   void Use(Viewer& viewer) override;
+  void Use(Viewer& viewer, ShaderRenderer& renderer) override;
+  void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) override;
   VertexType Type() override;
 };
 
 class RoundVertex : public VertexStrategy {
  public:
   void Use(Viewer& viewer) override;
+  void Use(Viewer& viewer, ShaderRenderer& renderer) override;
+  void Use(Viewer& viewer, SoftwareRasterizer& rasterizer) override;
   VertexType Type() override;
 };
 
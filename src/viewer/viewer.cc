@@ -4,27 +4,302 @@
 
 #include "viewer/viewer.h"
 
+#include <QGuiApplication>
+#include <QPainter>
+#include <QScreen>
+#include <QSurfaceFormat>
+#include <algorithm>
 #include <vector>
 
 #include "common/color_utils.h"
 #include "controller/controller.h"
+#include "viewer/tiled_renderer/tiled_renderer.h"
 
-Viewer::Viewer(QWidget* parent) : QOpenGLWidget(parent) {}
+Viewer::Viewer(QWidget* parent) : QOpenGLWidget(parent) {
+  frame_timer_.setSingleShot(true);
+  frame_timer_.setTimerType(Qt::PreciseTimer);
+  connect(&frame_timer_, &QTimer::timeout, this, [this]() {
+    // Changes could be already drawn by resizing or grabbing
+    if (changes_) update();
+  });
+  frame_clock_.start();
+
+  capture_timer_.setSingleShot(true);
+  connect(&capture_timer_, &QTimer::timeout, this, &Viewer::CollectFrames);
+}
 
 Viewer::~Viewer() {
+  if (shader_renderer_ || frame_reader_) {
+    // Buffers and programs are released in own context
+    makeCurrent();
+    delete shader_renderer_;
+    delete frame_reader_;
+    doneCurrent();
+  }
   if (projection_strategy_) delete projection_strategy_;
   if (vertex_strategy_) delete vertex_strategy_;
   if (line_strategy_) delete line_strategy_;
 }
 
-void Viewer::initializeGL() { glEnable(GL_DEPTH_TEST); }
+void Viewer::set_render_backend(ModelViewer3D::RenderBackend backend) {
+  render_backend_ = backend;
+
+  if (backend == ModelViewer3D::kShaderBackend) {
+    QSurfaceFormat surface_format = format();
+    surface_format.setVersion(3, 3);
+    surface_format.setProfile(QSurfaceFormat::CoreProfile);
+    setFormat(surface_format);
+  }
+}
+
+void Viewer::RequestFrame(unsigned int changes) {
+  ++frames_requested_;
+  if (!changes) return;
+
+  changes_ |= changes;
+  if (frame_timer_.isActive()) return;
+
+  qint64 wait = FrameInterval() - frame_clock_.elapsed();
+  frame_timer_.start(wait > 0 ? static_cast<int>(wait) : 0);
+}
+
+void Viewer::CaptureFrame(ModelViewer3D::FrameReader::Callback callback) {
+  if (render_backend_ == ModelViewer3D::kSoftwareBackend) {
+    callback(RenderImage(QSize(qRound(width() * devicePixelRatioF()),
+                               qRound(height() * devicePixelRatioF()))));
+    return;
+  }
+
+  if (!frame_reader_) {
+    // Nothing is rendered yet
+    callback(grabFramebuffer());
+    return;
+  }
+
+  // Framebuffer of the widget keeps the last frame
+  makeCurrent();
+  frame_reader_->Read(qRound(width() * devicePixelRatioF()),
+                      qRound(height() * devicePixelRatioF()),
+                      std::move(callback));
+  doneCurrent();
+
+  if (!capture_timer_.isActive()) capture_timer_.start(FrameInterval());
+}
+
+void Viewer::CollectFrames() {
+  if (!frame_reader_ || !frame_reader_->HasPending()) return;
+
+  makeCurrent();
+  std::vector<ModelViewer3D::FrameReader::Frame> frames =
+      frame_reader_->Collect();
+  doneCurrent();
+
+  for (ModelViewer3D::FrameReader::Frame& frame : frames) {
+    frame.callback(frame.image);
+  }
+}
+
+void Viewer::set_frame_rate_cap(int fps) {
+  frame_rate_cap_ = fps > 0 ? fps : 0;
+}
+
+int Viewer::FrameInterval() {
+  double rate = frame_rate_cap_;
+
+  if (rate <= 0) {
+    QScreen* display = QGuiApplication::primaryScreen();
+    rate = display ? display->refreshRate() : 60;
+  }
+
+  return rate > 0 ? static_cast<int>(1000 / rate) : 0;
+}
+
+void Viewer::initializeGL() {
+  glEnable(GL_DEPTH_TEST);
+  // Buffers of the new context are empty
+  changes_ = ModelViewer3D::kAllChanges;
+
+  if (!frame_reader_) frame_reader_ = new ModelViewer3D::FrameReader;
+  frame_reader_->Initialize();
+
+  if (render_backend_ == ModelViewer3D::kShaderBackend) {
+    shader_renderer_ = new ModelViewer3D::ShaderRenderer;
+
+    if (!shader_renderer_->Initialize()) {
+      delete shader_renderer_;
+      shader_renderer_ = nullptr;
+
+      // Fixed function calls are invalid in the core context, the image of
+      // the software backend is drawn there by QPainter
+      bool is_core =
+          context()->format().profile() == QSurfaceFormat::CoreProfile;
+      render_backend_ = is_core ? ModelViewer3D::kSoftwareBackend
+                                : ModelViewer3D::kLegacyBackend;
+      emit RenderBackendFailed(
+          QString("Shader render backend is not supported, %1 one is used")
+              .arg(is_core ? "software" : "legacy"));
+    }
+  }
+}
 
 void Viewer::paintGL() {
+  ApplyPendingInput();
+  ++frames_rendered_;
+  frame_clock_.restart();
+
+  if (render_backend_ == ModelViewer3D::kSoftwareBackend) {
+    QImage image = RenderImage(QSize(qRound(width() * devicePixelRatioF()),
+                                     qRound(height() * devicePixelRatioF())));
+    image.setDevicePixelRatio(devicePixelRatioF());
+    QPainter painter(this);
+    painter.drawImage(0, 0, image);
+    changes_ = ModelViewer3D::kNoChange;
+    return;
+  }
+
+  DrawFrame(QMatrix4x4(),
+            QSize(qRound(width() * devicePixelRatioF()),
+                  qRound(height() * devicePixelRatioF())),
+            is_layer_cache_enabled_);
+
+  changes_ = ModelViewer3D::kNoChange;
+}
+
+bool Viewer::RenderToFile(const QString& path, int width, int height) {
+  if (width <= 0 || height <= 0) return false;
+
+  if (render_backend_ != ModelViewer3D::kSoftwareBackend && !isValid()) {
+    return false;
+  }
+
+  float aspect_ratio = aspect_ratio_;
+  aspect_ratio_ = static_cast<float>(width) / static_cast<float>(height);
+  Resize();
+
+  // Strips of the software backend share the pixels of the rasterizer
+  if (render_backend_ == ModelViewer3D::kSoftwareBackend) {
+    ModelViewer3D::TiledRenderer renderer;
+    bool is_rendered = renderer.RenderImages(
+        path, width, height,
+        [this](const QMatrix4x4& tile, int strip_width, int strip_height) {
+          QSize size(strip_width, strip_height);
+          RasterizeView(tile, size);
+          return QImage(reinterpret_cast<const uchar*>(
+                            software_rasterizer_.GetPixels()),
+                        size.width(), size.height(), QImage::Format_RGB32);
+        });
+
+    aspect_ratio_ = aspect_ratio;
+    Resize();
+    return is_rendered;
+  }
+
+  makeCurrent();
+
+  // Layers are kept for the widget, tiles are drawn directly
+  ModelViewer3D::TiledRenderer renderer;
+  bool is_rendered = renderer.Render(
+      path, width, height,
+      [this](const QMatrix4x4& tile, int tile_width, int tile_height) {
+        DrawFrame(tile, QSize(tile_width, tile_height), false);
+      });
+
+  aspect_ratio_ = aspect_ratio;
+  Resize();
+  doneCurrent();
+
+  return is_rendered;
+}
+
+QImage Viewer::RenderImage(const QSize& size) {
+  float aspect_ratio = aspect_ratio_;
+  aspect_ratio_ = static_cast<float>(size.width()) /
+                  static_cast<float>(std::max(size.height(), 1));
+  Resize();
+
+  RasterizeView(QMatrix4x4(), size);
+
+  aspect_ratio_ = aspect_ratio;
+  Resize();
+
+  // Pixels of the rasterizer are reused by the next frame
+  return QImage(
+             reinterpret_cast<const uchar*>(software_rasterizer_.GetPixels()),
+             size.width(), size.height(), QImage::Format_RGB32)
+      .copy();
+}
+
+void Viewer::RasterizeView(const QMatrix4x4& tile, const QSize& size) {
+  QMatrix4x4 matrix = tile;
+  if (projection_strategy_) matrix *= projection_strategy_->Matrix();
+  matrix.translate(0, 0, -15);
+
+  software_rasterizer_.Resize(size.width(), size.height());
+  software_rasterizer_.Clear(ModelViewer3D::rgbToQRgb(
+      background_color_.r, background_color_.g, background_color_.b));
+  software_rasterizer_.SetMatrix(matrix.constData());
+  software_rasterizer_.SetGeometry(vertices_array_, vertices_size_);
+  if (HasSurface()) {
+    software_rasterizer_.DrawSurface(
+        triangles_array_, triangles_size_, surface_normals_array_,
+        surface_mode_ == ModelViewer3D::kSmoothNormals,
+        ModelViewer3D::rgbToQRgb(surface_color_.r, surface_color_.g,
+                                 surface_color_.b));
+  } else if (is_hidden_lines_) {
+    software_rasterizer_.DrawOccluders(triangles_array_, triangles_size_);
+  }
+
+  if (vertex_strategy_) vertex_strategy_->Use(*this, software_rasterizer_);
+  if (line_strategy_) line_strategy_->Use(*this, software_rasterizer_);
+}
+
+void Viewer::DrawFrame(const QMatrix4x4& tile, const QSize& size,
+                       bool is_cached) {
   glClearColor(background_color_.r, background_color_.g, background_color_.b,
                1);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  if (shader_renderer_) {
+    PaintShader(tile, size, is_cached);
+  } else {
+    PaintLegacy(tile);
+  }
+}
+
+void Viewer::PaintShader(const QMatrix4x4& tile, const QSize& size,
+                         bool is_cached) {
+  QMatrix4x4 matrix = tile;
+  if (projection_strategy_) matrix *= projection_strategy_->Matrix();
+  matrix.translate(0, 0, -15);
+
+  shader_renderer_->SetMatrix(matrix);
+  shader_renderer_->SetElementMode(element_mode_);
+  shader_renderer_->SetLayerCache(is_cached);
+  shader_renderer_->SetViewport(size.width(), size.height());
+  shader_renderer_->SetGeometry(
+      vertices_array_, vertices_size_, faces_array_, faces_size_,
+      changes_ & (ModelViewer3D::kTransformChange |
+                  ModelViewer3D::kGeometryChange),
+      changes_ & ModelViewer3D::kGeometryChange);
+  shader_renderer_->SetTriangles(triangles_array_, triangles_size_,
+                                 changes_ & ModelViewer3D::kGeometryChange);
+  shader_renderer_->SetHiddenLines(is_hidden_lines_);
+  shader_renderer_->SetSurfaceNormals(
+      HasSurface() ? surface_normals_array_ : nullptr, surface_normals_size_,
+      changes_ & (ModelViewer3D::kTransformChange |
+                  ModelViewer3D::kGeometryChange));
+  shader_renderer_->SetSurface(
+      HasSurface() ? surface_mode_ : ModelViewer3D::kNoNormals,
+      surface_color_);
+
+  if (vertex_strategy_) vertex_strategy_->Use(*this, *shader_renderer_);
+  if (line_strategy_) line_strategy_->Use(*this, *shader_renderer_);
+  shader_renderer_->Flush();
+}
+
+void Viewer::PaintLegacy(const QMatrix4x4& tile) {
   glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
+  glLoadMatrixf(tile.constData());
 
   if (projection_strategy_) projection_strategy_->Use();
   glTranslatef(0, 0, -15);
@@ -35,15 +310,88 @@ void Viewer::paintGL() {
   }
 
   glEnableClientState(GL_VERTEX_ARRAY);
+  if (HasSurface()) {
+    PaintLegacySurface();
+  } else if (is_hidden_lines_ && vertices_array_ && triangles_array_) {
+    // Faces fill only the depth, pushed away so their own edges pass
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1, 1);
+    glDrawElements(GL_TRIANGLES, triangles_size_, GL_UNSIGNED_INT,
+                   triangles_array_);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  }
   if (vertex_strategy_) vertex_strategy_->Use(*this);
   if (line_strategy_) line_strategy_->Use(*this);
   glDisableClientState(GL_VERTEX_ARRAY);
 }
 
+bool Viewer::HasSurface() {
+  if (surface_mode_ == ModelViewer3D::kNoNormals || !vertices_array_ ||
+      !triangles_array_ || !surface_normals_array_) {
+    return false;
+  }
+
+  return surface_normals_size_ ==
+         (surface_mode_ == ModelViewer3D::kFlatNormals ? triangles_size_ / 3
+                                                       : vertices_size_);
+}
+
+void Viewer::PaintLegacySurface() {
+  // Two sided light goes from the viewer as in other backends, the model
+  // view is never changed, so the directional light stays along Z
+  const GLfloat ambient[] = {ModelViewer3D::SoftwareRasterizer::kAmbient,
+                             ModelViewer3D::SoftwareRasterizer::kAmbient,
+                             ModelViewer3D::SoftwareRasterizer::kAmbient, 1};
+  const GLfloat diffuse[] = {ModelViewer3D::SoftwareRasterizer::kDiffuse,
+                             ModelViewer3D::SoftwareRasterizer::kDiffuse,
+                             ModelViewer3D::SoftwareRasterizer::kDiffuse, 1};
+  const GLfloat direction[] = {0, 0, 1, 0};
+  glLightfv(GL_LIGHT0, GL_POSITION, direction);
+  glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+  glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
+  glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+  glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+  glEnable(GL_COLOR_MATERIAL);
+  glEnable(GL_LIGHTING);
+  glEnable(GL_LIGHT0);
+  glColor3f(surface_color_.r, surface_color_.g, surface_color_.b);
+
+  // Faces are pushed away, so their own edges pass the depth test
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1, 1);
+
+  if (surface_mode_ == ModelViewer3D::kSmoothNormals) {
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, 0, surface_normals_array_);
+    glDrawElements(GL_TRIANGLES, triangles_size_, GL_UNSIGNED_INT,
+                   triangles_array_);
+    glDisableClientState(GL_NORMAL_ARRAY);
+  } else {
+    // Normals per triangle have no array in the fixed function pipeline
+    glBegin(GL_TRIANGLES);
+    for (unsigned int i = 0; i + 2 < triangles_size_; i += 3) {
+      glNormal3fv(surface_normals_array_ + i);
+      glArrayElement(triangles_array_[i]);
+      glArrayElement(triangles_array_[i + 1]);
+      glArrayElement(triangles_array_[i + 2]);
+    }
+    glEnd();
+  }
+
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  glDisable(GL_LIGHT0);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_COLOR_MATERIAL);
+}
+
 void Viewer::resizeGL(int w, int h) {
   glViewport(0, 0, w, h);
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
+  if (render_backend_ == ModelViewer3D::kLegacyBackend) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+  }
 
   aspect_ratio_ = static_cast<float>(w) / static_cast<float>(h);
 
@@ -56,28 +404,43 @@ void Viewer::mousePressEvent(QMouseEvent* event) {
 
 void Viewer::mouseMoveEvent(QMouseEvent* event) {
   if (event->buttons() & Qt::LeftButton) {
-    ModelViewer3D::Controller& controller = ModelViewer3D::Controller::Instance();
-    controller.RotateModel(
-        (event->pos().rx() - last_mouse_pos_.rx()) / (width() / kSensitivity),
-        ModelViewer3D::kY);
-    controller.RotateModel(
-        (last_mouse_pos_.ry() - event->pos().ry()) / (height() / kSensitivity),
-        ModelViewer3D::kX);
+    pending_rotate_y_ +=
+        (event->pos().rx() - last_mouse_pos_.rx()) / (width() / kSensitivity);
+    pending_rotate_x_ +=
+        (last_mouse_pos_.ry() - event->pos().ry()) / (height() / kSensitivity);
   }
 
   if (event->buttons() & Qt::RightButton) {
     const double kTranslateSensitivity = kSensitivity * 1.5;
-    ModelViewer3D::Controller& controller = ModelViewer3D::Controller::Instance();
-    controller.TranslateModelPosition(
-        (event->pos().rx() - last_mouse_pos_.rx()) /
-            (width() / kTranslateSensitivity),
-        (last_mouse_pos_.ry() - event->pos().ry()) /
-            (height() / kTranslateSensitivity),
-        0);
+    pending_translate_x_ += (event->pos().rx() - last_mouse_pos_.rx()) /
+                            (width() / kTranslateSensitivity);
+    pending_translate_y_ += (last_mouse_pos_.ry() - event->pos().ry()) /
+                            (height() / kTranslateSensitivity);
   }
 
   last_mouse_pos_ = event->pos();
-  update();
+  RequestFrame(ModelViewer3D::kTransformChange);
+}
+
+void Viewer::ApplyPendingInput() {
+  if (!pending_rotate_x_ && !pending_rotate_y_ && !pending_translate_x_ &&
+      !pending_translate_y_) {
+    return;
+  }
+
+  // Y rotation first, then X rotation, then translation, in one pass
+  ModelViewer3D::AffineTransform transform =
+      ModelViewer3D::AffineTransform::Translation(pending_translate_x_,
+                                                  pending_translate_y_, 0) *
+      ModelViewer3D::AffineTransform::RotationX(pending_rotate_x_) *
+      ModelViewer3D::AffineTransform::RotationY(pending_rotate_y_);
+
+  ModelViewer3D::Controller::Instance().TransformModel(transform);
+
+  pending_rotate_x_ = 0;
+  pending_rotate_y_ = 0;
+  pending_translate_x_ = 0;
+  pending_translate_y_ = 0;
 }
 
 void Viewer::wheelEvent(QWheelEvent* event) {
@@ -88,5 +451,5 @@ void Viewer::wheelEvent(QWheelEvent* event) {
     controller.SetModelScale(1 / kScaleStep);
   }
 
-  update();
+  RequestFrame(ModelViewer3D::kTransformChange);
 }
@@ -4,16 +4,37 @@
 #ifndef SRC_VIEWER_VIEWER_H_
 #define SRC_VIEWER_VIEWER_H_
 
+#include <QElapsedTimer>
 #include <QMouseEvent>
 #include <QOpenGLWidget>
+#include <QTimer>
 #include <QWheelEvent>
 #include <vector>
 
 #include "model/model_types.h"
+#include "model/software_rasterizer.h"
+#include "viewer/frame_reader/frame_reader.h"
 #include "viewer/line_strategy/line_strategy.h"
 #include "viewer/projection_strategy/projection_strategy.h"
+#include "viewer/shader_renderer/shader_renderer.h"
 #include "viewer/vertex_strategy/vertex_strategy.h"
 
+namespace ModelViewer3D {
+/** @brief Parts of the frame changed since the last rendering */
+enum FrameChange {
+  kNoChange = 0,
+  // Coordinates of vertices are transformed in place
+  kTransformChange = 1 << 0,
+  // Background, line or vertex color
+  kColorChange = 1 << 1,
+  // Projection, line or vertex strategy and sizes of elements
+  kStrategyChange = 1 << 2,
+  // Arrays of vertices and faces are replaced
+  kGeometryChange = 1 << 3,
+  kAllChanges = (1 << 4) - 1
+};
+}  // namespace ModelViewer3D
+
 struct ColorRGB {
   float r = 0;
   float g = 0;
@@ -53,6 +74,44 @@ class Viewer : public QOpenGLWidget {
   }
   inline const polygonType* get_faces_array() { return faces_array_; }
   inline unsigned int get_faces_size() { return faces_size_; }
+  /** @brief Mutator of triangles_array and triangles_size
+   * @param[in] array An array containing consecutive triples of indices of
+   * triangles of faces
+   * @param size The number of indices contained in the array
+   */
+  inline void set_triangles(polygonType* array, unsigned int size) {
+    triangles_array_ = array;
+    triangles_size_ = size;
+  }
+  /** @brief Hide edges and vertices behind faces
+   * Triangles of faces are drawn to the depth buffer before edges, so the
+   * mode needs triangles set by set_triangles
+   * @param is_enabled Draw only visible edges
+   */
+  inline void set_hidden_lines(bool is_enabled) {
+    is_hidden_lines_ = is_enabled;
+  }
+  inline bool get_hidden_lines() { return is_hidden_lines_; }
+  /** @brief Mutator of surface_normals_array and surface_normals_size
+   * @param[in] array Normals of triangles or vertices as of the surface
+   * mode with sequentially laid out coordinates
+   * @param size The number of normals contained in the array
+   */
+  inline void set_surface_normals(const vertexType* array, unsigned int size) {
+    surface_normals_array_ = array;
+    surface_normals_size_ = size;
+  }
+  /** @brief Fill faces lit by the light from the viewer under edges and
+   * vertices, which are drawn only when visible
+   * The mode needs triangles and normals of the same kind
+   * @param mode Flat or smooth shading, kNoNormals disables faces
+   */
+  inline void set_surface_mode(ModelViewer3D::SurfaceNormals mode) {
+    surface_mode_ = mode;
+  }
+  inline ModelViewer3D::SurfaceNormals get_surface_mode() {
+    return surface_mode_;
+  }
   inline float get_aspect_ratio() { return aspect_ratio_; }
   inline void set_vertex_settings(ElementSettings settings) {
     vertex_settings_ = settings;
@@ -92,6 +151,82 @@ class Viewer : public QOpenGLWidget {
     return line_strategy_->Type();
   }
 
+  /** @brief Select the render backend, must be called before the widget
+   * is shown. The shader backend requests a 3.3 core context. If the
+   * programs are not supported, the software backend is used in the core
+   * context and the legacy one in other contexts
+   * @param backend Render backend
+   */
+  void set_render_backend(ModelViewer3D::RenderBackend backend);
+  /** @brief Select drawing of edges and vertices by the shader backend
+   * @param mode Lines and points or instanced quads
+   */
+  inline void set_element_mode(ModelViewer3D::ElementMode mode) {
+    element_mode_ = mode;
+  }
+  inline ModelViewer3D::ElementMode get_element_mode() {
+    return element_mode_;
+  }
+  /** @brief Keep edges and vertices of the shader backend in cached layers,
+   * so a change of one element type does not redraw the other one
+   * @param is_enabled Use cached layers
+   */
+  inline void set_layer_cache(bool is_enabled) {
+    is_layer_cache_enabled_ = is_enabled;
+  }
+  inline bool get_layer_cache() { return is_layer_cache_enabled_; }
+  /** @brief Gets the render backend in use */
+  inline ModelViewer3D::RenderBackend get_render_backend() {
+    if (render_backend_ == ModelViewer3D::kSoftwareBackend) {
+      return ModelViewer3D::kSoftwareBackend;
+    }
+
+    return shader_renderer_ ? ModelViewer3D::kShaderBackend
+                            : ModelViewer3D::kLegacyBackend;
+  }
+
+  /** @brief Schedule a frame for the changes
+   * Requests are merged into at most one frame per interval of the frame
+   * rate cap, the request without changes does not cause redrawing
+   * @param changes Bitwise OR of ModelViewer3D::FrameChange values
+   */
+  void RequestFrame(unsigned int changes);
+  /** @brief Set the maximum count of frames per second
+   * @param fps Frame rate cap, zero to follow the refresh rate of display
+   */
+  void set_frame_rate_cap(int fps);
+  inline int get_frame_rate_cap() { return frame_rate_cap_; }
+  /** @brief Gets the count of RequestFrame calls */
+  inline unsigned long long get_frames_requested() {
+    return frames_requested_;
+  }
+  /** @brief Gets the count of frames actually drawn */
+  inline unsigned long long get_frames_rendered() { return frames_rendered_; }
+
+  /** @brief Capture the last rendered frame without stalling rendering
+   * Pixels are read to a pixel buffer object and mapped one frame interval
+   * later, the frame is not redrawn for the capture
+   * @param callback Receiver of the image, called from the event loop
+   */
+  void CaptureFrame(ModelViewer3D::FrameReader::Callback callback);
+
+  /** @brief Render the view to the BMP file of any size by tiles, or by
+   * strips of the software backend
+   * The projection keeps the aspect ratio of the image, sizes of lines and
+   * points are the same in pixels as in the widget
+   * @param path Path of the file
+   * @param width Width of the image in pixels
+   * @param height Height of the image in pixels
+   * @return false if the file could not be written
+   */
+  bool RenderToFile(const QString& path, int width, int height);
+
+  /** @brief Render the view to the image on the CPU
+   * Works without GL context, so the widget may be never shown
+   * @param size Size of the image in pixels
+   */
+  QImage RenderImage(const QSize& size);
+
   inline void Resize() {
     if (projection_strategy_) projection_strategy_->Resize(*this);
   }
@@ -99,12 +234,21 @@ class Viewer : public QOpenGLWidget {
   const int coords_in_vertex_ = 3;
   const int vertices_array_stride_ = 0;
   ColorRGB background_color_;
+  ColorRGB surface_color_;
   ElementSettings vertex_settings_;
   ElementSettings line_settings_;
 
+ signals:
+  /** @brief The selected render backend is not supported, the viewer uses
+   * the other one
+   * @param message Description of the failure
+   */
+  void RenderBackendFailed(const QString& message);
+
  protected:
   /** @brief Initialize of OpenGL
-   * Enable Depth Test and set background color
+   * Enable Depth Test and set background color, create the shader renderer
+   * if its backend is selected
    */
   void initializeGL() override;
   /** @brief The main drawing function
@@ -124,8 +268,8 @@ class Viewer : public QOpenGLWidget {
    */
   void mousePressEvent(QMouseEvent* event) override;
   /** @brief Handling mouse movement events
-   *  Performs rotation or transformation of the model depending on the mouse
-   * button pressed
+   *  Accumulates rotation or translation of the model depending on the mouse
+   * button pressed, the sum is applied once at the next frame
    *  @param[in] event Mouse event pointer
    */
   void mouseMoveEvent(QMouseEvent* event) override;
@@ -136,6 +280,36 @@ class Viewer : public QOpenGLWidget {
   void wheelEvent(QWheelEvent* event) override;
 
  private:
+  /** @brief Applies the mouse input accumulated since the previous frame
+   *  Called once per frame right before rendering, so the cost of model
+   * transformation does not depend on the mouse polling rate
+   */
+  void ApplyPendingInput();
+  /** @brief Pass captured frames to their callbacks */
+  void CollectFrames();
+  /** @brief Gets the minimum time between frames in milliseconds */
+  int FrameInterval();
+  /** @brief Clears the bound framebuffer and draws the frame
+   * @param tile Transform of clip space applied after the projection
+   * @param size Size of the framebuffer in pixels
+   * @param is_cached Use cached layers of the shader backend
+   */
+  void DrawFrame(const QMatrix4x4& tile, const QSize& size, bool is_cached);
+  /** @brief Checks that triangles and normals match the surface mode */
+  bool HasSurface();
+  /** @brief Draws faces lit by the fixed function pipeline */
+  void PaintLegacySurface();
+  /** @brief Draws the frame by the fixed function pipeline */
+  void PaintLegacy(const QMatrix4x4& tile);
+  /** @brief Draws the frame by shader programs */
+  void PaintShader(const QMatrix4x4& tile, const QSize& size, bool is_cached);
+  /** @brief Draws the frame by the software rasterizer at the current
+   * aspect ratio, the pixels stay in the rasterizer
+   * @param tile Transform of clip space applied after the projection
+   * @param size Size of the image in pixels
+   */
+  void RasterizeView(const QMatrix4x4& tile, const QSize& size);
+
   // Stores the value of how many times the scale increases or decreases
   const double kScaleStep = 1.2;
   const double kSensitivity = 6;
@@ -143,11 +317,39 @@ class Viewer : public QOpenGLWidget {
   unsigned int vertices_size_ = 0;
   polygonType* faces_array_ = nullptr;
   unsigned int faces_size_ = 0;
+  polygonType* triangles_array_ = nullptr;
+  unsigned int triangles_size_ = 0;
+  bool is_hidden_lines_ = false;
+  const vertexType* surface_normals_array_ = nullptr;
+  unsigned int surface_normals_size_ = 0;
+  ModelViewer3D::SurfaceNormals surface_mode_ = ModelViewer3D::kNoNormals;
   float aspect_ratio_ = 0;
   ModelViewer3D::ProjectionStrategy* projection_strategy_ = nullptr;
   ModelViewer3D::VertexStrategy* vertex_strategy_ = nullptr;
   ModelViewer3D::LineStrategy* line_strategy_ = nullptr;
+  ModelViewer3D::RenderBackend render_backend_ = ModelViewer3D::kLegacyBackend;
+  ModelViewer3D::ShaderRenderer* shader_renderer_ = nullptr;
+  ModelViewer3D::FrameReader* frame_reader_ = nullptr;
+  ModelViewer3D::SoftwareRasterizer software_rasterizer_;
+  ModelViewer3D::ElementMode element_mode_ =
+      ModelViewer3D::kPrimitiveElements;
+  bool is_layer_cache_enabled_ = true;
   QPoint last_mouse_pos_;
+  // Mouse deltas accumulated between frames
+  double pending_rotate_x_ = 0;
+  double pending_rotate_y_ = 0;
+  double pending_translate_x_ = 0;
+  double pending_translate_y_ = 0;
+  // Changes not drawn yet, bits of ModelViewer3D::FrameChange
+  unsigned int changes_ = ModelViewer3D::kAllChanges;
+  int frame_rate_cap_ = 0;
+  unsigned long long frames_requested_ = 0;
+  unsigned long long frames_rendered_ = 0;
+  // Fires once at the earliest time of the next frame
+  QTimer frame_timer_;
+  QElapsedTimer frame_clock_;
+  // Maps captured frames one frame interval after the read
+  QTimer capture_timer_;
 };
 
 #endif  // SRC_VIEWER_VIEWER_H_